@@ -0,0 +1,132 @@
+#include "Benchmark.h"
+#include "JsonWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+std::string formatNumber(double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+std::string paramString(const Benchmark::Params& params) {
+    std::string text;
+    for (const auto& p : params) {
+        text += " " + p.first + "=" + std::to_string(p.second);
+    }
+    return text;
+}
+
+} // namespace
+
+Benchmark::Benchmark(double minTimeMs, const std::string& filter) : minTimeMs(minTimeMs), filter(filter) {}
+
+bool Benchmark::enabled(const std::string& name) const {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void Benchmark::run(const std::string& name, const Params& params, const Body& body, double bytesPerOp) {
+    if (!enabled(name)) return;
+
+    using Clock = std::chrono::steady_clock;
+    size_t iterations = 1;
+    double elapsedNs = 0;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        body(iterations);
+        elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (elapsedNs >= minTimeMs * 1e6 || iterations >= ((size_t)1 << 32)) break;
+
+        // Aim a little past the target so the next round usually is the last
+        double scale = elapsedNs > 0 ? minTimeMs * 1e6 * 1.2 / elapsedNs : 100;
+        iterations = (size_t)std::max<double>(iterations * 2, std::min(iterations * scale, iterations * 100.0));
+    }
+
+    Result result;
+    result.name = name;
+    result.params = params;
+    result.iterations = iterations;
+    result.nsPerOp = elapsedNs / iterations;
+    result.bytesPerOp = bytesPerOp;
+    addResult(result);
+}
+
+void Benchmark::addResult(const Result& result) {
+    std::cerr << result.name << paramString(result.params) << ": " << formatNumber(result.nsPerOp) << " ns/op";
+    if (result.bytesPerOp > 0) {
+        std::cerr << ", " << formatNumber(result.bytesPerOp / result.nsPerOp * 1e3) << " MB/s";
+    }
+    for (const auto& m : result.metrics) {
+        std::cerr << ", " << m.first << "=" << formatNumber(m.second);
+    }
+    std::cerr << std::endl;
+    results.push_back(result);
+}
+
+void Benchmark::check(const std::string& name, bool passed) {
+    if (!passed) std::cerr << "❌ Check failed: " << name << std::endl;
+    checks.emplace_back(name, passed);
+}
+
+bool Benchmark::allChecksPassed() const {
+    return std::all_of(checks.begin(), checks.end(), [](const std::pair<std::string, bool>& c) { return c.second; });
+}
+
+void Benchmark::writeJson(std::ostream& out, const std::vector<std::pair<std::string, std::string>>& context) const {
+    JsonWriter writer(64 * 1024);
+    writer.beginObject();
+
+    writer.key("context").beginObject();
+    for (const auto& c : context) {
+        writer.field(c.first, c.second);
+    }
+    writer.endObject();
+
+    writer.key("checks").beginArray();
+    for (const auto& c : checks) {
+        writer.beginObject();
+        writer.field("name", c.first);
+        writer.key("passed").value(c.second);
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.key("benchmarks").beginArray();
+    for (const Result& r : results) {
+        writer.beginObject();
+        writer.field("name", r.name);
+        writer.key("params").beginObject();
+        for (const auto& p : r.params) {
+            writer.key(p.first).value(p.second);
+        }
+        writer.endObject();
+        writer.key("iterations").value((long long)r.iterations);
+        writer.key("ns_per_op").raw(formatNumber(r.nsPerOp));
+        writer.key("ops_per_sec").raw(formatNumber(r.nsPerOp > 0 ? 1e9 / r.nsPerOp : 0));
+        if (r.bytesPerOp > 0) {
+            writer.key("bytes_per_sec").raw(formatNumber(r.bytesPerOp / r.nsPerOp * 1e9));
+        }
+        for (const auto& m : r.metrics) {
+            writer.key(m.first).raw(formatNumber(m.second));
+        }
+        if (!r.histogram.empty()) {
+            writer.key("histogram").beginArray();
+            for (const auto& bucket : r.histogram) {
+                writer.beginObject();
+                writer.key("le").raw(formatNumber(bucket.first));
+                writer.key("count").value((long long)bucket.second);
+                writer.endObject();
+            }
+            writer.endArray();
+        }
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.endObject();
+    out << writer.str() << std::endl;
+}
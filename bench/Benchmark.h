@@ -0,0 +1,57 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Keeps the compiler from discarding a result that is otherwise unused
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Small timing harness. Each benchmark body is called with an iteration count
+// that grows until one call lasts at least minTimeMs; that last call is reported.
+// Results and correctness checks are written out together as one JSON document.
+class Benchmark {
+public:
+    using Params = std::vector<std::pair<std::string, long long>>;
+    using Metrics = std::vector<std::pair<std::string, double>>;
+    using Body = std::function<void(size_t iterations)>;
+
+    struct Result {
+        std::string name;
+        Params params;
+        uint64_t iterations = 0;
+        double nsPerOp = 0;
+        double bytesPerOp = 0; // Enables bytes_per_sec in the output
+        Metrics metrics;       // Extra figures, e.g. SQLITE_BUSY counts
+        std::vector<std::pair<double, uint64_t>> histogram; // (upper bound, count) buckets
+    };
+
+    Benchmark(double minTimeMs, const std::string& filter);
+
+    // True if name matches the --filter substring
+    bool enabled(const std::string& name) const;
+
+    void run(const std::string& name, const Params& params, const Body& body, double bytesPerOp = 0);
+    void addResult(const Result& result);
+
+    // Records a correctness check; any failure makes the run exit non-zero
+    void check(const std::string& name, bool passed);
+    bool allChecksPassed() const;
+
+    void writeJson(std::ostream& out, const std::vector<std::pair<std::string, std::string>>& context) const;
+
+private:
+    double minTimeMs;
+    std::string filter;
+    std::vector<Result> results;
+    std::vector<std::pair<std::string, bool>> checks;
+};
+
+#endif // BENCHMARK_H
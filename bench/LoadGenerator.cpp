@@ -0,0 +1,72 @@
+#include "LoadGenerator.h"
+#include "HttpPipeline.h"
+#include "HttpSession.h"
+#include "IssueCreator.h"
+#include "IssueResponseParser.h"
+#include "JsonWriter.h"
+#include "RequestScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+LoadGenerator::Report LoadGenerator::run(const Options& options) {
+    using Clock = std::chrono::steady_clock;
+
+    RequestScheduler::Options schedulerOptions;
+    schedulerOptions.maxConcurrency = std::max(1, options.concurrency);
+    schedulerOptions.initialConcurrency = schedulerOptions.maxConcurrency;
+    schedulerOptions.maxRetries = options.maxRetries;
+    auto scheduler = std::make_shared<RequestScheduler>(schedulerOptions);
+    auto session = std::make_shared<HttpSession>();
+    Report report;
+    report.metrics = std::make_shared<RequestMetrics>();
+    session->setMetrics(report.metrics);
+    HttpPipeline pipeline(schedulerOptions.maxConcurrency, session, scheduler);
+
+    std::string url = options.apiUrl + "/repos/" + options.owner + "/issues";
+    std::string body(options.bodyBytes, 'x');
+    for (size_t i = 0; i < body.size(); i += 64) body[i] = '\n';
+    JsonWriter writer;
+
+    size_t submitted = 0;
+    size_t completed = 0;
+
+    Clock::time_point started = Clock::now();
+    while (completed < options.requests) {
+        // Submit only as many as can run, so the measured latency is not queueing time
+        while (submitted < options.requests && submitted - completed < (size_t)schedulerOptions.maxConcurrency) {
+            IssueCreator::buildRequestBody(writer, options.token, options.repo,
+                                           "Load test issue " + std::to_string(submitted), body, "");
+            HttpRequest request;
+            request.url = url;
+            request.body = writer.take();
+            request.headers.push_back("Content-Type: application/json;charset=UTF-8");
+            request.rateKey = options.token;
+
+            auto parser = std::make_shared<IssueResponseParser>();
+            request.onData = [parser](const char* data, size_t len) { parser->feed(data, len); };
+            request.onRetry = [parser]() { parser->reset(); };
+
+            Clock::time_point sent = Clock::now();
+            pipeline.submit(std::move(request), [&, parser, sent](const HttpResponse& response) {
+                ++completed;
+                report.latencyUs.record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - sent).count());
+                IssueResult result;
+                parser->fill(result);
+                if (response.error.empty() && response.status == 201 && result.id >= 0) {
+                    ++report.succeeded;
+                } else {
+                    ++report.failed;
+                }
+            });
+            ++submitted;
+        }
+        pipeline.runOnce();
+    }
+    report.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+
+    report.retries = scheduler->getRetryCount();
+    report.throttled = scheduler->getThrottledCount();
+    report.newConnections = session->getNewConnectionCount();
+    return report;
+}
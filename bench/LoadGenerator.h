@@ -0,0 +1,41 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include "Histogram.h"
+#include "RequestMetrics.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Drives the real client path (HttpPipeline + RequestScheduler + IssueResponseParser,
+// as used by --batch) against an API base URL at a fixed concurrency and records
+// the end-to-end latency of every issue, retries included.
+class LoadGenerator {
+public:
+    struct Options {
+        std::string apiUrl;          // e.g. MockServer::getBaseUrl()
+        std::string owner = "owner";
+        std::string repo = "repo";
+        std::string token = "token";
+        int concurrency = 32;
+        size_t requests = 10000;
+        size_t bodyBytes = 512;
+        int maxRetries = 5;
+    };
+
+    struct Report {
+        size_t succeeded = 0;
+        size_t failed = 0;
+        size_t retries = 0;
+        size_t throttled = 0;
+        size_t newConnections = 0;
+        double seconds = 0;
+        Histogram latencyUs;                     // End to end per issue, retries included
+        std::shared_ptr<RequestMetrics> metrics; // Per-exchange phase timings
+    };
+
+    static Report run(const Options& options);
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,845 @@
+#include "MockServer.h"
+#include "JsonTokenizer.h"
+#include "JsonWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+// epoll user data for the two non-connection descriptors; connection IDs start above them
+static const uint64_t LISTEN_ID = 0;
+static const uint64_t WAKE_ID = 1;
+
+struct MockServer::Connection {
+    uint64_t id = 0;
+    int fd = -1;
+    std::string input;
+    std::string output;
+    size_t outputOffset = 0;
+    bool waiting = false;         // A delayed response is pending; hold further requests
+    bool continueSent = false;    // 100 Continue already sent for the current request
+    bool closeAfterWrite = false;
+    bool wantWrite = false;       // EPOLLOUT is registered
+};
+
+struct MockServer::Delayed {
+    Clock::time_point due;
+    uint64_t connection;
+    std::string response;
+    bool close;
+};
+
+namespace {
+
+bool dueAfter(const Clock::time_point& a, const Clock::time_point& b) {
+    return a > b;
+}
+
+// Pulls the top-level fields out of a create-issue request body
+class CreateRequestHandler : public JsonHandler {
+public:
+    JsonTokenizer* tokenizer = nullptr;
+    std::string field;
+    std::string token;
+    std::string repo;
+    std::string title;
+    std::string body;
+    std::string labels;
+    std::string state;
+    std::string name;
+    bool hasBody = false;   // Sent, possibly empty
+    bool hasLabels = false;
+
+    bool onKey(const std::string& key) override {
+        field = key;
+        return tokenizer->depth() == 1;
+    }
+    void onString(const std::string& value) override {
+        if (field == "access_token") token = value;
+        else if (field == "repo") repo = value;
+        else if (field == "title") title = value;
+        else if (field == "body") body = value, hasBody = true;
+        else if (field == "labels") labels = value, hasLabels = true;
+        else if (field == "state") state = value;
+        else if (field == "name") name = value;
+    }
+};
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 422: return "Unprocessable Entity";
+        case 429: return "Too Many Requests";
+        default: return "Internal Server Error";
+    }
+}
+
+std::string httpResponse(int status, const std::string& body, const std::string& extraHeaders, bool keepAlive) {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reasonPhrase(status) + "\r\n";
+    response += "Content-Type: application/json;charset=utf-8\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    response += extraHeaders;
+    if (!keepAlive) response += "Connection: close\r\n";
+    response += "\r\n";
+    response += body;
+    return response;
+}
+
+std::string errorBody(const std::string& message) {
+    JsonWriter writer(64 + message.size());
+    writer.beginObject().field("message", message).endObject();
+    return writer.take();
+}
+
+// Gitee issue numbers look like "I8ABCD"
+std::string issueNumber(uint64_t id) {
+    static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string number;
+    do {
+        number.insert(number.begin(), digits[id % 36]);
+        id /= 36;
+    } while (id);
+    return "I" + number;
+}
+
+// Inverse of issueNumber; 0 if number is not one
+uint64_t issueId(const std::string& number) {
+    if (number.size() < 2 || number[0] != 'I') return 0;
+    uint64_t id = 0;
+    for (size_t i = 1; i < number.size(); ++i) {
+        char c = number[i];
+        int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'A' && c <= 'Z') ? c - 'A' + 10 : -1;
+        if (digit < 0) return 0;
+        id = id * 36 + (uint64_t)digit;
+    }
+    return id;
+}
+
+// Value of a query parameter in a request target, percent-decoded; empty if absent
+std::string queryParam(const std::string& target, const std::string& name) {
+    size_t query = target.find('?');
+    if (query == std::string::npos) return "";
+    size_t pos = query + 1;
+    while (pos < target.size()) {
+        size_t end = target.find('&', pos);
+        if (end == std::string::npos) end = target.size();
+        size_t eq = target.find('=', pos);
+        if (eq < end && target.compare(pos, eq - pos, name) == 0 && eq - pos == name.size()) {
+            std::string value;
+            for (size_t i = eq + 1; i < end; ++i) {
+                if (target[i] == '%' && i + 2 < end) {
+                    value += (char)std::strtol(target.substr(i + 1, 2).c_str(), nullptr, 16);
+                    i += 2;
+                } else {
+                    value += target[i] == '+' ? ' ' : target[i];
+                }
+            }
+            return value;
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+// Gitee's timestamp format, in its own time zone: 2024-05-01T12:34:56+08:00
+std::string timestamp(std::time_t when) {
+    std::time_t local = when + 8 * 3600;
+    std::tm tm;
+    gmtime_r(&local, &tm);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S+08:00", &tm);
+    return buffer;
+}
+
+} // namespace
+
+MockServer::MockServer(const Options& options)
+    : options(options), listenFd(-1), epollFd(-1), wakeFd(-1), port(0), nextConnectionId(2), nextIssueId(1),
+      rng(std::random_device{}()), connectionCount(0), requestCount(0), createdCount(0), updatedCount(0), listedCount(0),
+      labelCount(0), throttledCount(0), errorCount(0), rejectedCount(0) {
+    // Seeded issues are spread over the seconds before startup, oldest first
+    size_t slash = options.seedRepo.find('/');
+    if (options.seedIssues > 0 && slash != std::string::npos) {
+        std::string owner = options.seedRepo.substr(0, slash);
+        std::string repo = options.seedRepo.substr(slash + 1);
+        std::time_t now = std::time(nullptr);
+        issues[options.seedRepo].reserve((size_t)options.seedIssues);
+        for (int i = 0; i < options.seedIssues; ++i) {
+            std::string n = std::to_string(i + 1);
+            storeIssue(owner, repo, "Seeded issue " + n, "Body of seeded issue " + n, i % 3 ? "" : "bug",
+                       timestamp(now - options.seedIssues + i));
+        }
+    }
+}
+
+MockServer::~MockServer() {
+    for (auto& entry : connections) {
+        ::close(entry.second->fd);
+        delete entry.second;
+    }
+    if (listenFd >= 0) ::close(listenFd);
+    if (epollFd >= 0) ::close(epollFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+}
+
+bool MockServer::start() {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)options.port);
+    if (inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "❌ Invalid listen address: " << options.host << std::endl;
+        return false;
+    }
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int yes = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    if (listenFd < 0 || ::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 1024) != 0) {
+        std::cerr << "❌ Failed to listen on " << options.host << ":" << options.port << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = LISTEN_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.u64 = WAKE_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+    return true;
+}
+
+void MockServer::stop() {
+    uint64_t one = 1;
+    if (wakeFd >= 0 && ::write(wakeFd, &one, sizeof(one)) < 0) {
+        // Already signalled; nothing else to do
+    }
+}
+
+int MockServer::getPort() const {
+    return port;
+}
+
+std::string MockServer::getBaseUrl() const {
+    return "http://" + options.host + ":" + std::to_string(port) + "/api/v5";
+}
+
+MockServer::Stats MockServer::getStats() const {
+    Stats stats;
+    stats.connections = connectionCount;
+    stats.requests = requestCount;
+    stats.created = createdCount;
+    stats.updated = updatedCount;
+    stats.listed = listedCount;
+    stats.labels = labelCount;
+    stats.throttled = throttledCount;
+    stats.errors = errorCount;
+    stats.rejected = rejectedCount;
+    return stats;
+}
+
+void MockServer::run() {
+    auto heapOrder = [](const Delayed& a, const Delayed& b) { return dueAfter(a.due, b.due); };
+    epoll_event events[256];
+
+    for (;;) {
+        int timeout = -1;
+        if (!delayed.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::microseconds>(delayed.front().due - Clock::now());
+            timeout = (int)std::max<long long>(0, (wait.count() + 999) / 1000);
+        }
+
+        int n = epoll_wait(epollFd, events, 256, timeout);
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == WAKE_ID) {
+                return;
+            }
+            if (id == LISTEN_ID) {
+                accept();
+                continue;
+            }
+            auto it = connections.find(id);
+            if (it == connections.end()) continue;
+            Connection* c = it->second;
+            if (events[i].events & EPOLLOUT) {
+                flush(c);
+                if (connections.find(id) == connections.end()) continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+                onReadable(c);
+            }
+        }
+
+        // Release every response whose simulated latency has passed
+        Clock::time_point now = Clock::now();
+        while (!delayed.empty() && delayed.front().due <= now) {
+            std::pop_heap(delayed.begin(), delayed.end(), heapOrder);
+            Delayed d = std::move(delayed.back());
+            delayed.pop_back();
+
+            auto it = connections.find(d.connection);
+            if (it == connections.end()) continue;
+            Connection* c = it->second;
+            c->output += d.response;
+            c->closeAfterWrite = d.close;
+            c->waiting = false;
+            flush(c);
+            if (connections.count(d.connection)) onReadable(c); // Serve requests that arrived meanwhile
+        }
+    }
+}
+
+void MockServer::accept() {
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        // Responses are small and written in one go; do not let Nagle hold them back
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        Connection* c = new Connection();
+        c->id = nextConnectionId++;
+        c->fd = fd;
+        connections[c->id] = c;
+        ++connectionCount;
+
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = c->id;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void MockServer::closeConnection(Connection* c) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+    ::close(c->fd);
+    connections.erase(c->id);
+    delete c;
+}
+
+void MockServer::flush(Connection* c) {
+    while (c->outputOffset < c->output.size()) {
+        ssize_t n = ::send(c->fd, c->output.data() + c->outputOffset, c->output.size() - c->outputOffset,
+                           MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) {
+            closeConnection(c);
+            return;
+        }
+        c->outputOffset += (size_t)n;
+    }
+
+    bool pending = c->outputOffset < c->output.size();
+    if (!pending) {
+        c->output.clear();
+        c->outputOffset = 0;
+        if (c->closeAfterWrite) {
+            closeConnection(c);
+            return;
+        }
+    }
+    if (pending != c->wantWrite) {
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | (pending ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.u64 = c->id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->wantWrite = pending;
+    }
+}
+
+void MockServer::onReadable(Connection* c) {
+    uint64_t id = c->id;
+    char buffer[16384];
+    bool peerClosed = false;
+    for (;;) {
+        ssize_t n = ::recv(c->fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            c->input.append(buffer, (size_t)n);
+            continue;
+        }
+        if (n == 0) peerClosed = true;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) peerClosed = true;
+        break;
+    }
+
+    std::string method, target, body;
+    bool keepAlive = true;
+    while (!c->waiting && takeRequest(c, method, target, body, keepAlive)) {
+        std::string response = respond(method, target, body, keepAlive);
+
+        int delayMs = options.latencyMs;
+        if (options.jitterMs > 0) delayMs += std::uniform_int_distribution<int>(0, options.jitterMs)(rng);
+        if (delayMs > 0) {
+            c->waiting = true;
+            delayed.push_back(Delayed{Clock::now() + std::chrono::milliseconds(delayMs), c->id, std::move(response),
+                                      !keepAlive});
+            std::push_heap(delayed.begin(), delayed.end(),
+                           [](const Delayed& a, const Delayed& b) { return dueAfter(a.due, b.due); });
+        } else {
+            c->output += response;
+            c->closeAfterWrite = !keepAlive;
+            flush(c);
+            if (!connections.count(id)) return;
+        }
+        if (!keepAlive) break;
+    }
+
+    if (peerClosed && connections.count(id)) {
+        closeConnection(c);
+    }
+}
+
+bool MockServer::takeRequest(Connection* c, std::string& method, std::string& target, std::string& body,
+                             bool& keepAlive) {
+    size_t headerEnd = c->input.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return false;
+
+    size_t lineEnd = c->input.find("\r\n");
+    std::string requestLine = c->input.substr(0, lineEnd);
+    size_t sp1 = requestLine.find(' ');
+    size_t sp2 = requestLine.find(' ', sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos) {
+        c->input.clear();
+        c->output += httpResponse(400, errorBody("Malformed request line"), "", false);
+        c->closeAfterWrite = true;
+        flush(c);
+        return false;
+    }
+    method = requestLine.substr(0, sp1);
+    target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+    keepAlive = requestLine.compare(sp2 + 1, std::string::npos, "HTTP/1.0") != 0;
+
+    size_t contentLength = 0;
+    bool chunked = false;
+    bool expectContinue = false;
+    size_t pos = lineEnd + 2;
+    while (pos < headerEnd) {
+        size_t end = c->input.find("\r\n", pos);
+        std::string line = c->input.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) { return (char)std::tolower(ch); });
+        std::string value = line.substr(std::min(line.size(), line.find_first_not_of(" \t", colon + 1)));
+        std::transform(value.begin(), value.end(), value.begin(), [](unsigned char ch) { return (char)std::tolower(ch); });
+
+        if (name == "content-length") contentLength = (size_t)std::strtoull(value.c_str(), nullptr, 10);
+        else if (name == "transfer-encoding") chunked = value.find("chunked") != std::string::npos;
+        else if (name == "expect") expectContinue = value == "100-continue";
+        else if (name == "connection") {
+            if (value == "close") keepAlive = false;
+            else if (value == "keep-alive") keepAlive = true;
+        }
+    }
+
+    size_t bodyStart = headerEnd + 4;
+    size_t consumed = 0;
+    if (chunked) {
+        // Walk the chunk headers first; only copy once the whole body is here
+        std::vector<std::pair<size_t, size_t>> chunks;
+        size_t at = bodyStart;
+        for (;;) {
+            size_t sizeEnd = c->input.find("\r\n", at);
+            if (sizeEnd == std::string::npos) break;
+            size_t size = (size_t)std::strtoull(c->input.c_str() + at, nullptr, 16);
+            at = sizeEnd + 2;
+            if (size == 0) {
+                // Optional trailers, then an empty line
+                if (c->input.compare(at, 2, "\r\n") == 0) {
+                    consumed = at + 2;
+                } else {
+                    size_t trailerEnd = c->input.find("\r\n\r\n", at);
+                    if (trailerEnd != std::string::npos) consumed = trailerEnd + 4;
+                }
+                break;
+            }
+            if (c->input.size() < at + size + 2) break;
+            chunks.emplace_back(at, size);
+            at += size + 2;
+        }
+        if (consumed) {
+            body.clear();
+            for (const auto& chunk : chunks) body.append(c->input, chunk.first, chunk.second);
+        }
+    } else if (c->input.size() >= bodyStart + contentLength) {
+        body.assign(c->input, bodyStart, contentLength);
+        consumed = bodyStart + contentLength;
+    }
+
+    if (!consumed) {
+        if (expectContinue && !c->continueSent) {
+            c->output += "HTTP/1.1 100 Continue\r\n\r\n";
+            c->continueSent = true;
+            flush(c);
+        }
+        return false;
+    }
+
+    c->input.erase(0, consumed);
+    c->continueSent = false;
+    return true;
+}
+
+bool MockServer::allowByRateLimit(const std::string& token, long& resetSeconds) {
+    if (options.rateLimit <= 0) return true;
+
+    Clock::time_point now = Clock::now();
+    double burst = std::max(1.0, options.rateLimit);
+    auto it = rateBuckets.find(token);
+    if (it == rateBuckets.end()) {
+        it = rateBuckets.emplace(token, RateBucket()).first;
+        it->second.tokens = burst;
+        it->second.refilled = now;
+    }
+    RateBucket& bucket = it->second;
+    double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+    bucket.tokens = std::min(burst, bucket.tokens + elapsed * options.rateLimit);
+    bucket.refilled = now;
+
+    if (bucket.tokens >= 1) {
+        bucket.tokens -= 1;
+        return true;
+    }
+    resetSeconds = std::max(1L, (long)std::ceil((1 - bucket.tokens) / options.rateLimit));
+    return false;
+}
+
+std::string MockServer::respond(const std::string& method, const std::string& target, const std::string& body,
+                                bool keepAlive) {
+    ++requestCount;
+
+    // {prefix}/repos/{owner}/issues or {prefix}/repos/{owner}/{repo}/issues, then [?query]
+    std::string path = target.substr(0, target.find('?'));
+    size_t repos = path.find("/repos/");
+
+    // {prefix}/repos/{owner}/issues/{number}
+    size_t issuesAt = repos == std::string::npos ? std::string::npos : path.find("/issues/", repos + 7);
+    if (issuesAt != std::string::npos && issuesAt > repos + 7 && path.find('/', issuesAt + 8) == std::string::npos &&
+        path.find('/', repos + 7) == issuesAt) {
+        if (method != "PATCH") {
+            ++rejectedCount;
+            return httpResponse(405, errorBody("Method Not Allowed"), "", keepAlive);
+        }
+        return updateIssue(path.substr(repos + 7, issuesAt - repos - 7), path.substr(issuesAt + 8), body, keepAlive);
+    }
+
+    // {prefix}/repos/{owner}/{repo}/labels
+    const std::string labelsSuffix = "/labels";
+    if (repos != std::string::npos && path.size() > repos + 7 + labelsSuffix.size() &&
+        path.compare(path.size() - labelsSuffix.size(), std::string::npos, labelsSuffix) == 0) {
+        std::string repoPath = path.substr(repos + 7, path.size() - labelsSuffix.size() - repos - 7);
+        size_t slash = repoPath.find('/');
+        if (slash != std::string::npos && slash > 0 && slash + 1 < repoPath.size() &&
+            repoPath.find('/', slash + 1) == std::string::npos) {
+            return repoLabels(repoPath.substr(0, slash), repoPath.substr(slash + 1), method, target, body, keepAlive);
+        }
+    }
+
+    const std::string suffix = "/issues";
+    if (repos == std::string::npos || path.size() < repos + 7 + suffix.size() ||
+        path.compare(path.size() - suffix.size(), std::string::npos, suffix) != 0) {
+        ++rejectedCount;
+        return httpResponse(404, errorBody("Not Found"), "", keepAlive);
+    }
+    std::string middle = path.substr(repos + 7, path.size() - suffix.size() - repos - 7);
+    size_t slash = middle.find('/');
+
+    if (slash == std::string::npos && !middle.empty()) {
+        if (method != "POST") {
+            ++rejectedCount;
+            return httpResponse(405, errorBody("Method Not Allowed"), "", keepAlive);
+        }
+        return createIssue(middle, body, keepAlive);
+    }
+    if (slash != std::string::npos && slash > 0 && slash + 1 < middle.size() &&
+        middle.find('/', slash + 1) == std::string::npos) {
+        if (method != "GET") {
+            ++rejectedCount;
+            return httpResponse(405, errorBody("Method Not Allowed"), "", keepAlive);
+        }
+        return listIssues(middle.substr(0, slash), middle.substr(slash + 1), target, keepAlive);
+    }
+    ++rejectedCount;
+    return httpResponse(404, errorBody("Not Found"), "", keepAlive);
+}
+
+bool MockServer::injectFailure(const std::string& token, bool keepAlive, std::string& response) {
+    long resetSeconds = 0;
+    if (!allowByRateLimit(token, resetSeconds)) {
+        ++throttledCount;
+        std::string headers = "Retry-After: " + std::to_string(resetSeconds) + "\r\n" +
+                              "X-RateLimit-Limit: " + std::to_string((long)options.rateLimit) + "\r\n" +
+                              "X-RateLimit-Remaining: 0\r\n" +
+                              "X-RateLimit-Reset: " + std::to_string(resetSeconds) + "\r\n";
+        response = httpResponse(429, errorBody("Rate limit exceeded"), headers, keepAlive);
+        return true;
+    }
+
+    std::uniform_real_distribution<double> chance(0, 1);
+    if (options.throttleRate > 0 && chance(rng) < options.throttleRate) {
+        ++throttledCount;
+        std::string headers;
+        if (options.retryAfterSeconds > 0) headers = "Retry-After: " + std::to_string(options.retryAfterSeconds) + "\r\n";
+        response = httpResponse(429, errorBody("Rate limit exceeded"), headers, keepAlive);
+        return true;
+    }
+    if (options.errorRate > 0 && chance(rng) < options.errorRate) {
+        ++errorCount;
+        response = httpResponse(500, errorBody("Internal Server Error"), "", keepAlive);
+        return true;
+    }
+    return false;
+}
+
+MockServer::StoredIssue& MockServer::storeIssue(const std::string& owner, const std::string& repo,
+                                                const std::string& title, const std::string& body,
+                                                const std::string& labels, const std::string& timestamp) {
+    std::vector<StoredIssue>& list = issues[owner + "/" + repo];
+    list.push_back(StoredIssue{nextIssueId++, title, body, labels, "open", timestamp, timestamp});
+    return list.back();
+}
+
+void MockServer::writeIssue(JsonWriter& writer, const std::string& owner, const std::string& repo,
+                            const StoredIssue& issue) const {
+    std::string number = issueNumber(issue.id);
+    std::string site = "http://" + options.host + ":" + std::to_string(port);
+
+    writer.beginObject();
+    writer.key("id").value((long long)issue.id);
+    writer.field("number", number);
+    writer.field("html_url", site + "/" + owner + "/" + repo + "/issues/" + number);
+    writer.field("title", issue.title);
+    writer.field("body", issue.body);
+    writer.field("state", issue.state);
+    writer.key("user").beginObject();
+    writer.key("id").value(1LL);
+    writer.field("login", "mock");
+    writer.field("html_url", site + "/mock");
+    writer.endObject();
+    writer.key("labels").beginArray();
+    size_t pos = 0;
+    while (pos < issue.labels.size()) {
+        size_t end = std::min(issue.labels.find(',', pos), issue.labels.size());
+        if (end > pos) {
+            writer.beginObject().field("name", issue.labels.substr(pos, end - pos)).endObject();
+        }
+        pos = end + 1;
+    }
+    writer.endArray();
+    writer.key("repository").beginObject();
+    writer.key("id").value(1LL);
+    writer.field("full_name", owner + "/" + repo);
+    writer.field("html_url", site + "/" + owner + "/" + repo);
+    writer.endObject();
+    writer.field("created_at", issue.createdAt);
+    writer.field("updated_at", issue.updatedAt);
+    writer.endObject();
+}
+
+std::string MockServer::createIssue(const std::string& owner, const std::string& body, bool keepAlive) {
+    CreateRequestHandler handler;
+    JsonTokenizer tokenizer(handler);
+    handler.tokenizer = &tokenizer;
+    if (!tokenizer.feed(body.data(), body.size()) || !tokenizer.finish()) {
+        ++rejectedCount;
+        return httpResponse(400, errorBody("Invalid JSON body"), "", keepAlive);
+    }
+    if (handler.token.empty()) {
+        ++rejectedCount;
+        return httpResponse(401, errorBody("401 Unauthorized: Access token does not exist"), "", keepAlive);
+    }
+    if (handler.repo.empty() || handler.title.empty()) {
+        ++rejectedCount;
+        return httpResponse(400, errorBody(handler.repo.empty() ? "repo is missing" : "title is missing"), "",
+                            keepAlive);
+    }
+
+    std::string response;
+    if (injectFailure(handler.token, keepAlive, response)) return response;
+
+    const StoredIssue& issue = storeIssue(owner, handler.repo, handler.title, handler.body, handler.labels,
+                                          timestamp(std::time(nullptr)));
+    JsonWriter writer(512 + issue.title.size() + issue.body.size());
+    writeIssue(writer, owner, handler.repo, issue);
+
+    ++createdCount;
+    return httpResponse(201, writer.take(), "", keepAlive);
+}
+
+std::string MockServer::updateIssue(const std::string& owner, const std::string& number, const std::string& body,
+                                    bool keepAlive) {
+    CreateRequestHandler handler;
+    JsonTokenizer tokenizer(handler);
+    handler.tokenizer = &tokenizer;
+    if (!tokenizer.feed(body.data(), body.size()) || !tokenizer.finish()) {
+        ++rejectedCount;
+        return httpResponse(400, errorBody("Invalid JSON body"), "", keepAlive);
+    }
+    if (handler.token.empty()) {
+        ++rejectedCount;
+        return httpResponse(401, errorBody("401 Unauthorized: Access token does not exist"), "", keepAlive);
+    }
+    if (handler.repo.empty()) {
+        ++rejectedCount;
+        return httpResponse(400, errorBody("repo is missing"), "", keepAlive);
+    }
+    if (!handler.state.empty() && handler.state != "open" && handler.state != "progressing" &&
+        handler.state != "closed") {
+        ++rejectedCount;
+        return httpResponse(400, errorBody("state is invalid"), "", keepAlive);
+    }
+
+    std::string response;
+    if (injectFailure(handler.token, keepAlive, response)) return response;
+
+    uint64_t id = issueId(number);
+    std::vector<StoredIssue>& list = issues[owner + "/" + handler.repo];
+    auto found = std::find_if(list.begin(), list.end(), [id](const StoredIssue& issue) { return issue.id == id; });
+    if (found == list.end()) {
+        ++rejectedCount;
+        return httpResponse(404, errorBody("Not Found"), "", keepAlive);
+    }
+
+    StoredIssue issue = std::move(*found);
+    if (!handler.title.empty()) issue.title = handler.title;
+    if (handler.hasBody) issue.body = handler.body;
+    if (handler.hasLabels) issue.labels = handler.labels;
+    if (!handler.state.empty()) issue.state = handler.state;
+    issue.updatedAt = timestamp(std::time(nullptr));
+    // Moved to the end, so the list stays in updated_at order for listIssues
+    list.erase(found);
+    list.push_back(std::move(issue));
+
+    JsonWriter writer(512 + list.back().title.size() + list.back().body.size());
+    writeIssue(writer, owner, handler.repo, list.back());
+    ++updatedCount;
+    return httpResponse(200, writer.take(), "", keepAlive);
+}
+
+std::string MockServer::listIssues(const std::string& owner, const std::string& repo, const std::string& target,
+                                   bool keepAlive) {
+    std::string token = queryParam(target, "access_token");
+    if (token.empty()) {
+        ++rejectedCount;
+        return httpResponse(401, errorBody("401 Unauthorized: Access token does not exist"), "", keepAlive);
+    }
+    std::string response;
+    if (injectFailure(token, keepAlive, response)) return response;
+
+    std::string pageText = queryParam(target, "page");
+    std::string perPageText = queryParam(target, "per_page");
+    long page = std::max(1L, pageText.empty() ? 1L : std::strtol(pageText.c_str(), nullptr, 10));
+    long perPage = std::min(100L, std::max(1L, perPageText.empty() ? 20L : std::strtol(perPageText.c_str(), nullptr, 10)));
+    std::string since = queryParam(target, "since");
+
+    // Lists are kept in updated_at order, so since is a binary search
+    static const std::vector<StoredIssue> none;
+    auto found = issues.find(owner + "/" + repo);
+    const std::vector<StoredIssue>& list = found == issues.end() ? none : found->second;
+    auto first = std::lower_bound(list.begin(), list.end(), since,
+                                  [](const StoredIssue& issue, const std::string& value) {
+                                      return issue.updatedAt < value;
+                                  });
+    size_t total = (size_t)(list.end() - first);
+    size_t totalPages = (total + (size_t)perPage - 1) / (size_t)perPage;
+
+    // Newest first
+    JsonWriter writer(1024 * (size_t)perPage);
+    writer.beginArray();
+    size_t skip = (size_t)(page - 1) * (size_t)perPage;
+    for (size_t i = skip; i < total && i < skip + (size_t)perPage; ++i) {
+        writeIssue(writer, owner, repo, list[list.size() - 1 - i]);
+    }
+    writer.endArray();
+
+    ++listedCount;
+    std::string headers = "total_count: " + std::to_string(total) + "\r\n" +
+                          "total_page: " + std::to_string(totalPages) + "\r\n";
+    return httpResponse(200, writer.take(), headers, keepAlive);
+}
+
+std::string MockServer::repoLabels(const std::string& owner, const std::string& repo, const std::string& method,
+                                   const std::string& target, const std::string& body, bool keepAlive) {
+    CreateRequestHandler handler;
+    JsonTokenizer tokenizer(handler);
+    handler.tokenizer = &tokenizer;
+    if (method == "GET") {
+        handler.token = queryParam(target, "access_token");
+    } else if (method != "POST") {
+        ++rejectedCount;
+        return httpResponse(405, errorBody("Method Not Allowed"), "", keepAlive);
+    } else if (!tokenizer.feed(body.data(), body.size()) || !tokenizer.finish()) {
+        ++rejectedCount;
+        return httpResponse(400, errorBody("Invalid JSON body"), "", keepAlive);
+    }
+    if (handler.token.empty()) {
+        ++rejectedCount;
+        return httpResponse(401, errorBody("401 Unauthorized: Access token does not exist"), "", keepAlive);
+    }
+    std::string response;
+    if (injectFailure(handler.token, keepAlive, response)) return response;
+
+    // Every repo starts out with the labels Gitee gives a new one
+    auto found = labels.find(owner + "/" + repo);
+    if (found == labels.end()) {
+        found = labels.emplace(owner + "/" + repo,
+                               std::vector<std::string>{"bug", "documentation", "duplicate", "enhancement", "feature",
+                                                        "invalid", "question", "wontfix"})
+                    .first;
+    }
+    std::vector<std::string>& names = found->second;
+
+    JsonWriter writer;
+    if (method == "GET") {
+        writer.beginArray();
+        for (size_t i = 0; i < names.size(); ++i) {
+            writer.beginObject().key("id").value((long long)i + 1).field("name", names[i]).field("color", "ededed");
+            writer.endObject();
+        }
+        writer.endArray();
+        return httpResponse(200, writer.take(), "", keepAlive);
+    }
+
+    if (handler.name.empty()) {
+        ++rejectedCount;
+        return httpResponse(400, errorBody("name is missing"), "", keepAlive);
+    }
+    if (std::find(names.begin(), names.end(), handler.name) != names.end()) {
+        ++rejectedCount;
+        return httpResponse(422, errorBody("Label already exists"), "", keepAlive);
+    }
+    names.push_back(handler.name);
+    writer.beginObject().key("id").value((long long)names.size()).field("name", handler.name);
+    writer.field("color", "ededed").endObject();
+    ++labelCount;
+    return httpResponse(201, writer.take(), "", keepAlive);
+}
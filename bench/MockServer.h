@@ -0,0 +1,133 @@
+#ifndef MOCKSERVER_H
+#define MOCKSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+class JsonWriter;
+
+// Local stand-in for the Gitee API, for load tests that must run offline.
+// Serves POST {prefix}/repos/{owner}/issues over plain HTTP/1.1 with keep-alive,
+// Content-Length or chunked request bodies and Expect: 100-continue. Created
+// issues are kept in memory, edited by PATCH {prefix}/repos/{owner}/issues/{number}
+// and listed by GET {prefix}/repos/{owner}/{repo}/issues (page, per_page, since;
+// newest first by updated_at, with total_count and total_page headers). Each repo
+// starts with Gitee's default labels, listed by GET and added by POST
+// {prefix}/repos/{owner}/{repo}/labels. Responses can be delayed and made to fail or throttle at
+// configurable rates.
+// Single-threaded (epoll); run() blocks until stop() is called.
+class MockServer {
+public:
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port = 0;                // 0 picks a free port
+        int latencyMs = 0;           // Added before every response
+        int jitterMs = 0;            // Plus a uniform random 0..jitterMs
+        double errorRate = 0;        // Fraction of requests answered with 500
+        double throttleRate = 0;     // Fraction of requests answered with 429
+        double rateLimit = 0;        // Requests per second per access token before 429 (0 = unlimited)
+        int retryAfterSeconds = 1;   // Retry-After sent with every 429
+        std::string seedRepo = "owner/repo"; // Repo that seedIssues are created in
+        int seedIssues = 0;          // Issues that exist before the first request
+    };
+
+    struct Stats {
+        uint64_t connections = 0;
+        uint64_t requests = 0;
+        uint64_t created = 0;
+        uint64_t updated = 0;
+        uint64_t listed = 0;      // Issue list pages served
+        uint64_t labels = 0;      // Labels created
+        uint64_t throttled = 0;
+        uint64_t errors = 0;      // Injected 500s
+        uint64_t rejected = 0;    // 400/401/404 for malformed requests
+    };
+
+    explicit MockServer(const Options& options);
+    ~MockServer();
+
+    MockServer(const MockServer&) = delete;
+    MockServer& operator=(const MockServer&) = delete;
+
+    // Binds and listens. Returns false (with a message on stderr) on failure.
+    bool start();
+    void run();
+    // Safe to call from another thread or a signal handler
+    void stop();
+
+    int getPort() const;
+    // e.g. "http://127.0.0.1:8080/api/v5"
+    std::string getBaseUrl() const;
+    Stats getStats() const;
+
+private:
+    struct Connection;
+    struct Delayed;
+    struct StoredIssue {
+        uint64_t id;
+        std::string title;
+        std::string body;
+        std::string labels;
+        std::string state;
+        std::string createdAt;
+        std::string updatedAt;
+    };
+    struct RateBucket {
+        double tokens = 0;
+        std::chrono::steady_clock::time_point refilled;
+    };
+
+    Options options;
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    int port;
+    uint64_t nextConnectionId;
+    uint64_t nextIssueId;
+    std::map<uint64_t, Connection*> connections;
+    std::vector<Delayed> delayed; // Min-heap on due time
+    std::map<std::string, RateBucket> rateBuckets;
+    std::map<std::string, std::vector<StoredIssue>> issues; // "owner/repo" -> issues in updated_at order
+    std::map<std::string, std::vector<std::string>> labels; // "owner/repo" -> label names
+    std::mt19937 rng;
+
+    std::atomic<uint64_t> connectionCount;
+    std::atomic<uint64_t> requestCount;
+    std::atomic<uint64_t> createdCount;
+    std::atomic<uint64_t> updatedCount;
+    std::atomic<uint64_t> listedCount;
+    std::atomic<uint64_t> labelCount;
+    std::atomic<uint64_t> throttledCount;
+    std::atomic<uint64_t> errorCount;
+    std::atomic<uint64_t> rejectedCount;
+
+    void accept();
+    void closeConnection(Connection* c);
+    void onReadable(Connection* c);
+    void flush(Connection* c);
+    // Parses one complete request from c->input if there is one
+    bool takeRequest(Connection* c, std::string& method, std::string& target, std::string& body, bool& keepAlive);
+    std::string respond(const std::string& method, const std::string& target, const std::string& body,
+                        bool keepAlive);
+    std::string createIssue(const std::string& owner, const std::string& body, bool keepAlive);
+    std::string updateIssue(const std::string& owner, const std::string& number, const std::string& body,
+                            bool keepAlive);
+    std::string listIssues(const std::string& owner, const std::string& repo, const std::string& target,
+                           bool keepAlive);
+    std::string repoLabels(const std::string& owner, const std::string& repo, const std::string& method,
+                           const std::string& target, const std::string& body, bool keepAlive);
+    // Produces a 429 or 500 response if the token is over its rate limit or a failure is injected
+    bool injectFailure(const std::string& token, bool keepAlive, std::string& response);
+    bool allowByRateLimit(const std::string& token, long& resetSeconds);
+    StoredIssue& storeIssue(const std::string& owner, const std::string& repo, const std::string& title,
+                            const std::string& body, const std::string& labels, const std::string& timestamp);
+    void writeIssue(JsonWriter& writer, const std::string& owner, const std::string& repo,
+                    const StoredIssue& issue) const;
+};
+
+#endif // MOCKSERVER_H
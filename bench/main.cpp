@@ -0,0 +1,976 @@
+// gitee-issue-bench: microbenchmarks for the CLI's hot paths.
+// Progress goes to stderr, the results to stdout (or --output) as JSON.
+
+#include "Base64.h"
+#include "Benchmark.h"
+#include "ConfigSetup.h"
+#include "Hasher.h"
+#include "IssueCreator.h"
+#include "IssueDedup.h"
+#include "IssueResponseParser.h"
+#include "IssueTemplate.h"
+#include "JsonTokenizer.h"
+#include "JsonWriter.h"
+#include "LoadGenerator.h"
+#include "LogWatcher.h"
+#include "MockServer.h"
+#include "RepoIndex.h"
+#include "cxxopts.hpp"
+#include <curl/curl.h>
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef GITEE_ISSUE_BUILD_TYPE
+#define GITEE_ISSUE_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+const std::string TOKEN = "5f2b1c9e8a7d6f3e2b1a0c9d8e7f6a5b";
+
+std::string randomBytes(size_t len, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string data(len, '\0');
+    for (char& c : data) c = (char)rng();
+    return data;
+}
+
+std::string opensslBase64(const std::string& data) {
+    std::string out(4 * ((data.size() + 2) / 3) + 1, '\0');
+    int len = EVP_EncodeBlock((unsigned char*)&out[0], (const unsigned char*)data.data(), (int)data.size());
+    out.resize(len);
+    return out;
+}
+
+// Shaped like a real POST /repos/{owner}/issues answer: the fields we want
+// are surrounded by nested objects that carry their own "id" and "html_url".
+std::string sampleIssueResponse() {
+    std::string body(1500, 'x');
+    std::ostringstream json;
+    json << R"({"id":123456789,"url":"https://gitee.com/api/v5/repos/owner/issues/I8ABCD",)"
+         << R"("repository_url":"https://gitee.com/api/v5/repos/owner/repo",)"
+         << R"("labels_url":"https://gitee.com/api/v5/repos/owner/repo/issues/I8ABCD/labels",)"
+         << R"("user":{"id":42,"login":"someone","name":"Some One","html_url":"https://gitee.com/someone",)"
+         << R"("avatar_url":"https://gitee.com/assets/no_portrait.png","type":"User"},)"
+         << R"("labels":[{"id":7,"name":"bug","color":"d73a4a"},{"id":8,"name":"ci","color":"0075ca"}],)"
+         << R"("html_url":"https://gitee.com/owner/repo/issues/I8ABCD","number":"I8ABCD","state":"open",)"
+         << R"("title":"Nightly build failed","body":")" << body << R"(",)"
+         << R"("repository":{"id":99,"full_name":"owner/repo","html_url":"https://gitee.com/owner/repo",)"
+         << R"("owner":{"id":42,"login":"someone"},"description":"A repository","fork":false},)"
+         << R"("created_at":"2024-01-01T00:00:00+08:00","updated_at":"2024-01-01T00:00:00+08:00","comments":0})";
+    return json.str();
+}
+
+void benchHasher(Benchmark& bench) {
+    Hasher hasher(ConfigSetup::getKey());
+    std::string encrypted = hasher.encrypt(TOKEN);
+    bench.check("hasher.roundtrip", hasher.decrypt(encrypted) == TOKEN);
+
+    std::string out;
+    bench.run("hasher.encrypt", {{"bytes", (long long)TOKEN.size()}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            hasher.encrypt(TOKEN, out);
+            doNotOptimize(out);
+        }
+    }, (double)TOKEN.size());
+
+    bench.run("hasher.decrypt", {{"bytes", (long long)TOKEN.size()}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            hasher.decrypt(encrypted, out);
+            doNotOptimize(out);
+        }
+    }, (double)TOKEN.size());
+
+    // A fresh Hasher per token, as a caller without a long-lived instance pays
+    bench.run("hasher.decrypt_cold", {{"bytes", (long long)TOKEN.size()}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            Hasher cold(ConfigSetup::getKey());
+            doNotOptimize(cold.decrypt(encrypted));
+        }
+    }, (double)TOKEN.size());
+
+    const std::string payload = randomBytes(64 * 1024, 1);
+    bench.run("hasher.encrypt_stream", {{"bytes", (long long)payload.size()}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out.clear();
+            hasher.beginEncrypt();
+            for (size_t off = 0; off < payload.size(); off += 4096) {
+                hasher.updateEncrypt(payload.data() + off, std::min<size_t>(4096, payload.size() - off), out);
+            }
+            hasher.finalEncrypt(out);
+            doNotOptimize(out);
+        }
+    }, (double)payload.size());
+}
+
+bool verifyBase64(Base64::Kernel kernel) {
+    // Every 1- and 2-byte input, then random lengths across the vector block sizes
+    for (int v = 0; v < 256 + 65536; ++v) {
+        std::string data = v < 256 ? std::string(1, (char)v) : std::string{(char)(v >> 8), (char)(v & 0xFF)};
+        std::string encoded, decoded;
+        Base64::encode(data.data(), data.size(), encoded, kernel);
+        if (encoded != opensslBase64(data)) return false;
+        if (!Base64::decode(encoded.data(), encoded.size(), decoded, kernel) || decoded != data) return false;
+    }
+    for (size_t len = 0; len < 1024; ++len) {
+        std::string data = randomBytes(len, (unsigned)len);
+        std::string expected = opensslBase64(data);
+        std::string encoded, decoded;
+        Base64::encode(data.data(), data.size(), encoded, kernel);
+        if (encoded != expected) return false;
+        if (!Base64::decode(expected.data(), expected.size(), decoded, kernel) || decoded != data) return false;
+        if (len > 0) {
+            std::string corrupt = expected;
+            corrupt[len % (expected.size() - 2)] = '*';
+            decoded.clear();
+            if (Base64::decode(corrupt.data(), corrupt.size(), decoded, kernel) || !decoded.empty()) return false;
+        }
+    }
+    return true;
+}
+
+void benchBase64(Benchmark& bench) {
+    std::vector<Base64::Kernel> kernels = {Base64::Kernel::Scalar};
+    if (Base64::bestKernel() != Base64::Kernel::Scalar) kernels.push_back(Base64::Kernel::SSSE3);
+    if (Base64::bestKernel() == Base64::Kernel::AVX2) kernels.push_back(Base64::Kernel::AVX2);
+
+    for (Base64::Kernel kernel : kernels) {
+        std::string name = Base64::kernelName(kernel);
+        if (bench.enabled("base64.encode." + name) || bench.enabled("base64.decode." + name)) {
+            bench.check("base64.matches_openssl." + name, verifyBase64(kernel));
+        }
+
+        for (size_t size : {48, 64 * 1024}) {
+            const std::string data = randomBytes(size, 2);
+            const std::string encoded = opensslBase64(data);
+            std::string out;
+            bench.run("base64.encode." + name, {{"bytes", (long long)size}}, [&](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    out.clear();
+                    Base64::encode(data.data(), data.size(), out, kernel);
+                    doNotOptimize(out);
+                }
+            }, (double)size);
+            bench.run("base64.decode." + name, {{"bytes", (long long)size}}, [&](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    out.clear();
+                    Base64::decode(encoded.data(), encoded.size(), out, kernel);
+                    doNotOptimize(out);
+                }
+            }, (double)size);
+        }
+    }
+
+    const std::string data = randomBytes(64 * 1024, 2);
+    bench.run("base64.encode.openssl", {{"bytes", (long long)data.size()}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(opensslBase64(data));
+    }, (double)data.size());
+}
+
+void benchJson(Benchmark& bench) {
+    const std::string title = "Nightly build failed on \"main\"";
+    const std::string labels = "bug,ci";
+    JsonWriter writer;
+
+    // The request must read back unchanged through our own tokenizer
+    {
+        const std::string body = "Line 1\nLine 2\té中\x01";
+        IssueCreator::buildRequestBody(writer, TOKEN, "repo", title, body, labels);
+        struct Reader : JsonHandler {
+            std::string key, title, body;
+            bool onKey(const std::string& k) override { key = k; return true; }
+            void onString(const std::string& v) override {
+                if (key == "title") title = v;
+                if (key == "body") body = v;
+            }
+        } reader;
+        JsonTokenizer tokenizer(reader);
+        bool ok = tokenizer.feed(writer.data(), writer.size()) && tokenizer.finish();
+        bench.check("json.request_roundtrip", ok && reader.title == title && reader.body == body);
+    }
+
+    for (size_t size : {200, 64 * 1024}) {
+        std::string body(size, 'a');
+        for (size_t i = 0; i < size; i += 80) body[i] = '\n';
+        bench.run("json.build_request", {{"body_bytes", (long long)size}}, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                IssueCreator::buildRequestBody(writer, TOKEN, "repo", title, body, labels);
+                doNotOptimize(writer.data());
+            }
+        }, (double)size);
+    }
+}
+
+// A typical flaky-test report: a few short variables and a multi-line log excerpt
+void benchTemplate(Benchmark& bench) {
+    std::string text = "## Test failure\n\n"
+                       "**Test:** `{{test}}`\n**Commit:** {{commit}}\n**Runner:** {{runner}}\n\n"
+                       "The test failed on the nightly build. It has been retried once and failed again, "
+                       "so it is probably not a network hiccup. Please have a look at the log below and "
+                       "either fix the test or mark it as flaky with a link to this issue.\n\n"
+                       "<details><summary>Log excerpt</summary>\n\n```\n{{log}}\n```\n</details>\n\n"
+                       "_Reported automatically for {{commit}}._\n";
+    std::string log;
+    for (int i = 0; i < 20; ++i) log += "[2024-01-01 00:00:" + std::to_string(10 + i) + "] step " +
+                                        std::to_string(i) + ": \"assert\" failed\tat parser.cpp:42\n";
+    const std::string test = "parser_spec::handles_nested_quotes";
+    const std::string commit = "3f2a9c1d";
+    const std::string runner = "ci-linux-04";
+    const std::string title = "Test failed: " + test;
+
+    IssueTemplate tmpl(text);
+    IssueTemplate::Values values;
+    for (const std::string& name : tmpl.variables()) {
+        values.push_back(name == "test" ? test : name == "commit" ? commit : name == "runner" ? runner : log);
+    }
+    JsonWriter writer;
+    std::string rendered;
+    tmpl.render(rendered, values);
+
+    // Rendering into the payload must give the same request as rendering first
+    {
+        IssueCreator::buildRequestBody(writer, TOKEN, "repo", title, rendered, "bug");
+        std::string expected = writer.str();
+        IssueCreator::buildRequestBody(writer, TOKEN, "repo", title, tmpl, values, "bug");
+        bench.check("template.render_matches", writer.str() == expected && tmpl.variables().size() == 4);
+    }
+
+    Benchmark::Params params = {{"template_bytes", (long long)text.size()}, {"body_bytes", (long long)rendered.size()}};
+    bench.run("template.compile", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(IssueTemplate(text).variables().size());
+    }, (double)text.size());
+    bench.run("template.render_request", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            IssueCreator::buildRequestBody(writer, TOKEN, "repo", title, tmpl, values, "bug");
+            doNotOptimize(writer.data());
+        }
+    }, (double)rendered.size());
+    // The old way: substitute into a string with find/replace, then escape it into the payload
+    bench.run("template.substitute_then_build", params, [&](size_t n) {
+        std::string body;
+        for (size_t i = 0; i < n; ++i) {
+            body = text;
+            const std::pair<const char*, const std::string*> vars[] = {
+                {"{{test}}", &test}, {"{{commit}}", &commit}, {"{{runner}}", &runner}, {"{{log}}", &log}};
+            for (const auto& var : vars) {
+                for (size_t pos = body.find(var.first); pos != std::string::npos;
+                     pos = body.find(var.first, pos + var.second->size())) {
+                    body.replace(pos, std::strlen(var.first), *var.second);
+                }
+            }
+            IssueCreator::buildRequestBody(writer, TOKEN, "repo", title, body, "bug");
+            doNotOptimize(writer.data());
+        }
+    }, (double)rendered.size());
+
+    // What the rendering is weighed against: one keep-alive request to a local mock, no network latency
+    if (!bench.enabled("template.http_send")) return;
+    MockServer::Options mockOptions;
+    MockServer mock(mockOptions);
+    if (!mock.start()) {
+        bench.check("template.mock_server", false);
+        return;
+    }
+    std::thread mockThread(&MockServer::run, &mock);
+    std::string previousUrl = IssueCreator::getApiBaseUrl();
+    IssueCreator::setApiBaseUrl(mock.getBaseUrl());
+    {
+        IssueCreator creator("owner", "repo", TOKEN);
+        bench.run("template.http_send", params, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) doNotOptimize(creator.createIssue(title, rendered, "bug"));
+        }, (double)rendered.size());
+    }
+    IssueCreator::setApiBaseUrl(previousUrl);
+    mock.stop();
+    mockThread.join();
+}
+
+// --watch on a busy service log: mostly INFO lines, one in a hundred an error
+// from a handful of signatures that differ only in ids and numbers
+void benchWatch(Benchmark& bench) {
+    const char* errors[] = {"ERROR db: connection refused to 10.0.%d.%d:5432",
+                            "FATAL worker %d exited with code %d",
+                            "java.lang.NullPointerException at Foo.java:%d (%d)"};
+    std::string log;
+    std::vector<size_t> lineStarts;
+    char line[256];
+    std::mt19937 rng(5);
+    const size_t Lines = 100000;
+    for (size_t i = 0; i < Lines; ++i) {
+        lineStarts.push_back(log.size());
+        int len = std::snprintf(line, sizeof(line), "2026-10-17T10:00:%02zu.%03zuZ [pid %zu] ", i % 60, i % 1000, i % 977);
+        if (i % 100 == 0) {
+            len += std::snprintf(line + len, sizeof(line) - len, errors[rng() % 3], (int)(rng() % 300), (int)(rng() % 9999));
+        } else {
+            len += std::snprintf(line + len, sizeof(line) - len,
+                                 "INFO request id=%zu path=/api/v1/items/%zu status=200 took=%zums", i, i % 5000,
+                                 i % 300);
+        }
+        log.append(line, (size_t)len).push_back('\n');
+    }
+    lineStarts.push_back(log.size());
+
+    SignatureMatcher matcher;
+    std::string error;
+    for (const std::string& pattern : SignatureMatcher::defaultPatterns()) matcher.addPattern(pattern, error);
+
+    {
+        std::vector<WatchedError> filed;
+        LogWatcher watcher(LogWatcher::Options(), matcher, [&filed](WatchedError&& e) { filed.push_back(std::move(e)); });
+        watcher.feed(log.data(), log.size());
+        watcher.finish();
+        size_t occurrences = 0;
+        for (const WatchedError& e : filed) occurrences += e.occurrences;
+        bench.check("watch.coalesce", filed.size() == 3 && occurrences == Lines / 100 &&
+                                          watcher.getStats().lines == Lines);
+    }
+
+    // One op is one line, fed in 512-line reads as run() would get them from a pipe
+    const size_t LinesPerRead = 512;
+    Benchmark::Params params = {{"lines", (long long)Lines}, {"error_percent", 1}};
+    size_t totalLines = 0;
+    LogWatcher watcher(LogWatcher::Options(), matcher, [](WatchedError&& e) { doNotOptimize(e.occurrences); });
+    bench.run("watch.feed", params, [&](size_t n) {
+        for (size_t done = 0; done < n; done += LinesPerRead) {
+            size_t first = totalLines % Lines;
+            size_t last = std::min(first + LinesPerRead, Lines);
+            watcher.feed(log.data() + lineStarts[first], lineStarts[last] - lineStarts[first]);
+            totalLines += last - first;
+        }
+    }, (double)log.size() / Lines);
+}
+
+void benchResponse(Benchmark& bench) {
+    const std::string response = sampleIssueResponse();
+    IssueResult parsed = IssueResponseParser::parse(response);
+    bench.check("response.extract_id", parsed.id == 123456789 && parsed.number == "I8ABCD" &&
+                                           parsed.htmlUrl == "https://gitee.com/owner/repo/issues/I8ABCD");
+
+    bench.run("response.parse", {{"bytes", (long long)response.size()}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(IssueResponseParser::parse(response).id);
+    }, (double)response.size());
+
+    // As curl delivers it: 1 KiB chunks into a reused parser
+    IssueResponseParser parser;
+    bench.run("response.parse_streaming", {{"bytes", (long long)response.size()}, {"chunk", 1024}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            parser.reset();
+            for (size_t off = 0; off < response.size() && !parser.isComplete(); off += 1024) {
+                parser.feed(response.data() + off, std::min<size_t>(1024, response.size() - off));
+            }
+            IssueResult result;
+            parser.fill(result);
+            doNotOptimize(result.id);
+        }
+    }, (double)response.size());
+}
+
+std::string ownerName(size_t i) { return "owner" + std::to_string(i); }
+std::string repoName(size_t i) { return "repo" + std::to_string(i); }
+
+void benchConfig(Benchmark& bench, const std::string& dir, size_t rows) {
+    static const char* names[] = {"config.getConfig", "config.getDefaultRepoConfig", "config.getDecryptedDefaultToken",
+                                  "config.getConfigs", "config.getDataVersion", "config.saveConfig",
+                                  "config.setDefaultRepo", "config.deleteRepo+saveConfig", "config.enqueueIssue",
+                                  "config.countPendingOutbox", "config.claimAndRecordOutbox", "config.complete"};
+    // Populating 100k rows takes seconds; skip it when nothing here will run
+    if (std::none_of(std::begin(names), std::end(names), [&](const char* n) { return bench.enabled(n); })) return;
+
+    std::string path = dir + "/config-" + std::to_string(rows) + ".db";
+    ConfigSetup config(path);
+    if (!config.openDB()) {
+        bench.check("config.open", false);
+        return;
+    }
+
+    std::cerr << "Populating " << rows << " repositories..." << std::endl;
+    for (size_t i = 0; i < rows; ++i) {
+        config.saveConfig(repoName(i), ownerName(i), TOKEN);
+    }
+    // An outbox with as many already-sent issues, so the pending scan has rows to skip
+    std::vector<OutboxResult> done;
+    for (size_t i = 0; i < rows; ++i) {
+        config.enqueueIssue(ownerName(i), repoName(i), "title", "body", "");
+    }
+    for (;;) {
+        std::vector<OutboxItem> items = config.claimOutboxBatch(1000);
+        if (items.empty()) break;
+        done.clear();
+        for (const OutboxItem& item : items) {
+            OutboxResult r;
+            r.id = item.id;
+            r.success = true;
+            done.push_back(r);
+        }
+        config.recordOutboxResults(done);
+    }
+    // Writes the repo index for config.complete
+    config.closeDB();
+    config.openDB();
+
+    const Benchmark::Params params = {{"rows", (long long)rows}};
+    std::mt19937 rng(3);
+    RepoConfig cfg;
+
+    bench.check("config.getConfig.rows=" + std::to_string(rows),
+                config.getConfig(ownerName(rows - 1), repoName(rows - 1), cfg) && cfg.repo == repoName(rows - 1));
+
+    bench.run("config.getConfig", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            size_t k = rng() % rows;
+            doNotOptimize(config.getConfig(ownerName(k), repoName(k), cfg));
+        }
+    });
+    bench.run("config.getDefaultRepoConfig", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(config.getDefaultRepoConfig(cfg));
+    });
+    // What --complete does on each Tab press: map the index and list one owner's repos
+    {
+        std::string out;
+        RepoIndex index;
+        bench.check("config.complete.rows=" + std::to_string(rows),
+                    index.open(ConfigSetup::repoIndexPath(path)) && index.complete(ownerName(0) + "/", out) == 1 &&
+                        out == ownerName(0) + "/" + repoName(0) + "\n");
+    }
+    bench.run("config.complete", params, [&](size_t n) {
+        std::string out;
+        for (size_t i = 0; i < n; ++i) {
+            RepoIndex index;
+            index.open(ConfigSetup::repoIndexPath(path));
+            out.clear();
+            doNotOptimize(index.complete(ownerName(rng() % rows) + "/", out));
+        }
+    });
+    bench.run("config.getDecryptedDefaultToken", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(config.getDecryptedDefaultToken());
+    });
+    bench.run("config.getConfigs", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(config.getConfigs().size());
+    });
+    bench.run("config.getDataVersion", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(config.getDataVersion());
+    });
+    bench.run("config.saveConfig", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            size_t k = rng() % rows;
+            config.saveConfig(repoName(k), ownerName(k), TOKEN);
+        }
+    });
+    bench.run("config.setDefaultRepo", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            size_t k = rng() % rows;
+            config.setDefaultRepo(ownerName(k), repoName(k));
+        }
+    });
+    bench.run("config.deleteRepo+saveConfig", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            size_t k = rng() % rows;
+            config.deleteRepo(ownerName(k), repoName(k));
+            config.saveConfig(repoName(k), ownerName(k), TOKEN);
+        }
+    });
+    bench.run("config.enqueueIssue", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) config.enqueueIssue("owner", "repo", "title", "body", "bug");
+    });
+    bench.run("config.countPendingOutbox", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(config.countPendingOutbox());
+    });
+    // One drain round trip: claim up to 100 items and record them as sent
+    bench.run("config.claimAndRecordOutbox", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            for (int j = 0; j < 100; ++j) config.enqueueIssue("owner", "repo", "title", "body", "");
+            std::vector<OutboxItem> items = config.claimOutboxBatch(100);
+            done.clear();
+            for (const OutboxItem& item : items) {
+                OutboxResult r;
+                r.id = item.id;
+                r.success = true;
+                done.push_back(r);
+            }
+            config.recordOutboxResults(done);
+        }
+    });
+
+    config.closeDB();
+}
+
+// Dedup index lookups against a table of `rows` remembered issues
+void benchDedup(Benchmark& bench, const std::string& dir, size_t rows) {
+    static const char* names[] = {"dedup.contentHash", "dedup.find", "dedup.remember"};
+    if (std::none_of(std::begin(names), std::end(names), [&](const char* n) { return bench.enabled(n); })) return;
+
+    std::string path = dir + "/dedup-" + std::to_string(rows) + ".db";
+    ConfigSetup config(path);
+    if (!config.openDB()) {
+        bench.check("dedup.open", false);
+        return;
+    }
+
+    // saveKnownIssue commits every row; fill the table in one transaction instead
+    std::cerr << "Populating " << rows << " remembered issues..." << std::endl;
+    sqlite3* db = nullptr;
+    sqlite3_open(path.c_str(), &db);
+    // Random keys touch the whole B-tree; keep it in cache while inserting
+    sqlite3_exec(db, "PRAGMA cache_size = -262144; BEGIN;", nullptr, nullptr, nullptr);
+    sqlite3_stmt* insert = nullptr;
+    sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO issue_hashes (hash, owner, repo, issue_id, created_at) "
+                           "VALUES (?, 'owner', 'repo', ?, ?);", -1, &insert, nullptr);
+    sqlite3_int64 now = (sqlite3_int64)std::time(nullptr);
+    for (size_t i = 0; i < rows; ++i) {
+        std::string title = "Flaky test " + std::to_string(i);
+        sqlite3_bind_int64(insert, 1, (sqlite3_int64)IssueDedup::contentHash("owner", "repo", title, "body"));
+        sqlite3_bind_int64(insert, 2, (sqlite3_int64)i);
+        sqlite3_bind_int64(insert, 3, now);
+        sqlite3_step(insert);
+        sqlite3_reset(insert);
+    }
+    sqlite3_finalize(insert);
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+
+    const Benchmark::Params params = {{"rows", (long long)rows}};
+    IssueDedup dedup(config, 86400);
+    std::mt19937 rng(5);
+    std::string body(1024, 'b');
+    IssueResult result;
+
+    size_t probe = rows / 2;
+    bench.check("dedup.find.rows=" + std::to_string(rows),
+                dedup.find("Owner", "repo", "  Flaky   test " + std::to_string(probe) + " ", "\r\nbody  \r\n", result) &&
+                    result.duplicate && result.id == (long long)probe &&
+                    !dedup.find("owner", "repo", "Flaky test " + std::to_string(probe), "other body", result));
+
+    bench.run("dedup.contentHash", {{"body_bytes", (long long)body.size()}}, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) doNotOptimize(IssueDedup::contentHash("owner", "repo", "Flaky test", body));
+    }, (double)body.size());
+    bench.run("dedup.find", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            // Half hits, half misses
+            size_t k = rng() % (rows * 2);
+            doNotOptimize(dedup.find("owner", "repo", "Flaky test " + std::to_string(k), "body", result));
+        }
+    });
+    IssueResult created;
+    created.success = true;
+    bench.run("dedup.remember", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            created.id = (long long)(rows + rng() % rows);
+            dedup.remember("owner", "repo", "Flaky test " + std::to_string(created.id), "body", "", created);
+        }
+    });
+
+    config.closeDB();
+}
+
+// Synthetic issue text: word k of a 50,000-word vocabulary is drawn with
+// probability proportional to 1/(k+1), like words in real text
+class ZipfWords {
+public:
+    explicit ZipfWords(unsigned seed) : rng(seed) {
+        double total = 0;
+        for (size_t k = 0; k < Vocabulary; ++k) {
+            total += 1.0 / (double)(k + 1);
+            cumulative.push_back(total);
+        }
+    }
+
+    static std::string word(size_t k) { return "w" + std::to_string(k); }
+
+    std::string text(size_t words) {
+        std::string out;
+        std::uniform_real_distribution<double> pick(0, cumulative.back());
+        for (size_t i = 0; i < words; ++i) {
+            size_t k = (size_t)(std::lower_bound(cumulative.begin(), cumulative.end(), pick(rng)) - cumulative.begin());
+            if (i) out += ' ';
+            out += word(k);
+        }
+        return out;
+    }
+
+private:
+    static const size_t Vocabulary = 50000;
+    std::mt19937 rng;
+    std::vector<double> cumulative;
+};
+
+// Full-text search over `rows` cached issues spread over 100 repos
+void benchSearch(Benchmark& bench, const std::string& dir, size_t rows) {
+    static const char* names[] = {"search.rare", "search.common", "search.twoWords", "search.prefix",
+                                  "search.repoFilter", "search.upsertPage"};
+    if (std::none_of(std::begin(names), std::end(names), [&](const char* n) { return bench.enabled(n); })) return;
+
+    std::string path = dir + "/search-" + std::to_string(rows) + ".db";
+    ConfigSetup config(path);
+    if (!config.openDB()) {
+        bench.check("search.open", false);
+        return;
+    }
+
+    // Written a page at a time, the way --sync does, so the index triggers run as they would there
+    std::cerr << "Populating " << rows << " cached issues..." << std::endl;
+    ZipfWords words(11);
+    std::vector<CachedIssue> page;
+    for (size_t i = 0; i < rows; ++i) {
+        CachedIssue issue;
+        issue.id = (long long)i + 1;
+        issue.owner = "owner";
+        issue.repo = repoName(i % 100);
+        issue.number = "I" + std::to_string(i + 1);
+        issue.title = words.text(6);
+        issue.body = words.text(40);
+        issue.state = "open";
+        page.push_back(std::move(issue));
+        if (page.size() == 10000 || i + 1 == rows) {
+            config.upsertIssues(page);
+            page.clear();
+        }
+    }
+
+    const Benchmark::Params params = {{"rows", (long long)rows}};
+    std::vector<IssueMatch> matches;
+    std::mt19937 rng(13);
+
+    // A unique word in one issue must come back first, and the index must follow updates
+    CachedIssue marked;
+    marked.id = (long long)rows / 2;
+    marked.owner = "owner";
+    marked.repo = repoName((size_t)marked.id % 100);
+    marked.number = "I" + std::to_string(marked.id);
+    marked.title = "Segfault in parser";
+    marked.body = "needle-in-haystack";
+    config.upsertIssues({marked});
+    bool found = config.searchIssues("segfault parser", "", "", 10, matches) && !matches.empty() &&
+                 matches[0].issue.id == marked.id && config.searchIssues("needle-in-haystack", "", "", 10, matches) &&
+                 matches.size() == 1;
+    marked.body = "replaced";
+    config.upsertIssues({marked});
+    bench.check("search.rows=" + std::to_string(rows),
+                found && config.searchIssues("needle-in-haystack", "", "", 10, matches) && matches.empty());
+
+    // Words near the end of the vocabulary are in a few dozen issues, w3 in about one in six
+    bench.run("search.rare", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            config.searchIssues(ZipfWords::word(40000 + rng() % 10000), "", "", 20, matches);
+            doNotOptimize(matches.size());
+        }
+    });
+    bench.run("search.common", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            config.searchIssues(ZipfWords::word(3), "", "", 20, matches);
+            doNotOptimize(matches.size());
+        }
+    });
+    bench.run("search.twoWords", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            config.searchIssues(ZipfWords::word(10 + rng() % 100) + " " + ZipfWords::word(100 + rng() % 1000), "",
+                                "", 20, matches);
+            doNotOptimize(matches.size());
+        }
+    });
+    bench.run("search.prefix", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            config.searchIssues(ZipfWords::word(1000 + rng() % 9000) + "*", "", "", 20, matches);
+            doNotOptimize(matches.size());
+        }
+    });
+    bench.run("search.repoFilter", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            config.searchIssues(ZipfWords::word(100 + rng() % 1000), "owner", repoName(rng() % 100), 20, matches);
+            doNotOptimize(matches.size());
+        }
+    });
+    // One synced page of 100 changed issues, index maintenance included
+    bench.run("search.upsertPage", params, [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            page.clear();
+            for (int j = 0; j < 100; ++j) {
+                CachedIssue issue;
+                issue.id = (long long)(rng() % rows) + 1;
+                issue.owner = "owner";
+                issue.repo = repoName((size_t)issue.id % 100);
+                issue.number = "I" + std::to_string(issue.id);
+                issue.title = words.text(6);
+                issue.body = words.text(40);
+                issue.state = "open";
+                page.push_back(std::move(issue));
+            }
+            config.upsertIssues(page);
+        }
+    });
+
+    config.closeDB();
+}
+
+// N processes share one database, as parallel CI jobs do, for a fixed time.
+// Each loops over enqueue, default switch and default read; reports operations
+// completed, how often a process found the database locked, and failures.
+void benchContention(Benchmark& bench, const std::string& dir, int processes, double seconds) {
+    const std::string name = "config.contention";
+    if (!bench.enabled(name)) return;
+
+    std::string path = dir + "/contention.db";
+    {
+        ConfigSetup config(path);
+        if (!config.openDB()) {
+            bench.check(name + ".open", false);
+            return;
+        }
+        for (int i = 0; i < 16; ++i) config.saveConfig(repoName(i), ownerName(i), TOKEN);
+    }
+
+    std::cerr << "Running " << processes << " processes against one database..." << std::endl;
+    std::vector<std::pair<pid_t, int>> children;
+    for (int p = 0; p < processes; ++p) {
+        int fds[2];
+        if (pipe(fds) != 0) break;
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            ConfigSetup config(path);
+            config.setBusyTimeout(30000);
+            long long ops = 0, failures = 0, noDefault = 0;
+            if (config.openDB()) {
+                auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+                RepoConfig cfg;
+                for (int i = 0; std::chrono::steady_clock::now() < end; ++i) {
+                    bool ok;
+                    switch (i % 3) {
+                        case 0: ok = config.enqueueIssue("owner", "repo", "title", "body", "") > 0; break;
+                        case 1: ok = config.setDefaultRepo(ownerName((size_t)(p + i) % 16), repoName((size_t)(p + i) % 16)); break;
+                        default:
+                            ok = config.getDefaultRepoConfig(cfg);
+                            if (!ok) ++noDefault;
+                    }
+                    ++ops;
+                    if (!ok) ++failures;
+                }
+            } else {
+                failures = 1;
+            }
+            std::string report = std::to_string(ops) + " " + std::to_string(config.getBusyCount()) + " " +
+                                 std::to_string(failures) + " " + std::to_string(noDefault);
+            if (write(fds[1], report.data(), report.size()) < 0) _exit(1);
+            _exit(0);
+        }
+        close(fds[1]);
+        children.emplace_back(pid, fds[0]);
+    }
+
+    long long ops = 0, busy = 0, failures = 0, noDefault = 0;
+    for (auto& child : children) {
+        char buffer[128] = {0};
+        ssize_t n = read(child.second, buffer, sizeof(buffer) - 1);
+        close(child.second);
+        waitpid(child.first, nullptr, 0);
+        long long o = 0, b = 0, f = 0, d = 0;
+        if (n > 0 && std::sscanf(buffer, "%lld %lld %lld %lld", &o, &b, &f, &d) == 4) {
+            ops += o;
+            busy += b;
+            failures += f;
+            noDefault += d;
+        } else {
+            ++failures;
+        }
+    }
+
+    // Readers must always see exactly one default, even mid-switch
+    bench.check(name + ".default_always_visible", noDefault == 0);
+
+    Benchmark::Result result;
+    result.name = name;
+    result.params = {{"processes", processes}, {"duration_ms", (long long)(seconds * 1000)}};
+    result.iterations = (uint64_t)ops;
+    result.nsPerOp = ops > 0 ? seconds * 1e9 / ops : 0;
+    result.metrics = {{"sqlite_busy", (double)busy}, {"failures", (double)failures}};
+    bench.addResult(result);
+}
+
+// End-to-end: the real client against a mock API, either one we start here or --api-url
+void benchLoad(Benchmark& bench, const cxxopts::ParseResult& result) {
+    MockServer::Options mockOptions;
+    mockOptions.latencyMs = result["latency-ms"].as<int>();
+    mockOptions.jitterMs = result["jitter-ms"].as<int>();
+    mockOptions.errorRate = result["error-rate"].as<double>();
+    mockOptions.throttleRate = result["throttle-rate"].as<double>();
+    mockOptions.retryAfterSeconds = 0; // Let the client's own backoff pace retries
+    MockServer mock(mockOptions);
+    std::thread mockThread;
+
+    LoadGenerator::Options options;
+    options.concurrency = std::max(1, result["concurrency"].as<int>());
+    options.requests = (size_t)std::max(1, result["requests"].as<int>());
+    options.bodyBytes = (size_t)std::max(0, result["body-bytes"].as<int>());
+    options.maxRetries = std::max(0, result["max-retries"].as<int>());
+    if (result.count("api-url")) {
+        options.apiUrl = result["api-url"].as<std::string>();
+    } else {
+        if (!mock.start()) {
+            bench.check("load.mock_server", false);
+            return;
+        }
+        mockThread = std::thread(&MockServer::run, &mock);
+        options.apiUrl = mock.getBaseUrl();
+    }
+
+    std::cerr << "Sending " << options.requests << " issues to " << options.apiUrl << " with concurrency "
+              << options.concurrency << "..." << std::endl;
+    LoadGenerator::Report report = LoadGenerator::run(options);
+
+    if (mockThread.joinable()) {
+        mock.stop();
+        mockThread.join();
+    }
+
+    Benchmark::Result entry;
+    entry.name = "load.create_issue";
+    entry.params = {{"concurrency", options.concurrency},
+                    {"requests", (long long)options.requests},
+                    {"body_bytes", (long long)options.bodyBytes}};
+    entry.iterations = report.succeeded + report.failed;
+    entry.nsPerOp = entry.iterations ? report.seconds * 1e9 / entry.iterations : 0;
+    const Histogram& latency = report.latencyUs;
+    entry.metrics = {{"p50_us", (double)latency.valueAtQuantile(0.50)},
+                     {"p99_us", (double)latency.valueAtQuantile(0.99)},
+                     {"p999_us", (double)latency.valueAtQuantile(0.999)},
+                     {"max_us", (double)latency.getMax()},
+                     {"succeeded", (double)report.succeeded},
+                     {"failed", (double)report.failed},
+                     {"retries", (double)report.retries},
+                     {"throttled", (double)report.throttled},
+                     {"new_connections", (double)report.newConnections}};
+
+    // Where each exchange spent its time, as seen by libcurl
+    for (RequestMetrics::Phase phase : {RequestMetrics::Phase::Connect, RequestMetrics::Phase::FirstByte,
+                                        RequestMetrics::Phase::Total}) {
+        Histogram h = report.metrics->getPhase(phase);
+        std::string name = RequestMetrics::phaseName(phase);
+        entry.metrics.emplace_back(name + "_p50_us", (double)h.valueAtQuantile(0.50));
+        entry.metrics.emplace_back(name + "_p99_us", (double)h.valueAtQuantile(0.99));
+    }
+
+    // Cumulative counts folded into power-of-two microsecond buckets, empty ones left out
+    uint64_t below = 0;
+    for (uint64_t le = 1; below < latency.getCount(); le *= 2) {
+        uint64_t count = latency.countAtOrBelow(le);
+        if (count > below) entry.histogram.emplace_back((double)le, count - below);
+        below = count;
+    }
+    bench.addResult(entry);
+}
+
+std::vector<size_t> parseRows(const std::string& list) {
+    std::vector<size_t> rows;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        long long value = std::atoll(item.c_str());
+        if (value > 0) rows.push_back((size_t)value);
+    }
+    return rows;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("gitee-issue-bench", "Microbenchmarks for gitee-issue");
+    options.add_options()
+        ("filter", "Only run benchmarks whose name contains this text", cxxopts::value<std::string>()->default_value(""))
+        ("min-time", "Minimum measured time per benchmark, in milliseconds", cxxopts::value<double>()->default_value("200"))
+        ("rows", "Comma-separated repository counts for the config benchmarks", cxxopts::value<std::string>()->default_value("10,1000,100000"))
+        ("dedup-rows", "Comma-separated remembered-issue counts for the dedup benchmarks", cxxopts::value<std::string>()->default_value("1000000"))
+        ("search-rows", "Comma-separated cached-issue counts for the search benchmarks", cxxopts::value<std::string>()->default_value("1000000"))
+        ("processes", "Processes in the config contention benchmark", cxxopts::value<int>()->default_value("8"))
+        ("duration", "Seconds the contention benchmark runs", cxxopts::value<double>()->default_value("2"))
+        ("o,output", "Write the JSON results to this file instead of stdout", cxxopts::value<std::string>())
+        ("h,help", "Print help");
+    options.add_options("Load test")
+        ("load", "Run the end-to-end load test instead of the microbenchmarks")
+        ("api-url", "API base URL to load (default: start a local mock server)", cxxopts::value<std::string>())
+        ("concurrency", "Requests in flight", cxxopts::value<int>()->default_value("32"))
+        ("requests", "Issues to create", cxxopts::value<int>()->default_value("10000"))
+        ("body-bytes", "Size of each issue body", cxxopts::value<int>()->default_value("512"))
+        ("max-retries", "Client retries for 429 and 5xx answers", cxxopts::value<int>()->default_value("5"))
+        ("latency-ms", "Mock server: delay before every response", cxxopts::value<int>()->default_value("0"))
+        ("jitter-ms", "Mock server: extra random delay, up to this many milliseconds", cxxopts::value<int>()->default_value("0"))
+        ("error-rate", "Mock server: fraction of requests answered with HTTP 500", cxxopts::value<double>()->default_value("0"))
+        ("throttle-rate", "Mock server: fraction of requests answered with HTTP 429", cxxopts::value<double>()->default_value("0"));
+
+    cxxopts::ParseResult result;
+    try {
+        result = options.parse(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    }
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    char dirTemplate[] = "/tmp/gitee-issue-bench-XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        std::cerr << "❌ Failed to create a scratch directory" << std::endl;
+        return 1;
+    }
+    std::string dir = dirTemplate;
+
+    Benchmark bench(result["min-time"].as<double>(), result["filter"].as<std::string>());
+    if (result.count("load")) {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        benchLoad(bench, result);
+    } else {
+        benchHasher(bench);
+        benchBase64(bench);
+        benchJson(bench);
+        benchTemplate(bench);
+        benchWatch(bench);
+        benchResponse(bench);
+        for (size_t rows : parseRows(result["rows"].as<std::string>())) {
+            benchConfig(bench, dir, rows);
+        }
+        for (size_t rows : parseRows(result["dedup-rows"].as<std::string>())) {
+            benchDedup(bench, dir, rows);
+        }
+        for (size_t rows : parseRows(result["search-rows"].as<std::string>())) {
+            benchSearch(bench, dir, rows);
+        }
+        benchContention(bench, dir, std::max(1, result["processes"].as<int>()), result["duration"].as<double>());
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    std::vector<std::pair<std::string, std::string>> context = {
+        {"date", date},
+        {"build_type", GITEE_ISSUE_BUILD_TYPE},
+        {"compiler", __VERSION__},
+        {"base64_kernel", Base64::kernelName(Base64::bestKernel())},
+        {"sqlite", sqlite3_libversion()},
+        {"openssl", OPENSSL_VERSION_TEXT},
+    };
+
+    if (result.count("output")) {
+        std::ofstream file(result["output"].as<std::string>());
+        bench.writeJson(file, context);
+    } else {
+        bench.writeJson(std::cout, context);
+    }
+    return bench.allChecksPassed() ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+// gitee-issue-mock: a local Gitee API stand-in for offline load tests.
+//   gitee-issue-mock --port 8080 --latency-ms 20 --throttle-rate 0.05 &
+//   gitee-issue --create --api-url http://127.0.0.1:8080/api/v5 --title "..." --token x
+
+#include "MockServer.h"
+#include "cxxopts.hpp"
+#include <csignal>
+#include <iostream>
+
+static MockServer* runningServer = nullptr;
+
+static void onStopSignal(int) {
+    if (runningServer) runningServer->stop();
+}
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("gitee-issue-mock", "Local mock of the Gitee issues API");
+    options.add_options()
+        ("host", "Address to listen on", cxxopts::value<std::string>()->default_value("127.0.0.1"))
+        ("port", "Port to listen on (0 = any free port)", cxxopts::value<int>()->default_value("8080"))
+        ("latency-ms", "Delay before every response", cxxopts::value<int>()->default_value("0"))
+        ("jitter-ms", "Extra random delay, up to this many milliseconds", cxxopts::value<int>()->default_value("0"))
+        ("error-rate", "Fraction of requests answered with HTTP 500", cxxopts::value<double>()->default_value("0"))
+        ("throttle-rate", "Fraction of requests answered with HTTP 429", cxxopts::value<double>()->default_value("0"))
+        ("rate-limit", "Requests per second per access token before HTTP 429 (0 = unlimited)", cxxopts::value<double>()->default_value("0"))
+        ("retry-after", "Retry-After seconds sent with random 429s (0 = omit the header)", cxxopts::value<int>()->default_value("1"))
+        ("seed-repo", "Repository (owner/repo) that --seed-issues are created in", cxxopts::value<std::string>()->default_value("owner/repo"))
+        ("seed-issues", "Issues to create before serving, for --sync tests", cxxopts::value<int>()->default_value("0"))
+        ("h,help", "Print help");
+
+    MockServer::Options serverOptions;
+    try {
+        auto result = options.parse(argc, argv);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        serverOptions.host = result["host"].as<std::string>();
+        serverOptions.port = result["port"].as<int>();
+        serverOptions.latencyMs = result["latency-ms"].as<int>();
+        serverOptions.jitterMs = result["jitter-ms"].as<int>();
+        serverOptions.errorRate = result["error-rate"].as<double>();
+        serverOptions.throttleRate = result["throttle-rate"].as<double>();
+        serverOptions.rateLimit = result["rate-limit"].as<double>();
+        serverOptions.retryAfterSeconds = result["retry-after"].as<int>();
+        serverOptions.seedRepo = result["seed-repo"].as<std::string>();
+        serverOptions.seedIssues = result["seed-issues"].as<int>();
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    }
+
+    MockServer server(serverOptions);
+    if (!server.start()) return 1;
+
+    runningServer = &server;
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::cout << "🚀 Mock Gitee API listening on " << server.getBaseUrl() << std::endl;
+
+    server.run();
+
+    MockServer::Stats stats = server.getStats();
+    std::cout << "👋 Served " << stats.requests << " request(s) on " << stats.connections << " connection(s): "
+              << stats.created << " created, " << stats.updated << " updated, " << stats.listed << " list page(s), " << stats.labels << " label(s), " << stats.throttled
+              << " throttled, " << stats.errors << " failed, " << stats.rejected << " rejected." << std::endl;
+    return 0;
+}
@@ -0,0 +1,6 @@
+# Imported by find_package(GiteeIssue); defines GiteeIssue::core
+include(CMakeFindDependencyMacro)
+find_dependency(CURL)
+find_dependency(OpenSSL)
+find_dependency(SQLite3)
+include("${CMAKE_CURRENT_LIST_DIR}/GiteeIssueTargets.cmake")
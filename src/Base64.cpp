@@ -0,0 +1,287 @@
+#include "Base64.h"
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char encodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// 0xFF marks bytes that are not part of the alphabet
+struct DecodeTable {
+    uint8_t values[256];
+    DecodeTable() {
+        std::memset(values, 0xFF, sizeof(values));
+        for (int i = 0; i < 64; ++i) values[(unsigned char)encodeTable[i]] = (uint8_t)i;
+    }
+};
+const DecodeTable decodeTable;
+
+// Encodes len bytes (any length) into exactly encodedLength(len) characters
+void encodeScalar(const unsigned char* in, size_t len, char* out) {
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+        *out++ = encodeTable[v >> 18];
+        *out++ = encodeTable[(v >> 12) & 63];
+        *out++ = encodeTable[(v >> 6) & 63];
+        *out++ = encodeTable[v & 63];
+    }
+    if (i + 1 == len) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        *out++ = encodeTable[v >> 18];
+        *out++ = encodeTable[(v >> 12) & 63];
+        *out++ = '=';
+        *out++ = '=';
+    } else if (i + 2 == len) {
+        uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8;
+        *out++ = encodeTable[v >> 18];
+        *out++ = encodeTable[(v >> 12) & 63];
+        *out++ = encodeTable[(v >> 6) & 63];
+        *out++ = '=';
+    }
+}
+
+// Decodes len unpadded characters (len % 4 != 1). Returns bytes written, or -1 on a bad character.
+long decodeScalar(const char* in, size_t len, unsigned char* out) {
+    unsigned char* start = out;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t a = decodeTable.values[(unsigned char)in[i]];
+        uint32_t b = decodeTable.values[(unsigned char)in[i + 1]];
+        uint32_t c = decodeTable.values[(unsigned char)in[i + 2]];
+        uint32_t d = decodeTable.values[(unsigned char)in[i + 3]];
+        if ((a | b | c | d) & 0x80) return -1;
+        uint32_t v = a << 18 | b << 12 | c << 6 | d;
+        *out++ = (unsigned char)(v >> 16);
+        *out++ = (unsigned char)(v >> 8);
+        *out++ = (unsigned char)v;
+    }
+    size_t rest = len - i;
+    if (rest >= 2) {
+        uint32_t a = decodeTable.values[(unsigned char)in[i]];
+        uint32_t b = decodeTable.values[(unsigned char)in[i + 1]];
+        uint32_t c = rest == 3 ? decodeTable.values[(unsigned char)in[i + 2]] : 0;
+        if ((a | b | c) & 0x80) return -1;
+        uint32_t v = a << 18 | b << 12 | c << 6;
+        *out++ = (unsigned char)(v >> 16);
+        if (rest == 3) *out++ = (unsigned char)(v >> 8);
+    }
+    return (long)(out - start);
+}
+
+#if defined(BASE64_X86)
+
+// Vector kernels after W. Muła and D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions" (2018). Each returns how much input it
+// consumed; the scalar code finishes the rest.
+
+__attribute__((target("ssse3"))) inline __m128i encodeLookup128(__m128i indices) {
+    __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(shift, result), indices);
+}
+
+__attribute__((target("ssse3"))) size_t encodeSSSE3(const unsigned char* in, size_t len, char* out) {
+    const __m128i spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    size_t i = 0;
+    // Loads 16 bytes but uses 12
+    for (; i + 16 <= len; i += 12) {
+        __m128i in128 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + i)), spread);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in128, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in128, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        _mm_storeu_si128((__m128i*)out, encodeLookup128(_mm_or_si128(t0, t1)));
+        out += 16;
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) size_t encodeAVX2(const unsigned char* in, size_t len, char* out) {
+    const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                           'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    // Each lane loads 16 bytes and uses 12: reads up to in + i + 28
+    for (; i + 28 <= len; i += 24) {
+        __m256i in256 = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in + i))),
+            _mm_loadu_si128((const __m128i*)(in + i + 12)), 1);
+        in256 = _mm256_shuffle_epi8(in256, spread);
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in256, _mm256_set1_epi32(0x0fc0fc00)),
+                                        _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in256, _mm256_set1_epi32(0x003f03f0)),
+                                        _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t0, t1);
+
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_add_epi8(_mm256_shuffle_epi8(shift, result), indices);
+        _mm256_storeu_si256((__m256i*)out, result);
+        out += 32;
+    }
+    return i;
+}
+
+// Decode kernels write 4 (SSSE3) or 8 (AVX2) bytes past each block; the caller leaves room.
+// They stop at the first block with an invalid character and let the scalar code report it.
+
+__attribute__((target("ssse3"))) size_t decodeSSSE3(const char* in, size_t len, unsigned char* out) {
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i str = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+        __m128i lo = _mm_shuffle_epi8(lutLo, _mm_and_si128(str, mask2F));
+        __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF) break;
+
+        __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(str, mask2F), hiNibbles));
+        __m128i values = _mm_add_epi8(str, roll);
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(packed, pack));
+        out += 12;
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) size_t decodeAVX2(const char* in, size_t len, unsigned char* out) {
+    const __m256i lutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                           0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                           0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                           0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                           0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                             0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask2F = _mm256_set1_epi8(0x2f);
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i str = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+        __m256i lo = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(str, mask2F));
+        __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        if (!_mm256_testz_si256(lo, hi)) break;
+
+        __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask2F), hiNibbles));
+        __m256i values = _mm256_add_epi8(str, roll);
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(packed, pack), join);
+        _mm256_storeu_si256((__m256i*)out, packed);
+        out += 24;
+    }
+    return i;
+}
+
+#endif // BASE64_X86
+
+Base64::Kernel detectKernel() {
+#if defined(BASE64_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Base64::Kernel::AVX2;
+    if (__builtin_cpu_supports("ssse3")) return Base64::Kernel::SSSE3;
+#endif
+    return Base64::Kernel::Scalar;
+}
+
+} // namespace
+
+Base64::Kernel Base64::bestKernel() {
+    static const Kernel best = detectKernel();
+    return best;
+}
+
+const char* Base64::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::AVX2: return "avx2";
+        case Kernel::SSSE3: return "ssse3";
+        default: return "scalar";
+    }
+}
+
+size_t Base64::encodedLength(size_t len) {
+    return 4 * ((len + 2) / 3);
+}
+
+size_t Base64::decodedLength(size_t len) {
+    return 3 * (len / 4) + 2;
+}
+
+void Base64::encode(const void* data, size_t len, std::string& out, Kernel kernel) {
+    const unsigned char* in = static_cast<const unsigned char*>(data);
+    size_t start = out.size();
+    out.resize(start + encodedLength(len));
+    char* dest = &out[start];
+
+    size_t done = 0;
+#if defined(BASE64_X86)
+    if (kernel == Kernel::AVX2) done = encodeAVX2(in, len, dest);
+    else if (kernel == Kernel::SSSE3) done = encodeSSSE3(in, len, dest);
+#else
+    (void)kernel;
+#endif
+    encodeScalar(in + done, len - done, dest + done / 3 * 4);
+}
+
+std::string Base64::encode(std::string_view data) {
+    std::string out;
+    encode(data.data(), data.size(), out);
+    return out;
+}
+
+bool Base64::decode(const char* text, size_t len, std::string& out, Kernel kernel) {
+    // Padding only ever completes the last quantum
+    if (len % 4 == 0 && len > 0 && text[len - 1] == '=') {
+        --len;
+        if (text[len - 1] == '=') --len;
+    }
+    if (len % 4 == 1) return false;
+
+    size_t start = out.size();
+    out.resize(start + decodedLength(len) + 8); // Room for the vector kernels' overhanging stores
+    unsigned char* dest = (unsigned char*)&out[start];
+
+    size_t done = 0;
+#if defined(BASE64_X86)
+    if (kernel == Kernel::AVX2) done = decodeAVX2(text, len, dest);
+    if (kernel != Kernel::Scalar) done += decodeSSSE3(text + done, len - done, dest + done / 4 * 3);
+#else
+    (void)kernel;
+#endif
+    long written = decodeScalar(text + done, len - done, dest + done / 4 * 3);
+    if (written < 0) {
+        out.resize(start);
+        return false;
+    }
+    out.resize(start + done / 4 * 3 + (size_t)written);
+    return true;
+}
+
+bool Base64::decode(std::string_view text, std::string& out) {
+    return decode(text.data(), text.size(), out);
+}
@@ -0,0 +1,33 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Standard base64 (RFC 4648, '+' and '/', '=' padding, no line breaks).
+// Long inputs go through SSSE3 or AVX2 kernels when the CPU has them; the
+// choice is made once at startup and all kernels produce identical output.
+class Base64 {
+public:
+    enum class Kernel { Scalar, SSSE3, AVX2 };
+
+    // Fastest kernel supported by this CPU
+    static Kernel bestKernel();
+    static const char* kernelName(Kernel kernel);
+
+    static size_t encodedLength(size_t len);
+    // Upper bound; the exact size depends on padding
+    static size_t decodedLength(size_t len);
+
+    // Appends the encoding of data to out
+    static void encode(const void* data, size_t len, std::string& out, Kernel kernel = bestKernel());
+    static std::string encode(std::string_view data);
+
+    // Appends the decoded bytes to out. Padding is optional. Returns false and
+    // leaves out unchanged if text contains anything but base64 characters.
+    static bool decode(const char* text, size_t len, std::string& out, Kernel kernel = bestKernel());
+    static bool decode(std::string_view text, std::string& out);
+};
+
+#endif // BASE64_H
@@ -0,0 +1,511 @@
+#include "BatchCreator.h"
+#include "CsvReader.h"
+#include "HttpPipeline.h"
+#include "HttpSession.h"
+#include "IssueCreator.h"
+#include "IssueDedup.h"
+#include "IssueTemplate.h"
+#include "JsonTokenizer.h"
+#include "JsonWriter.h"
+#include "LabelResolver.h"
+#include <algorithm>
+#include <memory>
+
+BatchCreator::BatchCreator(const std::string& owner, const std::string& repo, const std::string& token,
+                           int concurrency, std::shared_ptr<HttpSession> session,
+                           std::shared_ptr<RequestScheduler> scheduler)
+    : owner(owner), repo(repo), token(token), concurrency(concurrency),
+      session(session ? std::move(session) : std::make_shared<HttpSession>()),
+      scheduler(scheduler ? std::move(scheduler) : std::make_shared<RequestScheduler>()), format(Format::Jsonl) {}
+
+const std::shared_ptr<HttpSession>& BatchCreator::getSession() const {
+    return session;
+}
+
+const std::shared_ptr<RequestScheduler>& BatchCreator::getScheduler() const {
+    return scheduler;
+}
+
+void BatchCreator::setDedup(std::shared_ptr<IssueDedup> dedup) {
+    this->dedup = std::move(dedup);
+}
+
+void BatchCreator::setLabelResolver(std::shared_ptr<LabelResolver> labels) {
+    this->labels = std::move(labels);
+}
+
+void BatchCreator::setFormat(Format format) {
+    this->format = format;
+}
+
+void BatchCreator::setTemplates(std::shared_ptr<const IssueTemplate> title, std::shared_ptr<const IssueTemplate> body) {
+    titleTemplate = std::move(title);
+    bodyTemplate = std::move(body);
+}
+
+namespace {
+
+// Collects the top-level string fields of one JSONL record
+class RecordHandler : public JsonHandler {
+public:
+    JsonTokenizer* tokenizer = nullptr;
+    IssueRecord* record = nullptr;
+    std::string* target = nullptr;
+
+    bool onKey(const std::string& key) override {
+        target = nullptr;
+        if (tokenizer->depth() != 1) return false;
+        if (key == "title") target = &record->title;
+        else if (key == "body") target = &record->body;
+        else if (key == "labels") target = &record->labels;
+        else if (key == "owner") target = &record->owner;
+        else if (key == "repo") target = &record->repo;
+        else if (key == "token") target = &record->token;
+        return target != nullptr;
+    }
+
+    void onString(const std::string& value) override {
+        if (target) *target = value;
+        target = nullptr;
+    }
+};
+
+} // namespace
+
+bool BatchCreator::parseRecord(const std::string& line, IssueRecord& out, std::string& error) {
+    RecordHandler handler;
+    JsonTokenizer tokenizer(handler);
+    handler.tokenizer = &tokenizer;
+    handler.record = &out;
+
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] != '{') {
+        error = "record is not a JSON object";
+        return false;
+    }
+    if (!tokenizer.feed(line.data(), line.size()) || !tokenizer.finish()) {
+        error = tokenizer.hasError() ? "invalid JSON: " + tokenizer.getError() : "unterminated JSON object";
+        return false;
+    }
+    if (out.title.empty()) {
+        error = "missing required field \"title\"";
+        return false;
+    }
+    return true;
+}
+
+
+namespace {
+
+// Record fields are kept in numbered slots: the issue fields first, then any
+// other field that a template uses
+enum Slot { TitleSlot, BodySlot, LabelsSlot, OwnerSlot, RepoSlot, TokenSlot, IssueSlots };
+const char* const SlotNames[IssueSlots] = {"title", "body", "labels", "owner", "repo", "token"};
+
+class SlotTable {
+public:
+    SlotTable() : names(SlotNames, SlotNames + IssueSlots) {}
+
+    // A handful of names, so a scan beats hashing
+    int find(const std::string& name) const {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) return (int)i;
+        }
+        return -1;
+    }
+
+    int add(const std::string& name) {
+        int slot = find(name);
+        if (slot >= 0) return slot;
+        names.push_back(name);
+        return (int)names.size() - 1;
+    }
+
+    size_t size() const { return names.size(); }
+    const std::string& name(int slot) const { return names[slot]; }
+
+private:
+    std::vector<std::string> names;
+};
+
+// One input record. The strings are reused from record to record.
+struct SlotRecord {
+    size_t line = 0;
+    std::vector<std::string> values;
+    std::vector<bool> present;
+
+    void reset(size_t slots) {
+        values.resize(slots);
+        for (std::string& value : values) value.clear();
+        present.assign(slots, false);
+    }
+};
+
+class RecordSource {
+public:
+    virtual ~RecordSource() = default;
+
+    // Returns false at the end of the input. A bad record comes back with error set.
+    virtual bool next(SlotRecord& record, std::string& error) = 0;
+};
+
+// One JSON object per line. Fields without a slot are skipped without being copied.
+class JsonlSource : public RecordSource, private JsonHandler {
+public:
+    JsonlSource(std::istream& input, const SlotTable& slots)
+        : input(input), slots(slots), tokenizer(*this), lineNo(0), record(nullptr), target(-1) {}
+
+    bool next(SlotRecord& out, std::string& error) override {
+        while (std::getline(input, line)) {
+            ++lineNo;
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos) continue;
+
+            out.reset(slots.size());
+            out.line = lineNo;
+            if (line[first] != '{') {
+                error = "record is not a JSON object";
+                return true;
+            }
+            record = &out;
+            target = -1;
+            tokenizer.reset();
+            if (!tokenizer.feed(line.data(), line.size()) || !tokenizer.finish()) {
+                error = tokenizer.hasError() ? "invalid JSON: " + tokenizer.getError() : "unterminated JSON object";
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::istream& input;
+    const SlotTable& slots;
+    JsonTokenizer tokenizer;
+    std::string line;
+    size_t lineNo;
+    SlotRecord* record;
+    int target;
+
+    bool onKey(const std::string& key) override {
+        target = tokenizer.depth() == 1 ? slots.find(key) : -1;
+        return target >= 0;
+    }
+
+    // Numbers and booleans fill a template as they were written; null leaves the field unset
+    void onString(const std::string& value) override { store(value); }
+    void onNumber(const std::string& text) override { store(text); }
+    void onLiteral(const std::string& text) override {
+        if (text != "null") store(text);
+        target = -1;
+    }
+
+    void store(const std::string& value) {
+        if (target < 0) return;
+        record->values[target] = value;
+        record->present[target] = true;
+        target = -1;
+    }
+};
+
+// A header row, then one record per row. Columns without a slot are ignored.
+class CsvSource : public RecordSource {
+public:
+    CsvSource(std::istream& input, const SlotTable& slots) : reader(input), slots(slots) {}
+
+    bool readHeader(std::string& error) {
+        if (!reader.next(fields, error)) {
+            error = "empty CSV input";
+            return false;
+        }
+        if (!error.empty()) return false;
+        // Spreadsheets like to start the file with a UTF-8 byte order mark
+        if (fields[0].compare(0, 3, "\xEF\xBB\xBF") == 0) fields[0].erase(0, 3);
+        for (const std::string& name : fields) columnSlots.push_back(slots.find(name));
+        return true;
+    }
+
+    bool hasColumn(int slot) const {
+        return std::find(columnSlots.begin(), columnSlots.end(), slot) != columnSlots.end();
+    }
+
+    bool next(SlotRecord& out, std::string& error) override {
+        if (!reader.next(fields, error)) return false;
+        out.reset(slots.size());
+        out.line = reader.line();
+        if (!error.empty()) return true;
+        if (fields.size() != columnSlots.size()) {
+            error = "expected " + std::to_string(columnSlots.size()) + " fields, found " +
+                    std::to_string(fields.size());
+            return true;
+        }
+        for (size_t i = 0; i < fields.size(); ++i) {
+            int slot = columnSlots[i];
+            if (slot < 0) continue;
+            out.values[slot].swap(fields[i]);
+            out.present[slot] = true;
+        }
+        return true;
+    }
+
+private:
+    CsvReader reader;
+    const SlotTable& slots;
+    std::vector<std::string> fields;
+    std::vector<int> columnSlots;
+};
+
+} // namespace
+
+size_t BatchCreator::run(std::istream& input, const ResultCallback& onResult) {
+    size_t failures = 0;
+    auto fail = [&failures, &onResult](size_t line, const std::string& error) {
+        BatchResult result;
+        result.line = line;
+        result.error = error;
+        ++failures;
+        onResult(result);
+    };
+
+    // Template variables are resolved to slots once, not per record
+    SlotTable slots;
+    std::vector<int> titleSlots;
+    std::vector<int> bodySlots;
+    if (titleTemplate) {
+        for (const std::string& name : titleTemplate->variables()) titleSlots.push_back(slots.add(name));
+    }
+    if (bodyTemplate) {
+        for (const std::string& name : bodyTemplate->variables()) bodySlots.push_back(slots.add(name));
+    }
+    std::vector<int> usedSlots(titleSlots);
+    usedSlots.insert(usedSlots.end(), bodySlots.begin(), bodySlots.end());
+
+    std::unique_ptr<RecordSource> source;
+    if (format == Format::Csv) {
+        std::unique_ptr<CsvSource> csv(new CsvSource(input, slots));
+        std::string error;
+        if (!csv->readHeader(error)) {
+            fail(1, error);
+            return failures;
+        }
+        // A missing column would fail every row, so stop before sending anything
+        if (!titleTemplate && !csv->hasColumn(TitleSlot)) {
+            fail(1, "missing required column \"title\"");
+            return failures;
+        }
+        for (int slot : usedSlots) {
+            if (!csv->hasColumn(slot)) {
+                fail(1, "no column \"" + slots.name(slot) + "\" for the template");
+                return failures;
+            }
+        }
+        source = std::move(csv);
+    } else {
+        source.reset(new JsonlSource(input, slots));
+    }
+
+    HttpPipeline pipeline(concurrency, session, scheduler);
+    inFlight.clear();
+    JsonWriter writer;
+    SlotRecord fields;
+    IssueTemplate::Values titleValues(titleSlots.size());
+    IssueTemplate::Values bodyValues(bodySlots.size());
+    BodyParts bodyParts;
+    std::string error;
+
+    // Keep a small backlog queued so a slot never waits on input parsing
+    const size_t maxQueued = (size_t)concurrency * 2;
+
+    while (source->next(fields, error)) {
+        size_t lineNo = fields.line;
+        for (int slot : usedSlots) {
+            if (error.empty() && !fields.present[slot]) {
+                error = "missing field \"" + slots.name(slot) + "\" used by the template";
+            }
+        }
+        if (error.empty() && !titleTemplate && fields.values[TitleSlot].empty()) {
+            error = "missing required field \"title\"";
+        }
+        if (!error.empty()) {
+            fail(lineNo, error);
+            error.clear();
+            continue;
+        }
+
+        IssueRecord record;
+        record.line = lineNo;
+        record.owner = fields.values[OwnerSlot].empty() ? owner : fields.values[OwnerSlot];
+        record.repo = fields.values[RepoSlot].empty() ? repo : fields.values[RepoSlot];
+        record.token = fields.values[TokenSlot].empty() ? token : fields.values[TokenSlot];
+        record.labels = fields.values[LabelsSlot];
+        if (labels && !labels->resolve(record.owner, record.repo, record.token, record.labels, error)) {
+            fail(lineNo, error);
+            error.clear();
+            continue;
+        }
+
+        for (size_t i = 0; i < titleSlots.size(); ++i) titleValues[i] = fields.values[titleSlots[i]];
+        for (size_t i = 0; i < bodySlots.size(); ++i) bodyValues[i] = fields.values[bodySlots[i]];
+        if (titleTemplate) {
+            titleTemplate->render(record.title, titleValues);
+        } else {
+            record.title = fields.values[TitleSlot];
+        }
+        if (bodyTemplate) {
+            bodyTemplate->parts(bodyValues, bodyParts);
+        } else {
+            bodyParts.assign(1, fields.values[BodySlot]);
+        }
+
+        uint64_t hash = 0;
+        bool reserved = false;
+        if (checkDuplicate(record, bodyParts, onResult, hash, reserved)) continue;
+
+        // Each in-flight request owns its payload, so build it in place and move it out.
+        // A templated body is rendered straight into the payload, escaped on the way.
+        if (bodyTemplate) {
+            IssueCreator::buildRequestBody(writer, record.token, record.repo, record.title, *bodyTemplate, bodyValues,
+                                           record.labels);
+        } else {
+            IssueCreator::buildRequestBody(writer, record.token, record.repo, record.title, fields.values[BodySlot],
+                                           record.labels);
+        }
+
+        // Only kept around when the created issue has to be remembered
+        if (dedup) {
+            if (bodyTemplate) {
+                bodyTemplate->render(record.body, bodyValues);
+            } else {
+                record.body.swap(fields.values[BodySlot]);
+            }
+        }
+        submit(pipeline, std::move(record), writer.take(), failures, onResult, reserved, hash);
+
+        while (pipeline.pending() >= maxQueued) {
+            pipeline.runOnce();
+        }
+    }
+
+    pipeline.run();
+    return failures;
+}
+
+size_t BatchCreator::run(const std::vector<IssueRecord>& records, const ResultCallback& onResult) {
+    HttpPipeline pipeline(concurrency, session, scheduler);
+    inFlight.clear();
+    size_t failures = 0;
+    JsonWriter writer;
+
+    std::string error;
+
+    for (IssueRecord record : records) {
+        if (labels && !labels->resolve(record.owner, record.repo, record.token, record.labels, error)) {
+            BatchResult result;
+            result.line = record.line;
+            result.error = error;
+            error.clear();
+            ++failures;
+            onResult(result);
+            continue;
+        }
+        uint64_t hash = 0;
+        bool reserved = false;
+        if (checkDuplicate(record, BodyParts{record.body}, onResult, hash, reserved)) continue;
+        IssueCreator::buildRequestBody(writer, record.token, record.repo, record.title, record.body, record.labels);
+        submit(pipeline, std::move(record), writer.take(), failures, onResult, reserved, hash);
+    }
+
+    // Every request is queued up front; the pipeline and scheduler pace them
+    pipeline.run();
+    return failures;
+}
+
+bool BatchCreator::checkDuplicate(IssueRecord& record, const BodyParts& body, const ResultCallback& onResult,
+                                  uint64_t& hash, bool& reserved) {
+    if (!dedup || dedup->getTtlSeconds() <= 0) return false;
+
+    hash = IssueDedup::contentHash(record.owner, record.repo, record.title, body);
+    BatchResult known;
+    if (dedup->find(hash, known)) {
+        known.line = record.line;
+        onResult(known);
+        return true;
+    }
+
+    auto pending = inFlight.find(hash);
+    if (pending != inFlight.end()) {
+        // Kept whole in case it has to be sent after all
+        record.body.clear();
+        for (std::string_view part : body) record.body.append(part);
+        pending->second.push_back(std::move(record));
+        return true;
+    }
+    inFlight.emplace(hash, std::vector<IssueRecord>());
+    reserved = true;
+    return false;
+}
+
+void BatchCreator::settle(HttpPipeline& pipeline, uint64_t hash, const IssueResult& created, size_t& failures,
+                          const ResultCallback& onResult) {
+    auto it = inFlight.find(hash);
+    if (it == inFlight.end()) return;
+    if (created.success || it->second.empty()) {
+        std::vector<IssueRecord> waiting = std::move(it->second);
+        inFlight.erase(it);
+        for (const IssueRecord& record : waiting) {
+            BatchResult result;
+            static_cast<IssueResult&>(result) = created;
+            result.line = record.line;
+            result.retries = 0;
+            result.duplicate = true;
+            onResult(result);
+        }
+        return;
+    }
+
+    // The first one failed: the next identical record is sent instead, the rest wait on it
+    IssueRecord next = std::move(it->second.front());
+    it->second.erase(it->second.begin());
+    JsonWriter writer;
+    IssueCreator::buildRequestBody(writer, next.token, next.repo, next.title, next.body, next.labels);
+    submit(pipeline, std::move(next), writer.take(), failures, onResult, true, hash);
+}
+
+void BatchCreator::submit(HttpPipeline& pipeline, IssueRecord record, std::string payload, size_t& failures,
+                          const ResultCallback& onResult, bool reserved, uint64_t hash) {
+    HttpRequest request;
+    request.url = IssueCreator::issuesUrl(record.owner);
+    request.body = std::move(payload);
+    request.headers.push_back("Content-Type: application/json;charset=UTF-8");
+
+    // The response is parsed as it arrives; only the fields we need are kept
+    auto parser = std::make_shared<IssueResponseParser>();
+    request.onData = [parser](const char* data, size_t len) { parser->feed(data, len); };
+    request.onRetry = [parser]() { parser->reset(); };
+    request.rateKey = record.token;
+
+    size_t lineNo = record.line;
+    // Only kept around when the created issue has to be remembered
+    IssueRecord created;
+    if (dedup) created = std::move(record);
+
+    pipeline.submit(std::move(request), [this, &pipeline, lineNo, parser, created = std::move(created), &failures,
+                                         &onResult, reserved, hash](const HttpResponse& response) {
+        BatchResult result;
+        result.line = lineNo;
+        result.status = response.status;
+        result.retries = response.retries;
+        if (!response.error.empty()) {
+            result.error = "Curl error: " + response.error;
+        } else if (response.status != 201) {
+            result.error = "HTTP " + std::to_string(response.status) + ": " + parser->getSnippet();
+        } else {
+            result.success = true;
+            parser->fill(result);
+            if (dedup) dedup->remember(created.owner, created.repo, created.title, created.body, created.labels, result);
+        }
+        if (!result.success) ++failures;
+        onResult(result);
+        if (reserved) settle(pipeline, hash, result, failures, onResult);
+    });
+}
@@ -0,0 +1,112 @@
+#ifndef BATCHCREATOR_H
+#define BATCHCREATOR_H
+
+#include "BodyFile.h"
+#include "IssueResponseParser.h"
+#include "RequestScheduler.h"
+#include <functional>
+#include <istream>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One issue to create, read from a JSONL line such as
+// {"title": "...", "body": "...", "labels": "a,b", "owner": "...", "repo": "...", "token": "..."}
+struct IssueRecord {
+    size_t line = 0;
+    std::string owner;
+    std::string repo;
+    std::string title;
+    std::string body;
+    std::string labels;
+    std::string token;
+};
+
+struct BatchResult : IssueResult {
+    size_t line = 0;
+};
+
+class HttpPipeline;
+class HttpSession;
+class IssueDedup;
+class IssueTemplate;
+class LabelResolver;
+
+// Creates many issues concurrently through HttpPipeline.
+// Records are read lazily, so the input can be larger than memory.
+class BatchCreator {
+public:
+    using ResultCallback = std::function<void(const BatchResult&)>;
+
+    // JSONL: one object per line, as parseRecord reads it.
+    // CSV: a header row naming the fields, then one issue per row.
+    enum class Format { Jsonl, Csv };
+
+    BatchCreator(const std::string& owner, const std::string& repo, const std::string& token,
+                 int concurrency = 8, std::shared_ptr<HttpSession> session = nullptr,
+                 std::shared_ptr<RequestScheduler> scheduler = nullptr);
+
+    // Sends every record in input and reports each result as it finishes.
+    // Returns the number of records that failed.
+    size_t run(std::istream& input, const ResultCallback& onResult);
+
+    // Same for records already in memory, e.g. one issue for many repos. Results
+    // carry each record's line field, so the caller can tell them apart.
+    size_t run(const std::vector<IssueRecord>& records, const ResultCallback& onResult);
+
+    void setFormat(Format format);
+
+    // Renders each issue's title and body from a template instead of taking the
+    // "title" and "body" fields as they are. Every field of the record, known
+    // or not, can fill a {{name}}. Either may be null to keep the plain field.
+    void setTemplates(std::shared_ptr<const IssueTemplate> title, std::shared_ptr<const IssueTemplate> body);
+
+    // Parses one JSONL line. Owner, repo and token fall back to the batch defaults.
+    static bool parseRecord(const std::string& line, IssueRecord& out, std::string& error);
+
+    const std::shared_ptr<HttpSession>& getSession() const;
+    const std::shared_ptr<RequestScheduler>& getScheduler() const;
+
+    // Records already created within the dedup TTL are reported without being sent,
+    // and every issue created is remembered. A record identical to one still in
+    // flight is not sent either: it is reported as a duplicate once the first is
+    // created, or sent in its place if that fails. Off unless set.
+    void setDedup(std::shared_ptr<IssueDedup> dedup);
+
+    // Checks and rewrites each record's labels before it is sent; a record with
+    // an unknown label fails without a request. A repo's labels are loaded when
+    // the first record for it is read. Off unless set.
+    void setLabelResolver(std::shared_ptr<LabelResolver> labels);
+
+private:
+    std::string owner;
+    std::string repo;
+    std::string token;
+    int concurrency;
+    std::shared_ptr<HttpSession> session;
+    std::shared_ptr<RequestScheduler> scheduler;
+    std::shared_ptr<IssueDedup> dedup;
+    std::shared_ptr<LabelResolver> labels;
+    Format format;
+    std::shared_ptr<const IssueTemplate> titleTemplate;
+    std::shared_ptr<const IssueTemplate> bodyTemplate;
+    // Content hash of each issue being created -> identical records waiting for it
+    std::unordered_map<uint64_t, std::vector<IssueRecord>> inFlight;
+
+    // Returns true if record was answered from the dedup index or now waits for
+    // an identical record in flight (then its body is kept). Otherwise reserves
+    // its hash when dedup is on; reserved tells submit to settle the waiters.
+    bool checkDuplicate(IssueRecord& record, const BodyParts& body, const ResultCallback& onResult,
+                        uint64_t& hash, bool& reserved);
+
+    // Queues one payload; the result is reported once the request is done
+    void submit(HttpPipeline& pipeline, IssueRecord record, std::string payload, size_t& failures,
+                const ResultCallback& onResult, bool reserved = false, uint64_t hash = 0);
+    // Reports the records that waited on hash, or sends the next one if the first failed
+    void settle(HttpPipeline& pipeline, uint64_t hash, const IssueResult& created, size_t& failures,
+                const ResultCallback& onResult);
+};
+
+#endif // BATCHCREATOR_H
@@ -0,0 +1,167 @@
+#include "BodyFile.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// How far a cut may move to land on a line break
+const size_t kLineSearch = 4096;
+
+bool isContinuation(char c) {
+    return ((unsigned char)c & 0xC0) == 0x80;
+}
+
+// End of the head: at most max bytes, preferably just after a line break
+size_t headEnd(std::string_view text, size_t max) {
+    if (max == 0) return 0;
+    size_t newline = text.rfind('\n', max - 1);
+    if (newline != std::string_view::npos && max - (newline + 1) < kLineSearch) return newline + 1;
+    size_t end = max;
+    while (end > 0 && isContinuation(text[end])) --end;
+    return end;
+}
+
+// Start of the tail: at least min, preferably just after a line break
+size_t tailStart(std::string_view text, size_t min) {
+    if (min == 0 || text[min - 1] == '\n') return min;
+    size_t newline = text.find('\n', min);
+    if (newline != std::string_view::npos && newline - min < kLineSearch) return newline + 1;
+    while (min < text.size() && isContinuation(text[min])) ++min;
+    return min;
+}
+
+bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+} // namespace
+
+size_t bodySize(const BodyParts& parts) {
+    size_t size = 0;
+    for (std::string_view part : parts) size += part.size();
+    return size;
+}
+
+BodyFile::BodyFile() : map(nullptr), mapSize(0), omittedBytes(0) {}
+
+BodyFile::~BodyFile() {
+    if (map) munmap(map, mapSize);
+}
+
+bool BodyFile::open(const std::string& path) {
+    int fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "❌ Failed to open body file " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    bool ok;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        ok = mapFd(fd, path);
+    } else {
+        // Spool the stream to disk so it can be mapped (and resent) like a file
+        const char* tmpDir = std::getenv("TMPDIR");
+        std::string tmpPath = std::string(tmpDir && *tmpDir ? tmpDir : "/tmp") + "/gitee-issue-body-XXXXXX";
+        int spool = mkstemp(&tmpPath[0]);
+        if (spool < 0) {
+            std::cerr << "❌ Failed to create a temporary file for " << path << ": " << std::strerror(errno)
+                      << std::endl;
+            if (fd != STDIN_FILENO) ::close(fd);
+            return false;
+        }
+        ::unlink(tmpPath.c_str());
+
+        char buffer[65536];
+        ok = true;
+        for (;;) {
+            ssize_t n = ::read(fd, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0) break;
+            if (n < 0 || !writeAll(spool, buffer, (size_t)n)) {
+                std::cerr << "❌ Failed to read body from " << path << ": " << std::strerror(errno) << std::endl;
+                ok = false;
+                break;
+            }
+        }
+        if (ok) ok = mapFd(spool, path);
+        ::close(spool);
+    }
+
+    if (fd != STDIN_FILENO) ::close(fd);
+    return ok;
+}
+
+bool BodyFile::mapFd(int fd, const std::string& path) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "❌ Failed to read body file " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    bodyParts.clear();
+    if (st.st_size == 0) return true; // mmap rejects empty ranges
+
+    void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "❌ Failed to map body file " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // Read front to back, once per attempt
+    madvise(mapped, (size_t)st.st_size, MADV_SEQUENTIAL);
+    map = mapped;
+    mapSize = (size_t)st.st_size;
+    bodyParts.emplace_back((const char*)map, mapSize);
+    return true;
+}
+
+void BodyFile::truncate(size_t maxBytes) {
+    if (maxBytes == 0 || mapSize <= maxBytes) return;
+
+    std::string_view text((const char*)map, mapSize);
+    size_t head = headEnd(text, maxBytes / 3);
+    size_t tail = tailStart(text, mapSize - (maxBytes - maxBytes / 3));
+    if (tail < head) tail = head;
+    omittedBytes = tail - head;
+
+    marker = "\n[... " + std::to_string(omittedBytes) + " bytes omitted ...]\n\n";
+    bodyParts.clear();
+    bodyParts.push_back(text.substr(0, head));
+    bodyParts.push_back(marker);
+    bodyParts.push_back(text.substr(tail));
+}
+
+const BodyParts& BodyFile::parts() const {
+    return bodyParts;
+}
+
+size_t BodyFile::size() const {
+    return bodySize(bodyParts);
+}
+
+size_t BodyFile::fileSize() const {
+    return mapSize;
+}
+
+size_t BodyFile::omitted() const {
+    return omittedBytes;
+}
+
+std::string BodyFile::str() const {
+    std::string text;
+    text.reserve(size());
+    for (std::string_view part : bodyParts) text.append(part.data(), part.size());
+    return text;
+}
@@ -0,0 +1,57 @@
+#ifndef BODYFILE_H
+#define BODYFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// An issue body as consecutive byte ranges, e.g. the head of a log, an
+// "omitted" marker and its tail. The ranges are not owned.
+using BodyParts = std::vector<std::string_view>;
+
+// Issue body read from --body-file without loading it into memory. Regular
+// files are memory-mapped. Pipes and terminals are copied through a fixed
+// buffer into an unlinked temporary file, which is then mapped, so the body can
+// be sent again if the request is retried. Either way the process holds no copy
+// of the body, however large it is.
+class BodyFile {
+public:
+    BodyFile();
+    ~BodyFile();
+
+    BodyFile(const BodyFile&) = delete;
+    BodyFile& operator=(const BodyFile&) = delete;
+
+    // path "-" reads standard input. Returns false (with a message on stderr) on failure.
+    bool open(const std::string& path);
+
+    // Keeps about maxBytes of the body: the first third and the last two thirds,
+    // with a line saying how much was left out in between. Cuts are moved to the
+    // nearest line break when one is close, and never split a UTF-8 character.
+    void truncate(size_t maxBytes);
+
+    const BodyParts& parts() const;
+
+    // Bytes in parts(), and bytes in the whole file
+    size_t size() const;
+    size_t fileSize() const;
+    size_t omitted() const;
+
+    // Copies the body into one string
+    std::string str() const;
+
+private:
+    void* map;
+    size_t mapSize;
+    size_t omittedBytes;
+    std::string marker;
+    BodyParts bodyParts;
+
+    bool mapFd(int fd, const std::string& path);
+};
+
+// Total bytes in parts
+size_t bodySize(const BodyParts& parts);
+
+#endif // BODYFILE_H
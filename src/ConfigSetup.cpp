@@ -1,12 +1,205 @@
 #include "ConfigSetup.h"
+#include "JsonWriter.h"
+#include "RepoIndex.h"
 #include "Hasher.h"
 #include <sqlite3.h>
 #include <iostream>
 #include <sys/stat.h>
 #include <filesystem>
 #include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
-ConfigSetup::ConfigSetup(const std::string& dbPath) : dbPath(dbPath), db(nullptr) {}
+namespace {
+
+// Schema changes, applied in order. PRAGMA user_version records the last one applied,
+// so opening an up-to-date database does not run any DDL.
+struct Migration {
+    int version;
+    const char* sql;
+};
+
+const Migration migrations[] = {
+    {1, R"(
+        CREATE TABLE IF NOT EXISTS tokens (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            repo TEXT NOT NULL,
+            owner TEXT NOT NULL,
+            encrypted_token TEXT NOT NULL,
+            isDefault INTEGER DEFAULT 0
+        );
+        CREATE TABLE IF NOT EXISTS outbox (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            owner TEXT NOT NULL,
+            repo TEXT NOT NULL,
+            title TEXT NOT NULL,
+            body TEXT NOT NULL DEFAULT '',
+            labels TEXT NOT NULL DEFAULT '',
+            encrypted_token TEXT NOT NULL DEFAULT '',
+            status TEXT NOT NULL DEFAULT 'pending',
+            attempts INTEGER NOT NULL DEFAULT 0,
+            issue_id INTEGER,
+            issue_number TEXT,
+            html_url TEXT,
+            error TEXT,
+            created_at INTEGER NOT NULL,
+            updated_at INTEGER NOT NULL
+        );
+        CREATE INDEX IF NOT EXISTS idx_outbox_status ON outbox(status, id);
+    )"},
+    // One row per (owner, repo): keep the default row, otherwise the newest, then index
+    {2, R"(
+        DELETE FROM tokens WHERE id NOT IN (
+            SELECT id FROM tokens AS t WHERE t.id = (
+                SELECT id FROM tokens AS d WHERE d.owner = t.owner AND d.repo = t.repo
+                ORDER BY d.isDefault DESC, d.id DESC LIMIT 1));
+        CREATE UNIQUE INDEX IF NOT EXISTS idx_tokens_owner_repo ON tokens(owner, repo);
+        CREATE INDEX IF NOT EXISTS idx_tokens_default ON tokens(isDefault) WHERE isDefault = 1;
+    )"},
+    // Created issues by content hash, for --dedup-ttl
+    {3, R"(
+        CREATE TABLE IF NOT EXISTS issue_hashes (
+            hash INTEGER PRIMARY KEY,
+            owner TEXT NOT NULL,
+            repo TEXT NOT NULL,
+            issue_id INTEGER NOT NULL,
+            issue_number TEXT NOT NULL DEFAULT '',
+            html_url TEXT NOT NULL DEFAULT '',
+            created_at INTEGER NOT NULL
+        );
+        CREATE INDEX IF NOT EXISTS idx_issue_hashes_created ON issue_hashes(created_at);
+    )"},
+    // Local copy of each repo's issues, for --sync
+    {4, R"(
+        CREATE TABLE IF NOT EXISTS issues (
+            id INTEGER PRIMARY KEY,
+            owner TEXT NOT NULL,
+            repo TEXT NOT NULL,
+            number TEXT NOT NULL,
+            title TEXT NOT NULL,
+            body TEXT NOT NULL DEFAULT '',
+            state TEXT NOT NULL DEFAULT '',
+            labels TEXT NOT NULL DEFAULT '',
+            author TEXT NOT NULL DEFAULT '',
+            html_url TEXT NOT NULL DEFAULT '',
+            created_at TEXT NOT NULL DEFAULT '',
+            updated_at TEXT NOT NULL DEFAULT ''
+        );
+        CREATE INDEX IF NOT EXISTS idx_issues_repo ON issues(owner, repo, updated_at);
+        CREATE TABLE IF NOT EXISTS sync_state (
+            owner TEXT NOT NULL,
+            repo TEXT NOT NULL,
+            cursor TEXT NOT NULL,
+            synced_at INTEGER NOT NULL,
+            PRIMARY KEY (owner, repo)
+        );
+    )"},
+    // Full-text index over cached issues. It stores no text of its own and is kept
+    // in step with the issues table by triggers, so every write path updates it.
+    {5, R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS issues_fts USING fts5(
+            title, body, content='issues', content_rowid='id', tokenize='unicode61 remove_diacritics 2');
+        CREATE TRIGGER IF NOT EXISTS issues_fts_insert AFTER INSERT ON issues BEGIN
+            INSERT INTO issues_fts (rowid, title, body) VALUES (new.id, new.title, new.body);
+        END;
+        CREATE TRIGGER IF NOT EXISTS issues_fts_delete AFTER DELETE ON issues BEGIN
+            INSERT INTO issues_fts (issues_fts, rowid, title, body) VALUES ('delete', old.id, old.title, old.body);
+        END;
+        CREATE TRIGGER IF NOT EXISTS issues_fts_update AFTER UPDATE OF title, body ON issues
+        WHEN old.title IS NOT new.title OR old.body IS NOT new.body BEGIN
+            INSERT INTO issues_fts (issues_fts, rowid, title, body) VALUES ('delete', old.id, old.title, old.body);
+            INSERT INTO issues_fts (rowid, title, body) VALUES (new.id, new.title, new.body);
+        END;
+        INSERT INTO issues_fts (issues_fts, rank) VALUES ('rank', 'bm25(10.0, 1.0)');
+        INSERT INTO issues_fts (issues_fts) VALUES ('rebuild');
+    )"},
+    // Repo groups for --fanout
+    {6, R"(
+        ALTER TABLE tokens ADD COLUMN tags TEXT NOT NULL DEFAULT '';
+    )"},
+    // Each repo's labels, for checking --labels before sending, and label aliases
+    {7, R"(
+        CREATE TABLE IF NOT EXISTS repo_labels (
+            owner TEXT NOT NULL,
+            repo TEXT NOT NULL,
+            name TEXT NOT NULL,
+            PRIMARY KEY (owner, repo, name)
+        ) WITHOUT ROWID;
+        CREATE TABLE IF NOT EXISTS label_sync (
+            owner TEXT NOT NULL,
+            repo TEXT NOT NULL,
+            fetched_at INTEGER NOT NULL,
+            PRIMARY KEY (owner, repo)
+        );
+        CREATE TABLE IF NOT EXISTS label_aliases (
+            alias TEXT PRIMARY KEY COLLATE NOCASE,
+            label TEXT NOT NULL
+        );
+    )"},
+};
+
+// Resets a cached statement when it goes out of scope, releasing its read snapshot
+class StatementScope {
+public:
+    explicit StatementScope(void* stmt) : stmt((sqlite3_stmt*)stmt) {}
+    ~StatementScope() {
+        if (stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    }
+    sqlite3_stmt* get() const { return stmt; }
+    explicit operator bool() const { return stmt != nullptr; }
+
+private:
+    sqlite3_stmt* stmt;
+};
+
+std::string columnText(sqlite3_stmt* stmt, int col) {
+    const unsigned char* text = sqlite3_column_text(stmt, col);
+    return text ? std::string(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, col)) : std::string();
+}
+
+void readRepoConfig(sqlite3_stmt* stmt, RepoConfig& cfg) {
+    cfg.id = sqlite3_column_int(stmt, 0);
+    cfg.repo = columnText(stmt, 1);
+    cfg.owner = columnText(stmt, 2);
+    cfg.encrypted_token = columnText(stmt, 3);
+    cfg.tags = columnText(stmt, 4);
+}
+
+// Turns search words into an FTS5 query: each word is quoted so punctuation such
+// as "C++" or "foo-bar" is matched literally instead of parsed as query syntax.
+// Words are ANDed; a trailing * is kept as a prefix match.
+std::string ftsQuery(const std::string& text) {
+    std::string query;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t start = text.find_first_not_of(" \t\r\n", pos);
+        if (start == std::string::npos) break;
+        size_t end = text.find_first_of(" \t\r\n", start);
+        if (end == std::string::npos) end = text.size();
+        pos = end;
+
+        bool prefix = end - start > 1 && text[end - 1] == '*';
+        if (prefix) --end;
+        if (!query.empty()) query += ' ';
+        query += '"';
+        for (size_t i = start; i < end; ++i) {
+            if (text[i] == '"') query += '"';
+            query += text[i];
+        }
+        query += '"';
+        if (prefix) query += '*';
+    }
+    return query;
+}
+
+} // namespace
+
+ConfigSetup::ConfigSetup(const std::string& dbPath) : dbPath(dbPath), db(nullptr), busyTimeoutMs(5000), busyCount(0), repoIndexStale(false) {}
 
 ConfigSetup::~ConfigSetup() {
     closeDB();
@@ -29,26 +222,141 @@ bool ConfigSetup::openDB() {
         return false;
     }
 
-    const char* sql_create = R"(
-        CREATE TABLE IF NOT EXISTS tokens (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            repo TEXT NOT NULL,
-            owner TEXT NOT NULL,
-            encrypted_token TEXT NOT NULL,
-            isDefault INTEGER DEFAULT 0
-        );
-    )";
+    // Several gitee-issue processes may enqueue into the outbox at once: WAL lets
+    // readers and one writer proceed concurrently, and commits only append to the log
+    sqlite3_busy_handler((sqlite3*)db, busyHandler, this);
+    sqlite3_exec((sqlite3*)db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+
+    if (!migrate()) return false;
+    // First run after an upgrade, or the file was removed
+    if (!std::filesystem::exists(repoIndexPath(dbPath))) refreshRepoIndex();
+    return true;
+}
+
+std::string ConfigSetup::repoIndexPath(const std::string& dbPath) {
+    return (std::filesystem::path(dbPath).parent_path() / "repos.idx").string();
+}
+
+void ConfigSetup::refreshRepoIndex() {
+    repoIndexStale = false;
+    std::vector<std::pair<std::string, std::string>> repos;
+    StatementScope stmt(prepare("SELECT owner, repo FROM tokens;"));
+    if (!stmt) return;
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        repos.emplace_back(columnText(stmt.get(), 0), columnText(stmt.get(), 1));
+    }
+    // Completion falls back to no suggestions, so a failed write is not worth failing the command for
+    RepoIndex::write(repoIndexPath(dbPath), repos);
+}
+
+int ConfigSetup::getSchemaVersion() {
+    StatementScope stmt(prepare("PRAGMA user_version;"));
+    if (!stmt || sqlite3_step(stmt.get()) != SQLITE_ROW) return -1;
+    return sqlite3_column_int(stmt.get(), 0);
+}
+
+bool ConfigSetup::migrate() {
+    const int latest = migrations[sizeof(migrations) / sizeof(migrations[0]) - 1].version;
+    if (getSchemaVersion() >= latest) return true;
+
+    // Re-check under the write lock: another process may have migrated meanwhile
+    return transaction([this]() {
+        int version = getSchemaVersion();
+        for (const Migration& m : migrations) {
+            if (m.version <= version) continue;
+
+            char* errMsg = nullptr;
+            std::string setVersion = "PRAGMA user_version = " + std::to_string(m.version) + ";";
+            if (sqlite3_exec((sqlite3*)db, m.sql, nullptr, nullptr, &errMsg) != SQLITE_OK ||
+                sqlite3_exec((sqlite3*)db, setVersion.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+                std::cerr << "Failed to migrate DB to version " << m.version << ": "
+                          << (errMsg ? errMsg : sqlite3_errmsg((sqlite3*)db)) << std::endl;
+                sqlite3_free(errMsg);
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+int ConfigSetup::busyHandler(void* self, int attempt) {
+    // Same back-off curve as sqlite3_busy_timeout, but counted and adjustable at runtime
+    static const int delays[] = {1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100};
+    static const int count = sizeof(delays) / sizeof(delays[0]);
+
+    ConfigSetup* config = static_cast<ConfigSetup*>(self);
+    if (attempt == 0) ++config->busyCount;
 
-    char* errMsg = nullptr;
-    if (sqlite3_exec((sqlite3*)db, sql_create, nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        std::cerr << "Failed to create table: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
+    int waited = 0;
+    for (int i = 0; i < attempt && i < count; ++i) waited += delays[i];
+    if (attempt > count) waited += (attempt - count) * delays[count - 1];
+
+    int remaining = config->busyTimeoutMs - waited;
+    if (remaining <= 0) return 0;
+
+    int delay = std::min(delays[std::min(attempt, count - 1)], remaining);
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+    return 1;
+}
+
+void ConfigSetup::setBusyTimeout(int milliseconds) {
+    busyTimeoutMs = std::max(0, milliseconds);
+}
+
+size_t ConfigSetup::getBusyCount() const {
+    return busyCount;
+}
+
+bool ConfigSetup::transaction(const std::function<bool()>& work) {
+    if (!db) return false;
+
+    // IMMEDIATE takes the write lock up front. A deferred transaction that reads
+    // first and then writes can fail with SQLITE_BUSY without the busy handler
+    // ever being called, because another writer committed in between.
+    if (sqlite3_exec((sqlite3*)db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to lock DB: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        return false;
+    }
+
+    if (!work()) {
+        sqlite3_exec((sqlite3*)db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    if (sqlite3_exec((sqlite3*)db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to commit: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        sqlite3_exec((sqlite3*)db, "ROLLBACK;", nullptr, nullptr, nullptr);
         return false;
     }
     return true;
 }
 
+void* ConfigSetup::prepare(const char* sql) {
+    if (!db) return nullptr;
+
+    auto it = statements.find(sql);
+    if (it != statements.end()) {
+        return it->second;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3((sqlite3*)db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "SQL prepare error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        return nullptr;
+    }
+    statements.emplace(sql, stmt);
+    return stmt;
+}
+
 void ConfigSetup::closeDB() {
+    // Once per process rather than per change, so adding many repos stays linear
+    if (db && repoIndexStale) refreshRepoIndex();
+    repoIndexStale = false;
+
+    for (auto& entry : statements) {
+        sqlite3_finalize((sqlite3_stmt*)entry.second);
+    }
+    statements.clear();
+
     if (db) {
         sqlite3_close((sqlite3*)db);
         db = nullptr;
@@ -67,176 +375,645 @@ bool ConfigSetup::saveConfig(const std::string& repo, const std::string& owner,
         return false;
     }
 
-    const char* check_sql = "SELECT EXISTS(SELECT 1 FROM tokens LIMIT 1);";
-    sqlite3_stmt* check_stmt;
-    int isDefault = 0;
-
-    if (sqlite3_prepare_v2((sqlite3*)db, check_sql, -1, &check_stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(check_stmt) == SQLITE_ROW) {
-            int exists = sqlite3_column_int(check_stmt, 0);
-            isDefault = (exists == 0) ? 1 : 0; 
+    // The first repo becomes the default; checking and inserting in one transaction
+    // keeps two concurrent --add calls from both (or neither) becoming the default
+    bool saved = transaction([&]() {
+        int isDefault = 0;
+        {
+            StatementScope check(prepare("SELECT EXISTS(SELECT 1 FROM tokens LIMIT 1);"));
+            if (!check) return false;
+            if (sqlite3_step(check.get()) == SQLITE_ROW) {
+                int exists = sqlite3_column_int(check.get(), 0);
+                isDefault = (exists == 0) ? 1 : 0;
+            }
         }
-    } else {
-        std::cerr << "SQL check prepare error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
-        return false;
-    }
-    sqlite3_finalize(check_stmt);
-
-    const char* sql_insert = "INSERT INTO tokens (repo, owner, encrypted_token, isDefault) VALUES (?, ?, ?, ?);";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2((sqlite3*)db, sql_insert, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
-        return false;
-    }
 
-    sqlite3_bind_text(stmt, 1, repo.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, encrypted_token.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 4, isDefault); 
+        // Re-adding a repo replaces its token instead of creating a duplicate row
+        StatementScope stmt(prepare(
+            "INSERT INTO tokens (repo, owner, encrypted_token, isDefault) VALUES (?, ?, ?, ?) "
+            "ON CONFLICT(owner, repo) DO UPDATE SET encrypted_token = excluded.encrypted_token;"));
+        if (!stmt) return false;
 
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
-        std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
-        sqlite3_finalize(stmt);
-        return false;
-    }
+        sqlite3_bind_text(stmt.get(), 1, repo.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, owner.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, encrypted_token.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt.get(), 4, isDefault);
 
-    sqlite3_finalize(stmt);
-    return true;
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+            return false;
+        }
+        return true;
+    });
+    if (saved) repoIndexStale = true;
+    return saved;
 }
 
 std::vector<RepoConfig> ConfigSetup::getConfigs() {
     std::vector<RepoConfig> configs;
-    const char* sql_select = "SELECT id, repo, owner, encrypted_token FROM tokens;";
-    sqlite3_stmt* stmt;
+    StatementScope stmt(prepare("SELECT id, repo, owner, encrypted_token, tags FROM tokens;"));
+    if (!stmt) return configs;
 
-    if (sqlite3_prepare_v2((sqlite3*)db, sql_select, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
-        return configs;
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        RepoConfig cfg;
+        readRepoConfig(stmt.get(), cfg);
+        configs.push_back(cfg);
     }
+    return configs;
+}
+
+std::vector<RepoConfig> ConfigSetup::getConfigs(const std::vector<std::pair<std::string, std::string>>& repos) {
+    std::vector<RepoConfig> configs;
+    if (!db || repos.empty()) return configs;
+
+    // The pairs go in as one JSON array, so a single cached statement serves any number of them
+    JsonWriter pairs(64 * repos.size());
+    pairs.beginArray();
+    for (const auto& repo : repos) pairs.beginArray().value(repo.first).value(repo.second).endArray();
+    pairs.endArray();
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
+    StatementScope stmt(prepare(
+        "SELECT t.id, t.repo, t.owner, t.encrypted_token, t.tags FROM json_each(?) AS j "
+        "JOIN tokens AS t ON t.owner = json_extract(j.value, '$[0]') AND t.repo = json_extract(j.value, '$[1]') "
+        "ORDER BY j.key;"));
+    if (!stmt) return configs;
+    sqlite3_bind_text(stmt.get(), 1, pairs.data(), (int)pairs.size(), SQLITE_STATIC);
+
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
         RepoConfig cfg;
-        cfg.id = sqlite3_column_int(stmt, 0);
-        cfg.repo = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        cfg.owner = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        cfg.encrypted_token = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        readRepoConfig(stmt.get(), cfg);
         configs.push_back(cfg);
     }
+    return configs;
+}
+
+std::vector<RepoConfig> ConfigSetup::getConfigsByTag(const std::string& tag) {
+    std::vector<RepoConfig> configs;
+    if (!db || tag.empty()) return configs;
 
-    sqlite3_finalize(stmt);
+    StatementScope stmt(prepare(
+        "SELECT id, repo, owner, encrypted_token, tags FROM tokens "
+        "WHERE instr(',' || tags || ',', ',' || ? || ',') > 0 ORDER BY owner, repo;"));
+    if (!stmt) return configs;
+    sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_STATIC);
+
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        RepoConfig cfg;
+        readRepoConfig(stmt.get(), cfg);
+        configs.push_back(cfg);
+    }
     return configs;
 }
 
+bool ConfigSetup::setRepoTags(const std::string& owner, const std::string& repo, const std::string& tags) {
+    if (!db) return false;
+
+    std::string normalized;
+    size_t start = 0;
+    while (start <= tags.size()) {
+        size_t end = tags.find(',', start);
+        if (end == std::string::npos) end = tags.size();
+        size_t first = tags.find_first_not_of(' ', start);
+        if (first < end) {
+            size_t last = tags.find_last_not_of(' ', end - 1);
+            if (!normalized.empty()) normalized += ',';
+            normalized.append(tags, first, last + 1 - first);
+        }
+        start = end + 1;
+    }
+
+    StatementScope stmt(prepare("UPDATE tokens SET tags = ? WHERE owner = ? AND repo = ?;"));
+    if (!stmt) return false;
+    sqlite3_bind_text(stmt.get(), 1, normalized.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, repo.c_str(), -1, SQLITE_STATIC);
+    return sqlite3_step(stmt.get()) == SQLITE_DONE && sqlite3_changes((sqlite3*)db) > 0;
+}
+
+bool ConfigSetup::getConfig(const std::string& owner, const std::string& repo, RepoConfig& outConfig) {
+    if (!db) return false;
+
+    // Served by idx_tokens_owner_repo
+    StatementScope stmt(prepare("SELECT id, repo, owner, encrypted_token, tags FROM tokens WHERE owner = ? AND repo = ?;"));
+    if (!stmt) return false;
+
+    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) return false;
+
+    readRepoConfig(stmt.get(), outConfig);
+    return true;
+}
+
 std::string ConfigSetup::getDecryptedDefaultToken() {
     if (!db) {
         std::cerr << "DB not opened!" << std::endl;
         return "";
     }
 
-    const char* sql = "SELECT encrypted_token FROM tokens WHERE isDefault = 1 LIMIT 1;";
-    sqlite3_stmt* stmt;
-    std::string decryptedToken;
-
-    if (sqlite3_prepare_v2((sqlite3*)db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+    RepoConfig defConfig;
+    if (!getDefaultRepoConfig(defConfig)) {
         return "";
     }
 
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        const unsigned char* encToken = sqlite3_column_text(stmt, 0);
-        if (encToken) {
-            std::string encryptedTokenStr = reinterpret_cast<const char*>(encToken);
-            Hasher hasher(getKey());
-            try {
-                decryptedToken = hasher.decrypt(encryptedTokenStr);
-            } catch (const std::exception& e) {
-                std::cerr << "Decryption failed: " << e.what() << std::endl;
+    std::string decryptedToken;
+    Hasher hasher(getKey());
+    try {
+        decryptedToken = hasher.decrypt(defConfig.encrypted_token);
+    } catch (const std::exception& e) {
+        std::cerr << "Decryption failed: " << e.what() << std::endl;
+    }
+    return decryptedToken;
+}
+
+long long ConfigSetup::getDataVersion() {
+    StatementScope stmt(prepare("PRAGMA data_version;"));
+    if (!stmt || sqlite3_step(stmt.get()) != SQLITE_ROW) return -1;
+    return sqlite3_column_int64(stmt.get(), 0);
+}
+
+bool ConfigSetup::setDefaultRepo(const std::string& owner, const std::string& repo) {
+    // Both updates commit together, so other processes never see zero defaults.
+    // An unknown repo leaves the current default in place.
+    return transaction([&]() {
+        {
+            // Only the current default row needs clearing; idx_tokens_default finds it directly
+            StatementScope reset(prepare("UPDATE tokens SET isDefault = 0 WHERE isDefault = 1;"));
+            if (!reset || sqlite3_step(reset.get()) != SQLITE_DONE) {
+                return false;
             }
         }
-    }
 
-    sqlite3_finalize(stmt);
-    return decryptedToken;
+        StatementScope set(prepare("UPDATE tokens SET isDefault = 1 WHERE owner = ? AND repo = ?;"));
+        if (!set) return false;
+
+        sqlite3_bind_text(set.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(set.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+        return sqlite3_step(set.get()) == SQLITE_DONE && sqlite3_changes((sqlite3*)db) > 0;
+    });
 }
 
-bool ConfigSetup::setDefaultRepo(const std::string& repoName) {
-    sqlite3_stmt* stmt1;
-    sqlite3_stmt* stmt2;
+bool ConfigSetup::getDefaultRepoConfig(RepoConfig& outConfig) {
+    if (!db) return false;
+
+    StatementScope stmt(prepare("SELECT id, repo, owner, encrypted_token, tags FROM tokens WHERE isDefault = 1 LIMIT 1;"));
+    if (!stmt) return false;
 
-    
-    const char* resetSQL = "UPDATE tokens SET isDefault = 0;";
-    if (sqlite3_prepare_v2((sqlite3*)db, resetSQL, -1, &stmt1, nullptr) != SQLITE_OK) {
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) return false;
+    readRepoConfig(stmt.get(), outConfig);
+    return true;
+}
+
+bool ConfigSetup::deleteRepo(const std::string& owner, const std::string& repo) {
+    if (!db) return false;
+
+    StatementScope stmt(prepare("DELETE FROM tokens WHERE owner = ? AND repo = ?;"));
+    if (!stmt) return false;
+
+    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
         return false;
     }
+    repoIndexStale = true;
+    return true;
+}
 
-    if (sqlite3_step(stmt1) != SQLITE_DONE) {
-        sqlite3_finalize(stmt1);
-        return false;
+long long ConfigSetup::enqueueIssue(const std::string& owner, const std::string& repo, const std::string& title,
+                                    const std::string& body, const std::string& labels,
+                                    const std::string& encryptedToken) {
+    if (!db) return -1;
+
+    StatementScope stmt(prepare(
+        "INSERT INTO outbox (owner, repo, title, body, labels, encrypted_token, created_at, updated_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?);"));
+    if (!stmt) return -1;
+
+    sqlite3_int64 now = (sqlite3_int64)std::time(nullptr);
+    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, title.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 4, body.c_str(), (int)body.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 5, labels.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 6, encryptedToken.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt.get(), 7, now);
+    sqlite3_bind_int64(stmt.get(), 8, now);
+
+    // A single INSERT is its own transaction: once step returns, the item survives a crash
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        return -1;
     }
-    sqlite3_finalize(stmt1);
+    return sqlite3_last_insert_rowid((sqlite3*)db);
+}
 
-    
-    const char* setSQL = "UPDATE tokens SET isDefault = 1 WHERE repo = ?;";
-    if (sqlite3_prepare_v2((sqlite3*)db, setSQL, -1, &stmt2, nullptr) != SQLITE_OK) {
-        return false;
+std::vector<OutboxItem> ConfigSetup::claimOutboxBatch(int limit, int staleSeconds) {
+    std::vector<OutboxItem> items;
+    if (!db) return items;
+
+    // The write lock is taken up front, so two drain workers never claim the same rows
+    sqlite3_int64 now = (sqlite3_int64)std::time(nullptr);
+    bool claimed = transaction([&]() {
+        StatementScope select(prepare(
+            "SELECT id, owner, repo, title, body, labels, encrypted_token, attempts, created_at, status = 'sending' "
+            "FROM outbox WHERE status = 'pending' OR (status = 'sending' AND updated_at < ?) "
+            "ORDER BY id LIMIT ?;"));
+        StatementScope claim(prepare("UPDATE outbox SET status = 'sending', updated_at = ? WHERE id = ?;"));
+        if (!select || !claim) return false;
+
+        sqlite3_bind_int64(select.get(), 1, now - staleSeconds);
+        sqlite3_bind_int(select.get(), 2, limit);
+        while (sqlite3_step(select.get()) == SQLITE_ROW) {
+            OutboxItem item;
+            item.id = sqlite3_column_int64(select.get(), 0);
+            item.owner = columnText(select.get(), 1);
+            item.repo = columnText(select.get(), 2);
+            item.title = columnText(select.get(), 3);
+            item.body = columnText(select.get(), 4);
+            item.labels = columnText(select.get(), 5);
+            item.encrypted_token = columnText(select.get(), 6);
+            item.attempts = sqlite3_column_int(select.get(), 7);
+            item.createdAt = sqlite3_column_int64(select.get(), 8);
+            item.reclaimed = sqlite3_column_int(select.get(), 9) != 0;
+            items.push_back(item);
+        }
+
+        for (const OutboxItem& item : items) {
+            sqlite3_bind_int64(claim.get(), 1, now);
+            sqlite3_bind_int64(claim.get(), 2, item.id);
+            if (sqlite3_step(claim.get()) != SQLITE_DONE) return false;
+            sqlite3_reset(claim.get());
+        }
+        return true;
+    });
+
+    if (!claimed) {
+        std::cerr << "Failed to claim outbox items: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        items.clear();
     }
+    return items;
+}
+
+bool ConfigSetup::recordOutboxResults(const std::vector<OutboxResult>& results, int maxAttempts) {
+    if (!db) return false;
+    if (results.empty()) return true;
+
+    return transaction([&]() {
+        StatementScope stmt(prepare(
+            "UPDATE outbox SET "
+            "status = CASE WHEN ?1 THEN 'done' WHEN ?2 AND attempts + 1 < ?3 THEN 'pending' ELSE 'failed' END, "
+            "attempts = attempts + 1, issue_id = ?4, issue_number = ?5, html_url = ?6, error = ?7, "
+            "updated_at = ?8 WHERE id = ?9;"));
+        // Sent issues go into the local issue cache right away, so --search finds them before the next --sync
+        StatementScope cache(prepare(
+            "INSERT OR IGNORE INTO issues (id, owner, repo, number, title, body, state, labels, html_url) "
+            "SELECT issue_id, owner, repo, COALESCE(issue_number, ''), title, body, 'open', labels, "
+            "COALESCE(html_url, '') FROM outbox WHERE id = ? AND issue_id IS NOT NULL;"));
+        if (!stmt || !cache) return false;
+
+        sqlite3_int64 now = (sqlite3_int64)std::time(nullptr);
+        for (const OutboxResult& r : results) {
+            sqlite3_bind_int(stmt.get(), 1, r.success ? 1 : 0);
+            sqlite3_bind_int(stmt.get(), 2, r.retry ? 1 : 0);
+            sqlite3_bind_int(stmt.get(), 3, maxAttempts);
+            if (r.success) {
+                sqlite3_bind_int64(stmt.get(), 4, r.issueId);
+                sqlite3_bind_text(stmt.get(), 5, r.issueNumber.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_text(stmt.get(), 6, r.htmlUrl.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_null(stmt.get(), 7);
+            } else {
+                sqlite3_bind_null(stmt.get(), 4);
+                sqlite3_bind_null(stmt.get(), 5);
+                sqlite3_bind_null(stmt.get(), 6);
+                sqlite3_bind_text(stmt.get(), 7, r.error.c_str(), -1, SQLITE_STATIC);
+            }
+            sqlite3_bind_int64(stmt.get(), 8, now);
+            sqlite3_bind_int64(stmt.get(), 9, r.id);
+            if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+                std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+                return false;
+            }
+            sqlite3_reset(stmt.get());
 
-    sqlite3_bind_text(stmt2, 1, repoName.c_str(), -1, SQLITE_STATIC);
+            if (r.success && r.issueId >= 0) {
+                sqlite3_bind_int64(cache.get(), 1, r.id);
+                if (sqlite3_step(cache.get()) != SQLITE_DONE) {
+                    std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+                    return false;
+                }
+                sqlite3_reset(cache.get());
+            }
+        }
+        return true;
+    });
+}
 
-    bool success = sqlite3_step(stmt2) == SQLITE_DONE;
-    sqlite3_finalize(stmt2);
-    return success;
+long long ConfigSetup::countPendingOutbox() {
+    if (!db) return 0;
+
+    StatementScope stmt(prepare("SELECT COUNT(*) FROM outbox WHERE status IN ('pending', 'sending');"));
+    if (!stmt || sqlite3_step(stmt.get()) != SQLITE_ROW) return 0;
+    return sqlite3_column_int64(stmt.get(), 0);
 }
 
-bool ConfigSetup::getDefaultRepoConfig(RepoConfig& outConfig) {
+bool ConfigSetup::findKnownIssue(long long hash, long long notBefore, KnownIssue& outIssue) {
     if (!db) return false;
 
-    const char* sql = "SELECT id, repo, owner, encrypted_token FROM tokens WHERE isDefault = 1 LIMIT 1;";
-    sqlite3_stmt* stmt;
+    StatementScope stmt(prepare(
+        "SELECT issue_id, issue_number, html_url, created_at FROM issue_hashes WHERE hash = ? AND created_at >= ?;"));
+    if (!stmt) return false;
+    sqlite3_bind_int64(stmt.get(), 1, hash);
+    sqlite3_bind_int64(stmt.get(), 2, notBefore);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) return false;
 
-    if (sqlite3_prepare_v2((sqlite3*)db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+    outIssue.issueId = sqlite3_column_int64(stmt.get(), 0);
+    outIssue.issueNumber = columnText(stmt.get(), 1);
+    outIssue.htmlUrl = columnText(stmt.get(), 2);
+    outIssue.createdAt = sqlite3_column_int64(stmt.get(), 3);
+    return true;
+}
+
+bool ConfigSetup::saveKnownIssue(long long hash, const std::string& owner, const std::string& repo,
+                                 const KnownIssue& issue) {
+    if (!db) return false;
+
+    // A newer issue with the same content replaces the old entry and restarts its TTL
+    StatementScope stmt(prepare(
+        "INSERT OR REPLACE INTO issue_hashes (hash, owner, repo, issue_id, issue_number, html_url, created_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?);"));
+    if (!stmt) return false;
+    sqlite3_bind_int64(stmt.get(), 1, hash);
+    sqlite3_bind_text(stmt.get(), 2, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, repo.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt.get(), 4, issue.issueId);
+    sqlite3_bind_text(stmt.get(), 5, issue.issueNumber.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 6, issue.htmlUrl.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt.get(), 7, issue.createdAt);
+
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
         return false;
     }
+    return true;
+}
+
+long long ConfigSetup::pruneKnownIssues(long long before) {
+    if (!db) return 0;
 
-    bool found = false;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        outConfig.id = sqlite3_column_int(stmt, 0);
-        outConfig.repo = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        outConfig.owner = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        outConfig.encrypted_token = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        found = true;
+    StatementScope stmt(prepare("DELETE FROM issue_hashes WHERE created_at < ?;"));
+    if (!stmt) return 0;
+    sqlite3_bind_int64(stmt.get(), 1, before);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        return 0;
     }
+    return sqlite3_changes((sqlite3*)db);
+}
+
+bool ConfigSetup::stepIssueUpsert(const CachedIssue& issue, std::string_view body) {
+    StatementScope stmt(prepare(
+        "INSERT INTO issues (id, owner, repo, number, title, body, state, labels, author, html_url, "
+        "created_at, updated_at) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12) "
+        "ON CONFLICT(id) DO UPDATE SET owner = ?2, repo = ?3, number = ?4, title = ?5, body = ?6, "
+        "state = ?7, labels = ?8, author = ?9, html_url = ?10, created_at = ?11, updated_at = ?12;"));
+    if (!stmt) return false;
 
-    sqlite3_finalize(stmt);
-    return found;
+    const std::string* texts[] = {&issue.owner, &issue.repo, &issue.number, &issue.title, nullptr,
+                                  &issue.state, &issue.labels, &issue.author, &issue.htmlUrl,
+                                  &issue.createdAt, &issue.updatedAt};
+    sqlite3_bind_int64(stmt.get(), 1, issue.id);
+    for (int i = 0; i < 11; ++i) {
+        if (texts[i]) {
+            sqlite3_bind_text(stmt.get(), i + 2, texts[i]->c_str(), (int)texts[i]->size(), SQLITE_STATIC);
+        }
+    }
+    sqlite3_bind_text64(stmt.get(), 6, body.data(), body.size(), SQLITE_STATIC, SQLITE_UTF8);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        return false;
+    }
+    return true;
 }
 
-bool ConfigSetup::deleteRepo(const std::string& owner, const std::string& repo) {
+bool ConfigSetup::upsertIssues(const std::vector<CachedIssue>& issues) {
     if (!db) return false;
+    if (issues.empty()) return true;
 
-    const char* sql = "DELETE FROM tokens WHERE owner = ? AND repo = ?;";
-    sqlite3_stmt* stmt;
+    // One commit per page instead of per row
+    return transaction([&]() {
+        for (const CachedIssue& issue : issues) {
+            if (!stepIssueUpsert(issue, issue.body)) return false;
+        }
+        return true;
+    });
+}
 
-    if (sqlite3_prepare_v2((sqlite3*)db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
-        return false;
+bool ConfigSetup::upsertIssue(const CachedIssue& issue, std::string_view body) {
+    if (!db) return false;
+    return stepIssueUpsert(issue, body);
+}
+
+long long ConfigSetup::countCachedIssues(const std::string& owner, const std::string& repo) {
+    if (!db) return 0;
+
+    StatementScope stmt(prepare("SELECT COUNT(*) FROM issues WHERE owner = ? AND repo = ?;"));
+    if (!stmt) return 0;
+    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) return 0;
+    return sqlite3_column_int64(stmt.get(), 0);
+}
+
+bool ConfigSetup::searchIssues(const std::string& text, const std::string& owner, const std::string& repo,
+                               int limit, std::vector<IssueMatch>& out) {
+    out.clear();
+    if (!db) return false;
+
+    std::string query = ftsQuery(text);
+    if (query.empty()) return true;
+
+    // BM25 costs a few microseconds per matching issue, so a word found in most issues would take
+    // seconds to rank. Only the newest SearchCandidates matches are ranked; the rowid bound is
+    // applied inside the full-text index, before any scoring.
+    static const char* const select =
+        "SELECT i.id, i.owner, i.repo, i.number, i.title, i.state, i.labels, i.author, i.html_url, i.created_at, "
+        "i.updated_at, snippet(issues_fts, 1, '[', ']', '...', 12), issues_fts.rank "
+        "FROM issues_fts JOIN issues i ON i.id = issues_fts.rowid "
+        "WHERE issues_fts MATCH ?1 AND (?2 = '' OR i.owner = ?2) AND (?3 = '' OR i.repo = ?3) ";
+    static const std::string capped = std::string(select) +
+        "AND issues_fts.rowid >= COALESCE((SELECT rowid FROM issues_fts WHERE issues_fts MATCH ?1 "
+        "ORDER BY rowid DESC LIMIT 1 OFFSET " + std::to_string(SearchCandidates - 1) + "), 0) "
+        "ORDER BY issues_fts.rank LIMIT ?4;";
+    static const std::string uncapped = std::string(select) + "ORDER BY issues_fts.rank LIMIT ?4;";
+
+    // The bound ignores owner and repo, so a filtered search that comes up short is repeated without it
+    bool filtered = !owner.empty() || !repo.empty();
+    for (const std::string* sql : {&capped, &uncapped}) {
+        out.clear();
+        StatementScope stmt(prepare(sql->c_str()));
+        if (!stmt) return false;
+        sqlite3_bind_text(stmt.get(), 1, query.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, owner.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, repo.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt.get(), 4, limit);
+
+        int rc;
+        while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+            IssueMatch match;
+            CachedIssue& issue = match.issue;
+            issue.id = sqlite3_column_int64(stmt.get(), 0);
+            issue.owner = columnText(stmt.get(), 1);
+            issue.repo = columnText(stmt.get(), 2);
+            issue.number = columnText(stmt.get(), 3);
+            issue.title = columnText(stmt.get(), 4);
+            issue.state = columnText(stmt.get(), 5);
+            issue.labels = columnText(stmt.get(), 6);
+            issue.author = columnText(stmt.get(), 7);
+            issue.htmlUrl = columnText(stmt.get(), 8);
+            issue.createdAt = columnText(stmt.get(), 9);
+            issue.updatedAt = columnText(stmt.get(), 10);
+            match.snippet = columnText(stmt.get(), 11);
+            match.rank = sqlite3_column_double(stmt.get(), 12);
+            out.push_back(std::move(match));
+        }
+        if (rc != SQLITE_DONE) {
+            std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+            return false;
+        }
+        if (!filtered || (int)out.size() >= limit) break;
     }
+    return true;
+}
+
+std::string ConfigSetup::getSyncCursor(const std::string& owner, const std::string& repo) {
+    if (!db) return "";
 
-    sqlite3_bind_text(stmt, 1, owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, repo.c_str(), -1, SQLITE_TRANSIENT);
+    StatementScope stmt(prepare("SELECT cursor FROM sync_state WHERE owner = ? AND repo = ?;"));
+    if (!stmt) return "";
+    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) return "";
+    return columnText(stmt.get(), 0);
+}
+
+bool ConfigSetup::setSyncCursor(const std::string& owner, const std::string& repo, const std::string& updatedAt) {
+    if (!db) return false;
 
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
+    StatementScope stmt(prepare(
+        "INSERT INTO sync_state (owner, repo, cursor, synced_at) VALUES (?1, ?2, ?3, ?4) "
+        "ON CONFLICT(owner, repo) DO UPDATE SET cursor = ?3, synced_at = ?4;"));
+    if (!stmt) return false;
+    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, updatedAt.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt.get(), 4, (sqlite3_int64)std::time(nullptr));
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
         std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
-        sqlite3_finalize(stmt);
         return false;
     }
+    return true;
+}
+
+bool ConfigSetup::getRepoLabels(const std::string& owner, const std::string& repo, std::vector<std::string>& out,
+                                long long& fetchedAt) {
+    out.clear();
+    fetchedAt = 0;
+    if (!db) return false;
+
+    StatementScope sync(prepare("SELECT fetched_at FROM label_sync WHERE owner = ? AND repo = ?;"));
+    if (!sync) return false;
+    sqlite3_bind_text(sync.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(sync.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(sync.get()) != SQLITE_ROW) return false;
+    fetchedAt = sqlite3_column_int64(sync.get(), 0);
+
+    StatementScope stmt(prepare("SELECT name FROM repo_labels WHERE owner = ? AND repo = ?;"));
+    if (!stmt) return false;
+    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        out.push_back(columnText(stmt.get(), 0));
+    }
+    return true;
+}
+
+bool ConfigSetup::saveRepoLabels(const std::string& owner, const std::string& repo,
+                                 const std::vector<std::string>& names) {
+    if (!db) return false;
+
+    return transaction([&]() {
+        StatementScope clear(prepare("DELETE FROM repo_labels WHERE owner = ? AND repo = ?;"));
+        if (!clear) return false;
+        sqlite3_bind_text(clear.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(clear.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(clear.get()) != SQLITE_DONE) return false;
+
+        if (!insertRepoLabels(owner, repo, names)) return false;
+
+        StatementScope sync(prepare(
+            "INSERT INTO label_sync (owner, repo, fetched_at) VALUES (?1, ?2, ?3) "
+            "ON CONFLICT(owner, repo) DO UPDATE SET fetched_at = ?3;"));
+        if (!sync) return false;
+        sqlite3_bind_text(sync.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(sync.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(sync.get(), 3, (sqlite3_int64)std::time(nullptr));
+        return sqlite3_step(sync.get()) == SQLITE_DONE;
+    });
+}
 
-    sqlite3_finalize(stmt);
+bool ConfigSetup::addRepoLabels(const std::string& owner, const std::string& repo,
+                                const std::vector<std::string>& names) {
+    if (!db) return false;
+    return transaction([&]() { return insertRepoLabels(owner, repo, names); });
+}
+
+bool ConfigSetup::insertRepoLabels(const std::string& owner, const std::string& repo,
+                                   const std::vector<std::string>& names) {
+    StatementScope insert(prepare("INSERT OR IGNORE INTO repo_labels (owner, repo, name) VALUES (?, ?, ?);"));
+    if (!insert) return false;
+    sqlite3_bind_text(insert.get(), 1, owner.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(insert.get(), 2, repo.c_str(), -1, SQLITE_STATIC);
+    for (const std::string& name : names) {
+        sqlite3_bind_text(insert.get(), 3, name.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(insert.get()) != SQLITE_DONE) {
+            std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+            return false;
+        }
+        sqlite3_reset(insert.get());
+    }
     return true;
 }
 
+std::vector<std::pair<std::string, std::string>> ConfigSetup::getLabelAliases() {
+    std::vector<std::pair<std::string, std::string>> aliases;
+    if (!db) return aliases;
 
+    StatementScope stmt(prepare("SELECT alias, label FROM label_aliases ORDER BY alias;"));
+    if (!stmt) return aliases;
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        aliases.emplace_back(columnText(stmt.get(), 0), columnText(stmt.get(), 1));
+    }
+    return aliases;
+}
+
+bool ConfigSetup::setLabelAlias(const std::string& alias, const std::string& label) {
+    if (!db) return false;
+
+    StatementScope stmt(prepare(label.empty()
+                                    ? "DELETE FROM label_aliases WHERE alias = ?1;"
+                                    : "INSERT INTO label_aliases (alias, label) VALUES (?1, ?2) "
+                                      "ON CONFLICT(alias) DO UPDATE SET label = ?2;"));
+    if (!stmt) return false;
+    sqlite3_bind_text(stmt.get(), 1, alias.c_str(), -1, SQLITE_STATIC);
+    if (!label.empty()) sqlite3_bind_text(stmt.get(), 2, label.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        std::cerr << "SQL step error: " << sqlite3_errmsg((sqlite3*)db) << std::endl;
+        return false;
+    }
+    return true;
+}
 
 std::string ConfigSetup::getKey() {
     return std::string{
@@ -1,5 +1,8 @@
 #pragma once
+#include <functional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 
@@ -8,27 +11,168 @@ struct RepoConfig {
     std::string repo;
     std::string owner;
     std::string encrypted_token;
+    std::string tags; // Comma-separated, for --fanout
+};
+
+// An issue waiting in the outbox to be sent by a drain worker
+struct OutboxItem {
+    long long id;
+    std::string owner;
+    std::string repo;
+    std::string title;
+    std::string body;
+    std::string labels;
+    std::string encrypted_token; // Empty: use the token configured for owner/repo
+    int attempts;
+    long long createdAt = 0; // Unix time it was queued
+    bool reclaimed = false;  // Claimed before by a worker that never recorded the outcome
+};
+
+// Final or intermediate outcome of sending an outbox item
+struct OutboxResult {
+    long long id = 0;
+    bool success = false;
+    bool retry = false;          // Put the item back in the queue instead of failing it
+    long long issueId = -1;
+    std::string issueNumber;
+    std::string htmlUrl;
+    std::string error;
+};
+
+// An issue remembered in the dedup index, keyed by a hash of its content
+struct KnownIssue {
+    long long issueId = -1;
+    std::string issueNumber;
+    std::string htmlUrl;
+    long long createdAt = 0; // Unix time
+};
+
+// An existing issue copied from Gitee by --sync
+struct CachedIssue {
+    long long id = -1;
+    std::string owner;
+    std::string repo;
+    std::string number;
+    std::string title;
+    std::string body;
+    std::string state;
+    std::string labels;    // Comma-separated label names
+    std::string author;
+    std::string htmlUrl;
+    std::string createdAt; // As sent by Gitee (ISO 8601)
+    std::string updatedAt;
+};
+
+// A cached issue found by searchIssues(); issue.body is left empty
+struct IssueMatch {
+    CachedIssue issue;
+    std::string snippet; // Best matching fragment of the body, matched terms in [brackets]
+    double rank = 0;     // BM25 with title matches weighted 10x; lower is better
 };
 
 class ConfigSetup {
 public:
+    static const int SearchCandidates = 5000;
+
     ConfigSetup(const std::string& dbPath);
     ~ConfigSetup();
 
     bool openDB();
     void closeDB();
 
+    // Repo name index kept next to the database for shell completion (see RepoIndex).
+    // Rewritten on closeDB() when repos were added or deleted.
+    static std::string repoIndexPath(const std::string& dbPath);
+
+    // How long a statement waits for another process's lock before failing with
+    // SQLITE_BUSY. Takes effect immediately if the database is already open.
+    void setBusyTimeout(int milliseconds);
+    // Number of times this connection found the database locked and had to wait
+    size_t getBusyCount() const;
+
     bool saveConfig(const std::string& repo, const std::string& owner, const std::string& token);
 
-    bool setDefaultRepo(const std::string& repoName);
+    bool setDefaultRepo(const std::string& owner, const std::string& repo);
 
     bool deleteRepo(const std::string& owner, const std::string& repo);
 
     bool getDefaultRepoConfig(RepoConfig& outConfig);
     std::vector<RepoConfig> getConfigs();
+
+    // Looks up a single repo through the (owner, repo) index
+    bool getConfig(const std::string& owner, const std::string& repo, RepoConfig& outConfig);
+
+    // Looks up many (owner, repo) pairs in one query, each through the index.
+    // Repos that are not configured are left out.
+    std::vector<RepoConfig> getConfigs(const std::vector<std::pair<std::string, std::string>>& repos);
+
+    // Repos carrying the tag, compared exactly
+    std::vector<RepoConfig> getConfigsByTag(const std::string& tag);
+
+    // Replaces a repo's tags. Spaces around each tag and empty tags are dropped.
+    // Returns false if the repo is not configured.
+    bool setRepoTags(const std::string& owner, const std::string& repo, const std::string& tags);
     
     std::string getDecryptedDefaultToken();
 
+    // Changes whenever another connection commits to the database; used to invalidate caches
+    long long getDataVersion();
+
+    // Outbox: issues are stored durably and sent later by a drain worker.
+    // Returns the new outbox row ID, or -1 on failure.
+    long long enqueueIssue(const std::string& owner, const std::string& repo, const std::string& title,
+                           const std::string& body, const std::string& labels,
+                           const std::string& encryptedToken = "");
+
+    // Atomically marks up to limit pending items as being sent and returns them.
+    // Items left in 'sending' by a crashed worker are reclaimed after staleSeconds.
+    std::vector<OutboxItem> claimOutboxBatch(int limit, int staleSeconds = 600);
+
+    // Records the outcome of a claimed batch in a single transaction
+    bool recordOutboxResults(const std::vector<OutboxResult>& results, int maxAttempts = 5);
+
+    // Number of items still pending or being sent
+    long long countPendingOutbox();
+
+    // Dedup index: content hash -> created issue. The hash is the table's rowid,
+    // so a lookup is a single B-tree probe however many issues are stored.
+    // findKnownIssue ignores entries created before notBefore (Unix time).
+    bool findKnownIssue(long long hash, long long notBefore, KnownIssue& outIssue);
+    bool saveKnownIssue(long long hash, const std::string& owner, const std::string& repo, const KnownIssue& issue);
+    // Deletes entries created before the given Unix time; returns how many were removed
+    long long pruneKnownIssues(long long before);
+
+    // Issue cache filled by --sync. Inserts or updates all issues in one transaction.
+    bool upsertIssues(const std::vector<CachedIssue>& issues);
+    // Single issue whose body is given separately (issue.body is ignored), so a
+    // body read from a file is bound without another copy
+    bool upsertIssue(const CachedIssue& issue, std::string_view body);
+    long long countCachedIssues(const std::string& owner, const std::string& repo);
+
+    // Full-text search over cached titles and bodies. Every word in text must match
+    // (a trailing * makes a word a prefix); owner and repo narrow the results when
+    // not empty. When more than SearchCandidates issues match, the best ones among
+    // the newest SearchCandidates are returned. Returns false if the search could not run.
+    bool searchIssues(const std::string& text, const std::string& owner, const std::string& repo, int limit,
+                      std::vector<IssueMatch>& out);
+
+    // Newest updated_at seen by the last complete sync of a repo; empty if never synced
+    std::string getSyncCursor(const std::string& owner, const std::string& repo);
+    bool setSyncCursor(const std::string& owner, const std::string& repo, const std::string& updatedAt);
+
+    // Label cache, read by LabelResolver. fetchedAt is when the repo's labels were
+    // last read from Gitee (Unix time). Returns false if they never were.
+    bool getRepoLabels(const std::string& owner, const std::string& repo, std::vector<std::string>& out,
+                       long long& fetchedAt);
+    // Replaces a repo's cached labels and stamps them with the current time
+    bool saveRepoLabels(const std::string& owner, const std::string& repo, const std::vector<std::string>& names);
+    // Adds labels that were just created, keeping the fetch time
+    bool addRepoLabels(const std::string& owner, const std::string& repo, const std::vector<std::string>& names);
+
+    // Label aliases, used for every repo: alias -> label name. An empty label removes the alias.
+    std::vector<std::pair<std::string, std::string>> getLabelAliases();
+    bool setLabelAlias(const std::string& alias, const std::string& label);
+
     
     static std::string getKey();
      
@@ -36,4 +180,24 @@ public:
 private:
     std::string dbPath;
     void* db;
+    std::unordered_map<const char*, void*> statements; // Address of the SQL text -> prepared sqlite3_stmt
+
+    // Returns a cached prepared statement, compiling it on first use. Statements
+    // are looked up by the address of sql, so it must be a string literal or
+    // another string that lives, unchanged, as long as the process.
+    void* prepare(const char* sql);
+
+    int busyTimeoutMs;
+    size_t busyCount;
+    bool repoIndexStale; // Repos changed since the index was written
+
+    // Runs work inside BEGIN IMMEDIATE ... COMMIT; rolls back if work returns false
+    bool transaction(const std::function<bool()>& work);
+    static int busyHandler(void* self, int attempt);
+
+    bool migrate();
+    int getSchemaVersion();
+    void refreshRepoIndex();
+    bool stepIssueUpsert(const CachedIssue& issue, std::string_view body);
+    bool insertRepoLabels(const std::string& owner, const std::string& repo, const std::vector<std::string>& names);
 };
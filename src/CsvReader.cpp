@@ -0,0 +1,70 @@
+#include "CsvReader.h"
+
+CsvReader::CsvReader(std::istream& input) : input(input), lineNo(1), recordLine(0) {}
+
+size_t CsvReader::line() const {
+    return recordLine;
+}
+
+bool CsvReader::next(std::vector<std::string>& fields, std::string& error) {
+    typedef std::char_traits<char> Traits;
+    std::streambuf* in = input.rdbuf();
+    error.clear();
+
+    // Skip blank lines
+    int c = in->sgetc();
+    while (c == '\n' || c == '\r') {
+        if (in->sbumpc() == '\n') ++lineNo;
+        c = in->sgetc();
+    }
+    if (c == Traits::eof()) {
+        input.setstate(std::ios::eofbit);
+        return false;
+    }
+    recordLine = lineNo;
+
+    size_t count = 0;
+    for (;;) {
+        // Start a field, reusing the string left from an earlier record
+        if (count == fields.size()) fields.emplace_back();
+        std::string& field = fields[count++];
+        field.clear();
+
+        c = in->sbumpc();
+        if (c == '"') {
+            for (;;) {
+                c = in->sbumpc();
+                if (c == Traits::eof()) {
+                    error = "unterminated quoted field";
+                    fields.resize(count);
+                    return true;
+                }
+                if (c == '"') {
+                    if (in->sgetc() != '"') break;
+                    in->sbumpc();
+                } else if (c == '\n') {
+                    ++lineNo;
+                }
+                field += (char)c;
+            }
+            c = in->sbumpc();
+            if (c == '\r' && in->sgetc() == '\n') c = in->sbumpc();
+            if (c != ',' && c != '\n' && c != Traits::eof()) {
+                error = "unexpected character after a closing quote";
+                while (c != '\n' && c != Traits::eof()) c = in->sbumpc();
+            }
+        } else {
+            while (c != ',' && c != '\n' && c != Traits::eof()) {
+                field += (char)c;
+                c = in->sbumpc();
+            }
+            if (c != ',' && !field.empty() && field.back() == '\r') field.pop_back();
+        }
+
+        if (c == ',') continue;
+        if (c == '\n') ++lineNo;
+        break;
+    }
+    fields.resize(count);
+    return true;
+}
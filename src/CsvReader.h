@@ -0,0 +1,30 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// Reads RFC 4180 CSV one record at a time: comma-separated fields, optionally in
+// double quotes, with "" for a quote inside a quoted field. Quoted fields may
+// span lines. LF and CRLF line endings are both accepted. Field strings are
+// reused between records, so reading stops allocating once they have grown.
+class CsvReader {
+public:
+    explicit CsvReader(std::istream& input);
+
+    // Reads the next record into fields; blank lines are skipped. Returns false
+    // at the end of the input. A malformed record is returned with error set,
+    // and reading goes on after the line where it went wrong.
+    bool next(std::vector<std::string>& fields, std::string& error);
+
+    // Line on which the last record started, counting from 1
+    size_t line() const;
+
+private:
+    std::istream& input;
+    size_t lineNo;
+    size_t recordLine;
+};
+
+#endif // CSVREADER_H
@@ -0,0 +1,388 @@
+#include "Daemon.h"
+#include "Hasher.h"
+#include "JsonTokenizer.h"
+#include "JsonWriter.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static std::atomic<bool> stopRequested(false);
+
+static void onStopSignal(int) {
+    stopRequested = true;
+}
+
+static bool fillAddress(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+static bool writeAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Reads up to and including the next '\n'; leftover bytes stay in buffer
+static bool readLine(int fd, std::string& buffer, std::string& line) {
+    for (;;) {
+        size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            return true;
+        }
+        char chunk[4096];
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, (size_t)n);
+    }
+}
+
+std::string Daemon::defaultSocketPath(const std::string& configDir) {
+    return configDir + "/daemon.sock";
+}
+
+Daemon::Daemon(const std::string& socketPath, ConfigSetup& config, std::shared_ptr<RequestScheduler> scheduler,
+               std::shared_ptr<HttpSession> session)
+    : socketPath(socketPath), config(config), session(session ? std::move(session) : std::make_shared<HttpSession>()),
+      scheduler(scheduler ? std::move(scheduler) : std::make_shared<RequestScheduler>()), metricsIntervalSeconds(15),
+      dataVersion(-1), hasher(ConfigSetup::getKey()) {}
+
+void Daemon::setMetricsFile(const std::string& path, int intervalSeconds) {
+    metricsFile = path;
+    metricsIntervalSeconds = std::max(1, intervalSeconds);
+}
+
+void Daemon::setDedup(std::shared_ptr<IssueDedup> dedup) {
+    this->dedup = std::move(dedup);
+}
+
+void Daemon::setLabelResolver(std::shared_ptr<LabelResolver> labels) {
+    this->labels = std::move(labels);
+    if (this->labels) this->labels->setConfigMutex(&configMutex);
+}
+
+void Daemon::reloadIfChanged() {
+    long long version = config.getDataVersion();
+    if (version == dataVersion) return;
+
+    // Another process changed the config: drop cached tokens, they are re-read on demand
+    tokens.clear();
+    if (labels) labels->reloadAliases();
+    defaultOwner.clear();
+    defaultRepo.clear();
+    RepoConfig defConfig;
+    if (config.getDefaultRepoConfig(defConfig)) {
+        defaultOwner = defConfig.owner;
+        defaultRepo = defConfig.repo;
+    }
+    dataVersion = version;
+}
+
+const std::string* Daemon::lookupToken(const std::string& owner, const std::string& repo) {
+    std::string key = owner + "/" + repo;
+    auto it = tokens.find(key);
+    if (it != tokens.end()) return it->second.empty() ? nullptr : &it->second;
+
+    // Decrypt on first use only; an empty entry remembers a repo with no usable token
+    std::string token;
+    RepoConfig cfg;
+    if (config.getConfig(owner, repo, cfg)) {
+        try {
+            token = hasher.decrypt(cfg.encrypted_token);
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Failed to decrypt token for " << owner << "/" << repo << ": " << e.what() << std::endl;
+        }
+    }
+    it = tokens.emplace(key, token).first;
+    return it->second.empty() ? nullptr : &it->second;
+}
+
+bool Daemon::resolve(IssueRecord& record, std::string& error) {
+    std::unique_lock<std::mutex> lock(configMutex);
+    reloadIfChanged();
+
+    if (record.owner.empty()) record.owner = defaultOwner;
+    if (record.repo.empty()) record.repo = defaultRepo;
+    if (record.owner.empty() || record.repo.empty()) {
+        error = "No default repository config found, and some required fields are missing.";
+        return false;
+    }
+    if (record.token.empty()) {
+        const std::string* token = lookupToken(record.owner, record.repo);
+        if (!token && !defaultOwner.empty()) token = lookupToken(defaultOwner, defaultRepo);
+        if (!token) {
+            error = "No access token configured for " + record.owner + "/" + record.repo;
+            return false;
+        }
+        record.token = *token;
+    }
+    // Label sets may have to be fetched; other requests must not wait on that
+    lock.unlock();
+    return !labels || labels->resolve(record.owner, record.repo, record.token, record.labels, error);
+}
+
+bool Daemon::findDuplicate(const IssueRecord& record, IssueResult& result, std::shared_ptr<Creation>& creation) {
+    if (!dedup || dedup->getTtlSeconds() <= 0) return false;
+    uint64_t hash = IssueDedup::contentHash(record.owner, record.repo, record.title, record.body);
+
+    std::unique_lock<std::mutex> lock(configMutex);
+    for (;;) {
+        if (dedup->find(hash, result)) return true;
+        auto it = creating.find(hash);
+        if (it == creating.end()) break;
+        std::shared_ptr<Creation> pending = it->second;
+        pending->done.wait(lock, [&pending] { return pending->finished; });
+        if (pending->result.success) {
+            result = pending->result;
+            result.duplicate = true;
+            return true;
+        }
+        // It failed; this request tries itself unless another one already is
+    }
+    creation = std::make_shared<Creation>();
+    creation->hash = hash;
+    creating.emplace(hash, creation);
+    return false;
+}
+
+void Daemon::finishCreation(const IssueRecord& record, const IssueResult& result,
+                            const std::shared_ptr<Creation>& creation) {
+    if (!dedup) return;
+    std::lock_guard<std::mutex> lock(configMutex);
+    if (result.success) dedup->remember(record.owner, record.repo, record.title, record.body, record.labels, result);
+    if (creation) {
+        creation->finished = true;
+        creation->result = result;
+        creating.erase(creation->hash);
+        creation->done.notify_all();
+    }
+}
+
+std::string Daemon::handleRequest(const std::string& line) {
+    IssueRecord record;
+    IssueResult result;
+    std::string error;
+    std::shared_ptr<Creation> creation;
+
+    if (!BatchCreator::parseRecord(line, record, error) || !resolve(record, error)) {
+        result.error = error;
+    } else if (findDuplicate(record, result, creation)) {
+        // An identical issue was created within the TTL; result describes it
+    } else {
+        // The event loop keeps connections warm across requests; this thread just waits
+        result = client->submit({record.owner, record.repo, record.token, record.title, record.body, record.labels})
+                     .get();
+        finishCreation(record, result, creation);
+    }
+
+    JsonWriter writer(256);
+    writer.beginObject();
+    writer.key("ok").value(result.success);
+    writer.key("status").value((long long)result.status);
+    if (result.success) {
+        writer.key("id").value(result.id);
+        if (result.duplicate) writer.key("duplicate").value(true);
+        writer.field("number", result.number);
+        writer.field("html_url", result.htmlUrl);
+    } else {
+        writer.field("error", result.error);
+    }
+    writer.endObject();
+    return writer.take() + "\n";
+}
+
+void Daemon::serveConnection(Connection* connection) {
+    std::string buffer;
+    std::string line;
+    while (readLine(connection->fd, buffer, line)) {
+        if (line.empty()) continue;
+        if (!writeAll(connection->fd, handleRequest(line))) break;
+    }
+    // run() closes the socket after joining, so the fd is not reused while it may still be shut down
+    connection->done = true;
+}
+
+void Daemon::reapConnections(bool all) {
+    for (auto it = connections.begin(); it != connections.end();) {
+        Connection* connection = it->get();
+        if (!all && !connection->done) {
+            ++it;
+            continue;
+        }
+        connection->thread.join();
+        ::close(connection->fd);
+        it = connections.erase(it);
+    }
+}
+
+int Daemon::run() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    sockaddr_un addr;
+    if (!fillAddress(socketPath, addr)) {
+        std::cerr << "❌ Socket path too long: " << socketPath << std::endl;
+        return 1;
+    }
+
+    // Refuse to start twice; a leftover socket from a crashed daemon is replaced
+    int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0 && ::connect(probe, (sockaddr*)&addr, sizeof(addr)) == 0) {
+        ::close(probe);
+        std::cerr << "❌ A daemon is already running on " << socketPath << std::endl;
+        return 1;
+    }
+    if (probe >= 0) ::close(probe);
+    ::unlink(socketPath.c_str());
+
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t oldMask = ::umask(0077); // The socket hands out issues under the user's tokens
+    bool bound = listenFd >= 0 && ::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    ::umask(oldMask);
+    if (!bound || ::listen(listenFd, 128) != 0) {
+        std::cerr << "❌ Failed to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        if (listenFd >= 0) ::close(listenFd);
+        return 1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        reloadIfChanged();
+    }
+
+    client.reset(new IssueClient(std::max(1, scheduler->getOptions().maxConcurrency), session, scheduler));
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::cout << "🚀 gitee-issue daemon listening on " << socketPath << std::endl;
+
+    const RequestMetrics* metrics = metricsFile.empty() ? nullptr : session->getMetrics().get();
+    size_t metricsWritten = 0;
+    auto lastMetricsWrite = std::chrono::steady_clock::now();
+    if (metrics) metrics->writePrometheusFile(metricsFile);
+
+    while (!stopRequested) {
+        if (metrics && std::chrono::steady_clock::now() - lastMetricsWrite >= std::chrono::seconds(metricsIntervalSeconds)) {
+            lastMetricsWrite = std::chrono::steady_clock::now();
+            size_t transfers = metrics->getTransferCount();
+            if (transfers != metricsWritten && metrics->writePrometheusFile(metricsFile)) metricsWritten = transfers;
+        }
+
+        reapConnections(false);
+
+        pollfd pfd = {listenFd, POLLIN, 0};
+        if (::poll(&pfd, 1, 500) <= 0) continue;
+
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        connections.push_back(std::make_unique<Connection>());
+        Connection* connection = connections.back().get();
+        connection->fd = fd;
+        connection->thread = std::thread(&Daemon::serveConnection, this, connection);
+    }
+
+    // Stop reading so idle connections end, but let requests in progress
+    // finish and send their answer; nothing may outlive this object
+    for (const auto& connection : connections) {
+        ::shutdown(connection->fd, SHUT_RD);
+    }
+    reapConnections(true);
+    client.reset();
+
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    if (metrics) metrics->writePrometheusFile(metricsFile);
+    std::cout << "👋 Daemon stopped." << std::endl;
+    return 0;
+}
+
+namespace {
+
+// Reads the daemon's one-line JSON answer
+class ResponseHandler : public JsonHandler {
+public:
+    JsonTokenizer* tokenizer = nullptr;
+    IssueResult* result = nullptr;
+    std::string field;
+
+    bool onKey(const std::string& key) override {
+        field = key;
+        return tokenizer->depth() == 1;
+    }
+    void onString(const std::string& value) override {
+        if (field == "number") result->number = value;
+        else if (field == "html_url") result->htmlUrl = value;
+        else if (field == "error") result->error = value;
+    }
+    void onNumber(const std::string& text) override {
+        if (field == "id") result->id = std::strtoll(text.c_str(), nullptr, 10);
+        else if (field == "status") result->status = std::strtol(text.c_str(), nullptr, 10);
+    }
+    void onLiteral(const std::string& text) override {
+        if (field == "ok") result->success = text == "true";
+        else if (field == "duplicate") result->duplicate = text == "true";
+    }
+};
+
+} // namespace
+
+bool DaemonClient::createIssue(const std::string& socketPath, const IssueRecord& record, IssueResult& result) {
+    sockaddr_un addr;
+    if (!fillAddress(socketPath, addr)) return false;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    JsonWriter writer(256 + record.body.size());
+    writer.beginObject();
+    writer.field("title", record.title);
+    if (!record.body.empty()) writer.field("body", record.body);
+    if (!record.labels.empty()) writer.field("labels", record.labels);
+    if (!record.owner.empty()) writer.field("owner", record.owner);
+    if (!record.repo.empty()) writer.field("repo", record.repo);
+    if (!record.token.empty()) writer.field("token", record.token);
+    writer.endObject();
+
+    std::string buffer;
+    std::string line;
+    bool answered = writeAll(fd, writer.take() + "\n") && readLine(fd, buffer, line);
+    ::close(fd);
+
+    result = IssueResult();
+    if (!answered) {
+        result.error = "Daemon closed the connection";
+        return true;
+    }
+
+    ResponseHandler handler;
+    JsonTokenizer tokenizer(handler);
+    handler.tokenizer = &tokenizer;
+    handler.result = &result;
+    if (!tokenizer.feed(line.data(), line.size()) || !tokenizer.finish()) {
+        result.success = false;
+        result.error = "Invalid response from daemon";
+    }
+    return true;
+}
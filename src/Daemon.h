@@ -0,0 +1,118 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "BatchCreator.h"
+#include "ConfigSetup.h"
+#include "Hasher.h"
+#include "HttpSession.h"
+#include "IssueClient.h"
+#include "IssueDedup.h"
+#include "IssueResponseParser.h"
+#include "LabelResolver.h"
+#include "RequestScheduler.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Long-running server that creates issues on behalf of short-lived CLI calls.
+// It keeps the config database open, decrypted tokens cached and connections
+// warm, and accepts one JSON request per line on a Unix domain socket:
+//   -> {"owner": "...", "repo": "...", "title": "...", "body": "...", "labels": "...", "token": "..."}
+//   <- {"ok": true, "status": 201, "id": 123, "number": "I4ABCD", "html_url": "..."}
+// "duplicate": true marks an answer from the dedup index; nothing was created.
+// Only the title is required; the rest falls back to the configured repos.
+// Each connection is served by its own thread, but every issue is sent by one
+// IssueClient event loop, the only user of the session.
+class Daemon {
+public:
+    // A private session is created when none is passed
+    Daemon(const std::string& socketPath, ConfigSetup& config, std::shared_ptr<RequestScheduler> scheduler,
+           std::shared_ptr<HttpSession> session = nullptr);
+
+    // Rewrites the session's metrics to this Prometheus textfile while running
+    // (at most every intervalSeconds, when something changed) and on shutdown
+    void setMetricsFile(const std::string& path, int intervalSeconds = 15);
+
+    // Answers requests for issues created within the dedup TTL with the existing issue.
+    // An identical request that arrives while the first is still being created
+    // waits for it and gets its answer. dedup must use the same ConfigSetup;
+    // calls to it are serialized with configMutex.
+    void setDedup(std::shared_ptr<IssueDedup> dedup);
+
+    // Checks and rewrites the labels of each request; one with an unknown label
+    // is answered with the error. labels must use the same ConfigSetup; its
+    // calls to it are serialized with configMutex. It is called from every
+    // connection thread, so its session must not share connections.
+    void setLabelResolver(std::shared_ptr<LabelResolver> labels);
+
+    // Serves requests until SIGINT or SIGTERM, then lets requests in progress
+    // finish and answer before returning. Returns a process exit code.
+    int run();
+
+    static std::string defaultSocketPath(const std::string& configDir);
+
+private:
+    std::string socketPath;
+    ConfigSetup& config;
+    std::shared_ptr<HttpSession> session;
+    std::shared_ptr<RequestScheduler> scheduler;
+    std::shared_ptr<IssueDedup> dedup;
+    std::shared_ptr<LabelResolver> labels;
+    std::unique_ptr<IssueClient> client; // Exists while run() serves
+    std::string metricsFile;
+    int metricsIntervalSeconds;
+
+    std::mutex configMutex;                       // Guards config and the caches below
+    long long dataVersion;                        // Config DB version the caches were built from
+    std::map<std::string, std::string> tokens;    // "owner/repo" -> decrypted token ("" if none)
+    std::string defaultOwner;
+    std::string defaultRepo;
+    Hasher hasher;
+
+    // An issue being created, for identical requests to wait on
+    struct Creation {
+        uint64_t hash;
+        bool finished = false;
+        IssueResult result;
+        std::condition_variable done;
+    };
+    std::map<uint64_t, std::shared_ptr<Creation>> creating; // Content hash -> creation; guarded by configMutex
+
+    struct Connection {
+        int fd;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+    std::vector<std::unique_ptr<Connection>> connections; // Only touched by run()
+
+    void serveConnection(Connection* connection);
+    // Joins and closes finished connections, or all of them once their reads are shut down
+    void reapConnections(bool all);
+    std::string handleRequest(const std::string& line);
+
+    // Fills in owner/repo/token from the cached config. Returns false if none is configured.
+    bool resolve(IssueRecord& record, std::string& error);
+    // Returns true with result if the issue exists, waiting for an identical
+    // request in progress. Otherwise reserves the issue in creation (when dedup
+    // is on) for the caller to pass to finishCreation.
+    bool findDuplicate(const IssueRecord& record, IssueResult& result, std::shared_ptr<Creation>& creation);
+    void finishCreation(const IssueRecord& record, const IssueResult& result, const std::shared_ptr<Creation>& creation);
+    void reloadIfChanged();
+    const std::string* lookupToken(const std::string& owner, const std::string& repo);
+};
+
+// Forwards a create request to a running daemon
+class DaemonClient {
+public:
+    // Returns false if no daemon is listening on socketPath (the caller should
+    // then create the issue itself). On true, result holds the daemon's answer.
+    static bool createIssue(const std::string& socketPath, const IssueRecord& record, IssueResult& result);
+};
+
+#endif // DAEMON_H
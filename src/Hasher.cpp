@@ -1,96 +1,127 @@
 #include "Hasher.h"
+#include "Base64.h"
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 #include <openssl/err.h>
-#include <openssl/bio.h>
-#include <openssl/buffer.h>
+#include <climits>
 #include <cstring>
 #include <iostream>
+#include <stdexcept>
 
-Hasher::Hasher(const std::string& key) : key(key) {
+static const int BLOCK_SIZE = 16; // AES block size; CBC output grows by at most one block
+
+Hasher::Hasher(const std::string& key) : key(key), encryptCtx(nullptr), decryptCtx(nullptr) {
     iv = "0123456789abcdef";
-}
 
-std::string Hasher::base64Encode(const unsigned char* data, size_t len) {
-    BIO* bio, *b64;
-    BUF_MEM* bufferPtr;
-    b64 = BIO_new(BIO_f_base64());
-    bio = BIO_new(BIO_s_mem());
-    bio = BIO_push(b64, bio);
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL); 
-    BIO_write(bio, data, (int)len);
-    BIO_flush(bio);
-    BIO_get_mem_ptr(bio, &bufferPtr);
-    std::string result(bufferPtr->data, bufferPtr->length);
-    BIO_free_all(bio);
-    return result;
+    // Expand the key schedule once; later calls only reset the IV and state
+    encryptCtx = EVP_CIPHER_CTX_new();
+    decryptCtx = EVP_CIPHER_CTX_new();
+    if (!encryptCtx || !decryptCtx) {
+        EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)encryptCtx);
+        EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)decryptCtx);
+        throw std::runtime_error("EVP_CIPHER_CTX_new failed");
+    }
+    if (1 != EVP_EncryptInit_ex((EVP_CIPHER_CTX*)encryptCtx, EVP_aes_256_cbc(), NULL,
+                                (const unsigned char*)this->key.c_str(), (const unsigned char*)iv.c_str()) ||
+        1 != EVP_DecryptInit_ex((EVP_CIPHER_CTX*)decryptCtx, EVP_aes_256_cbc(), NULL,
+                                (const unsigned char*)this->key.c_str(), (const unsigned char*)iv.c_str())) {
+        EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)encryptCtx);
+        EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)decryptCtx);
+        throw std::runtime_error("EVP cipher init failed");
+    }
 }
 
-std::string Hasher::base64Decode(const std::string& input) {
-    BIO* bio, *b64;
-    int decodeLen = (int)input.length();
-    char* buffer = (char*)malloc(decodeLen);
-    memset(buffer, 0, decodeLen);
-
-    b64 = BIO_new(BIO_f_base64());
-    bio = BIO_new_mem_buf(input.c_str(), -1);
-    bio = BIO_push(b64, bio);
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-    int length = BIO_read(bio, buffer, decodeLen);
-    std::string result(buffer, length);
-    BIO_free_all(bio);
-    free(buffer);
-    return result;
+Hasher::~Hasher() {
+    EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)encryptCtx);
+    EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)decryptCtx);
 }
 
-std::string Hasher::encrypt(const std::string& plaintext) {
-    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) throw std::runtime_error("EVP_CIPHER_CTX_new failed");
-
-    int len;
-    int ciphertext_len;
-    unsigned char ciphertext[1024];
-
-    if (1 != EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, (const unsigned char*)key.c_str(), (const unsigned char*)iv.c_str()))
+void Hasher::beginEncrypt() {
+    if (1 != EVP_EncryptInit_ex((EVP_CIPHER_CTX*)encryptCtx, NULL, NULL, NULL, (const unsigned char*)iv.c_str()))
         throw std::runtime_error("EVP_EncryptInit_ex failed");
+}
 
-    if (1 != EVP_EncryptUpdate(ctx, ciphertext, &len, (const unsigned char*)plaintext.c_str(), (int)plaintext.length()))
-        throw std::runtime_error("EVP_EncryptUpdate failed");
+void Hasher::updateEncrypt(const char* data, size_t len, std::string& out) {
+    if (len > (size_t)INT_MAX - BLOCK_SIZE) throw std::runtime_error("Input too large");
 
-    ciphertext_len = len;
+    size_t start = out.size();
+    out.resize(start + len + BLOCK_SIZE);
+    int written = 0;
+    if (1 != EVP_EncryptUpdate((EVP_CIPHER_CTX*)encryptCtx, (unsigned char*)&out[start], &written,
+                               (const unsigned char*)data, (int)len)) {
+        out.resize(start);
+        throw std::runtime_error("EVP_EncryptUpdate failed");
+    }
+    out.resize(start + written);
+}
 
-    if (1 != EVP_EncryptFinal_ex(ctx, ciphertext + len, &len))
+void Hasher::finalEncrypt(std::string& out) {
+    size_t start = out.size();
+    out.resize(start + BLOCK_SIZE);
+    int written = 0;
+    if (1 != EVP_EncryptFinal_ex((EVP_CIPHER_CTX*)encryptCtx, (unsigned char*)&out[start], &written)) {
+        out.resize(start);
         throw std::runtime_error("EVP_EncryptFinal_ex failed");
-
-    ciphertext_len += len;
-    EVP_CIPHER_CTX_free(ctx);
-
-    return base64Encode(ciphertext, ciphertext_len);
+    }
+    out.resize(start + written);
 }
 
-std::string Hasher::decrypt(const std::string& ciphertext_base64) {
-    std::string ciphertext = base64Decode(ciphertext_base64);
-
-    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) throw std::runtime_error("EVP_CIPHER_CTX_new failed");
-
-    int len;
-    int plaintext_len;
-    unsigned char plaintext[1024];
-
-    if (1 != EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, (const unsigned char*)key.c_str(), (const unsigned char*)iv.c_str()))
+void Hasher::beginDecrypt() {
+    if (1 != EVP_DecryptInit_ex((EVP_CIPHER_CTX*)decryptCtx, NULL, NULL, NULL, (const unsigned char*)iv.c_str()))
         throw std::runtime_error("EVP_DecryptInit_ex failed");
+}
 
-    if (1 != EVP_DecryptUpdate(ctx, plaintext, &len, (const unsigned char*)ciphertext.c_str(), (int)ciphertext.length()))
-        throw std::runtime_error("EVP_DecryptUpdate failed");
+void Hasher::updateDecrypt(const char* data, size_t len, std::string& out) {
+    if (len > (size_t)INT_MAX - BLOCK_SIZE) throw std::runtime_error("Input too large");
 
-    plaintext_len = len;
+    size_t start = out.size();
+    out.resize(start + len + BLOCK_SIZE);
+    int written = 0;
+    if (1 != EVP_DecryptUpdate((EVP_CIPHER_CTX*)decryptCtx, (unsigned char*)&out[start], &written,
+                               (const unsigned char*)data, (int)len)) {
+        out.resize(start);
+        throw std::runtime_error("EVP_DecryptUpdate failed");
+    }
+    out.resize(start + written);
+}
 
-    if (1 != EVP_DecryptFinal_ex(ctx, plaintext + len, &len))
+void Hasher::finalDecrypt(std::string& out) {
+    size_t start = out.size();
+    out.resize(start + BLOCK_SIZE);
+    int written = 0;
+    if (1 != EVP_DecryptFinal_ex((EVP_CIPHER_CTX*)decryptCtx, (unsigned char*)&out[start], &written)) {
+        out.resize(start);
         throw std::runtime_error("EVP_DecryptFinal_ex failed");
+    }
+    out.resize(start + written);
+}
 
-    plaintext_len += len;
-    EVP_CIPHER_CTX_free(ctx);
+void Hasher::encrypt(const std::string& plaintext, std::string& out) {
+    scratch.clear();
+    beginEncrypt();
+    updateEncrypt(plaintext.data(), plaintext.size(), scratch);
+    finalEncrypt(scratch);
+    out.clear();
+    Base64::encode(scratch.data(), scratch.size(), out);
+}
 
-    return std::string((char*)plaintext, plaintext_len);
+void Hasher::decrypt(const std::string& ciphertext_base64, std::string& out) {
+    scratch.clear();
+    if (!Base64::decode(ciphertext_base64, scratch)) throw std::runtime_error("Invalid base64 input");
+    out.clear();
+    beginDecrypt();
+    updateDecrypt(scratch.data(), scratch.size(), out);
+    finalDecrypt(out);
+}
+
+std::string Hasher::encrypt(const std::string& plaintext) {
+    std::string out;
+    encrypt(plaintext, out);
+    return out;
+}
+
+std::string Hasher::decrypt(const std::string& ciphertext_base64) {
+    std::string out;
+    decrypt(ciphertext_base64, out);
+    return out;
 }
@@ -1,19 +1,45 @@
 #ifndef HASHER_H
 #define HASHER_H
 
+#include <cstddef>
 #include <string>
 
+// AES-256-CBC token encryption. The cipher contexts are created once and reset
+// between calls, so encrypting or verifying many tokens does not allocate per call.
+// Not thread-safe: use one Hasher per thread.
 class Hasher {
 public:
     Hasher(const std::string& key);
+    ~Hasher();
+
+    Hasher(const Hasher&) = delete;
+    Hasher& operator=(const Hasher&) = delete;
+
+    // One-shot helpers; ciphertext is base64-encoded
     std::string encrypt(const std::string& plaintext);
     std::string decrypt(const std::string& ciphertext_base64);
 
+    // Same as above, but write into out and reuse its capacity
+    void encrypt(const std::string& plaintext, std::string& out);
+    void decrypt(const std::string& ciphertext_base64, std::string& out);
+
+    // Streaming API over raw (not base64) ciphertext. Each update/final call
+    // appends its output to out. begin* may be called again at any time,
+    // which discards an unfinished stream.
+    void beginEncrypt();
+    void updateEncrypt(const char* data, size_t len, std::string& out);
+    void finalEncrypt(std::string& out);
+
+    void beginDecrypt();
+    void updateDecrypt(const char* data, size_t len, std::string& out);
+    void finalDecrypt(std::string& out); // Throws if the padding does not check out
+
 private:
     std::string key;
-    std::string iv; 
-    std::string base64Encode(const unsigned char* data, size_t len);
-    std::string base64Decode(const std::string& input);
+    std::string iv;
+    void* encryptCtx; // EVP_CIPHER_CTX*
+    void* decryptCtx; // EVP_CIPHER_CTX*
+    std::string scratch; // Raw ciphertext between base64 and the cipher
 };
 
 #endif
@@ -0,0 +1,114 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sub-bucket layout: the first 2 * HalfCount indexes hold values 0..255 exactly.
+// Every later group of HalfCount indexes covers one power of two.
+constexpr int SubBucketBits = 8;
+constexpr uint64_t HalfCount = (uint64_t)1 << (SubBucketBits - 1);
+
+} // namespace
+
+Histogram::Histogram() : count(0), sum(0), min(0), max(0) {}
+
+size_t Histogram::indexOf(uint64_t value) {
+    if (value < ((uint64_t)1 << SubBucketBits)) return (size_t)value;
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SubBucketBits + 1;
+    return (size_t)(shift * HalfCount + (value >> shift));
+}
+
+uint64_t Histogram::highestInBucket(size_t index) {
+    if (index < ((size_t)1 << SubBucketBits)) return index;
+    int shift = (int)(index / HalfCount) - 1;
+    uint64_t sub = index - shift * HalfCount;
+    if (shift + SubBucketBits >= 64) return UINT64_MAX;
+    return ((sub + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value, uint64_t n) {
+    if (n == 0) return;
+    size_t index = indexOf(value);
+    if (index >= counts.size()) counts.resize(index + 1, 0);
+    counts[index] += n;
+
+    min = count == 0 ? value : std::min(min, value);
+    max = std::max(max, value);
+    count += n;
+    sum += value * n;
+}
+
+void Histogram::merge(const Histogram& other) {
+    if (other.count == 0) return;
+    if (other.counts.size() > counts.size()) counts.resize(other.counts.size(), 0);
+    for (size_t i = 0; i < other.counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    min = count == 0 ? other.min : std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+    sum += other.sum;
+}
+
+void Histogram::reset() {
+    counts.clear();
+    count = 0;
+    sum = 0;
+    min = 0;
+    max = 0;
+}
+
+uint64_t Histogram::getCount() const {
+    return count;
+}
+
+uint64_t Histogram::getSum() const {
+    return sum;
+}
+
+uint64_t Histogram::getMin() const {
+    return min;
+}
+
+uint64_t Histogram::getMax() const {
+    return max;
+}
+
+double Histogram::getMean() const {
+    return count ? (double)sum / count : 0;
+}
+
+uint64_t Histogram::valueAtQuantile(double q) const {
+    if (count == 0) return 0;
+    q = std::min(1.0, std::max(0.0, q));
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(q * count));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            // The exact extremes are known, so never report past them
+            return std::max(min, std::min(max, highestInBucket(i)));
+        }
+    }
+    return max;
+}
+
+uint64_t Histogram::countAtOrBelow(uint64_t value) const {
+    if (value >= max) return count;
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size() && highestInBucket(i) <= value; ++i) {
+        total += counts[i];
+    }
+    return total;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> Histogram::buckets() const {
+    std::vector<std::pair<uint64_t, uint64_t>> result;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0) result.emplace_back(std::min(max, highestInBucket(i)), counts[i]);
+    }
+    return result;
+}
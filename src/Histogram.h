@@ -0,0 +1,50 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Log-linear histogram of non-negative integers in the style of HdrHistogram.
+// Values below 256 are counted exactly. Above that, each power of two is split
+// into 128 equal buckets, so every recorded value is known to within 0.8%,
+// whatever its magnitude. Memory grows with the largest value seen (about 1 KB
+// per power of two), not with the number of values recorded. Not thread-safe.
+class Histogram {
+public:
+    Histogram();
+
+    void record(uint64_t value, uint64_t count = 1);
+    void merge(const Histogram& other);
+    void reset();
+
+    uint64_t getCount() const;
+    uint64_t getSum() const;
+    uint64_t getMin() const; // 0 if empty
+    uint64_t getMax() const;
+    double getMean() const;
+
+    // Smallest value v such that at least q of the recorded values are <= v, to
+    // within the histogram's precision. q in [0, 1]; 0 if empty.
+    uint64_t valueAtQuantile(double q) const;
+
+    // Number of recorded values that are <= value, as used for Prometheus buckets.
+    // A bucket that straddles value is counted only if its upper bound is <= value.
+    uint64_t countAtOrBelow(uint64_t value) const;
+
+    // Non-empty buckets as (highest value in bucket, count), in ascending order
+    std::vector<std::pair<uint64_t, uint64_t>> buckets() const;
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+
+    static size_t indexOf(uint64_t value);
+    static uint64_t highestInBucket(size_t index);
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,277 @@
+#include "HttpPipeline.h"
+#include "HttpSession.h"
+#include <curl/curl.h>
+#include <algorithm>
+
+using Clock = RequestScheduler::Clock;
+
+struct HttpPipeline::Transfer {
+    HttpRequest request;
+    Callback onDone;
+    HttpResponse response;
+    CURL* easy = nullptr;
+    struct curl_slist* headers = nullptr;
+    int attempt = 0;
+    Clock::time_point notBefore;
+};
+
+static size_t PipelineWriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    HttpRequest* request = static_cast<HttpRequest*>(userp);
+    request->onData((const char*)contents, size * nmemb);
+    return size * nmemb;
+}
+
+static size_t PipelineBufferCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
+    userp->append((char*)contents, size * nmemb);
+    return size * nmemb;
+}
+
+static size_t PipelineHeaderCallback(char* buffer, size_t size, size_t nitems, HttpHeaders* headers) {
+    RequestScheduler::parseHeaderLine(buffer, size * nitems, *headers);
+    return size * nitems;
+}
+
+HttpPipeline::HttpPipeline(int maxInFlight, std::shared_ptr<HttpSession> session,
+                           std::shared_ptr<RequestScheduler> scheduler)
+    : session(session ? std::move(session) : std::make_shared<HttpSession>()),
+      scheduler(std::move(scheduler)),
+      multi(curl_multi_init()), maxInFlight(std::max(1, maxInFlight)) {
+    // Let libcurl keep enough connections around to reuse one per slot
+    curl_multi_setopt((CURLM*)multi, CURLMOPT_MAXCONNECTS, (long)this->maxInFlight);
+}
+
+HttpPipeline::~HttpPipeline() {
+    for (Transfer* t : active) {
+        curl_multi_remove_handle((CURLM*)multi, t->easy);
+        curl_easy_cleanup(t->easy);
+        curl_slist_free_all(t->headers);
+        delete t;
+    }
+    for (auto& key : queued) {
+        for (Transfer* t : key.second) {
+            delete t;
+        }
+    }
+    for (Transfer* t : delayed) {
+        delete t;
+    }
+    for (void* easy : idleHandles) {
+        curl_easy_cleanup((CURL*)easy);
+    }
+    curl_multi_cleanup((CURLM*)multi);
+}
+
+void HttpPipeline::submit(HttpRequest request, Callback onDone) {
+    Transfer* t = new Transfer();
+    t->request = std::move(request);
+    t->onDone = std::move(onDone);
+    enqueue(t, false);
+    startQueued();
+}
+
+void HttpPipeline::enqueue(Transfer* t, bool front) {
+    auto inserted = queued.try_emplace(t->request.rateKey);
+    std::deque<Transfer*>& q = inserted.first->second;
+    if (front) {
+        q.push_front(t);
+    } else {
+        q.push_back(t);
+    }
+    ++queuedCount;
+    // A key is in keyOrder exactly while it has queued requests; a retry's key goes first
+    if (inserted.second) {
+        if (front) {
+            keyOrder.push_front(&*inserted.first);
+        } else {
+            keyOrder.push_back(&*inserted.first);
+        }
+    }
+}
+
+void HttpPipeline::startQueued() {
+    Clock::time_point now = Clock::now();
+    nextWake = Clock::time_point();
+
+    // Retries whose backoff has elapsed go ahead of new work
+    for (auto it = delayed.begin(); it != delayed.end();) {
+        if ((*it)->notBefore <= now) {
+            Transfer* t = *it;
+            it = delayed.erase(it);
+            enqueue(t, true);
+        } else {
+            if (nextWake == Clock::time_point() || (*it)->notBefore < nextWake) nextWake = (*it)->notBefore;
+            ++it;
+        }
+    }
+
+    int limit = maxInFlight;
+    if (scheduler) limit = std::min(limit, scheduler->concurrencyLimit());
+
+    // Keys take turns, one request each. A paused key is set aside after one
+    // acquire, however much it has queued, and rejoins at the back.
+    std::vector<KeyQueue*> paused;
+    while (!keyOrder.empty() && (int)active.size() < limit) {
+        KeyQueue* key = keyOrder.front();
+        keyOrder.pop_front();
+        if (scheduler) {
+            Clock::time_point readyAt = scheduler->acquire(key->first);
+            if (readyAt != Clock::time_point()) {
+                if (nextWake == Clock::time_point() || readyAt < nextWake) nextWake = readyAt;
+                paused.push_back(key);
+                continue;
+            }
+        }
+        Transfer* t = key->second.front();
+        key->second.pop_front();
+        --queuedCount;
+        if (key->second.empty()) {
+            queued.erase(queued.find(key->first));
+        } else {
+            keyOrder.push_back(key);
+        }
+        // May run a callback that submits more work
+        start(t);
+    }
+    keyOrder.insert(keyOrder.end(), paused.begin(), paused.end());
+}
+
+void HttpPipeline::start(Transfer* t) {
+    CURL* easy;
+    if (!idleHandles.empty()) {
+        easy = (CURL*)idleHandles.back();
+        idleHandles.pop_back();
+        curl_easy_reset(easy);
+    } else {
+        easy = curl_easy_init();
+    }
+    if (!easy) {
+        t->response.error = "Failed to initialize curl";
+        if (t->onDone) t->onDone(t->response);
+        delete t;
+        return;
+    }
+    t->easy = easy;
+    session->attach(easy);
+
+    for (const std::string& h : t->request.headers) {
+        t->headers = curl_slist_append(t->headers, h.c_str());
+    }
+
+    curl_easy_setopt(easy, CURLOPT_URL, t->request.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, t->headers);
+    if (t->request.method == "POST") {
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, t->request.body.c_str());
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)t->request.body.size());
+    } else if (t->request.method != "GET") {
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, t->request.method.c_str());
+        if (!t->request.body.empty()) {
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, t->request.body.c_str());
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)t->request.body.size());
+        }
+    }
+    if (t->request.onData) {
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, PipelineWriteCallback);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, &t->request);
+    } else {
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, PipelineBufferCallback);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, &t->response.body);
+    }
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, PipelineHeaderCallback);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, &t->response.headers);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, t);
+
+    curl_multi_add_handle((CURLM*)multi, easy);
+    active.push_back(t);
+}
+
+void HttpPipeline::finish(void* easy, int result) {
+    Transfer* t = nullptr;
+    curl_easy_getinfo((CURL*)easy, CURLINFO_PRIVATE, (char**)&t);
+    curl_multi_remove_handle((CURLM*)multi, (CURL*)easy);
+
+    if (result != CURLE_OK) {
+        t->response.error = curl_easy_strerror((CURLcode)result);
+        t->response.failedBeforeSending = HttpSession::failedBeforeSending(result);
+    } else {
+        curl_easy_getinfo((CURL*)easy, CURLINFO_RESPONSE_CODE, &t->response.status);
+    }
+    session->recordTransfer(easy);
+
+    curl_slist_free_all(t->headers);
+    t->headers = nullptr;
+    t->easy = nullptr;
+    active.erase(std::find(active.begin(), active.end(), t));
+    idleHandles.push_back(easy);
+
+    if (scheduler) {
+        scheduler->onResponse(t->request.rateKey, t->response.status, t->response.headers);
+
+        std::chrono::milliseconds delay(0);
+        if (scheduler->shouldRetry(t->response.status, t->response.failedBeforeSending, t->attempt,
+                                   t->response.headers, delay)) {
+            ++t->attempt;
+            t->response = HttpResponse();
+            t->response.retries = t->attempt;
+            if (t->request.onRetry) t->request.onRetry();
+            t->notBefore = Clock::now() + delay;
+            delayed.push_back(t);
+            startQueued();
+            return;
+        }
+    }
+
+    if (const auto& metrics = session->getMetrics()) metrics->recordRequest(t->response.status, t->attempt);
+
+    // Refill the freed slot before running user code so the pipe stays full
+    startQueued();
+
+    if (t->onDone) t->onDone(t->response);
+    delete t;
+}
+
+bool HttpPipeline::runOnce(int timeoutMs) {
+    startQueued();
+    if (pending() == 0) return false;
+
+    int running = 0;
+    curl_multi_perform((CURLM*)multi, &running);
+
+    int msgsLeft = 0;
+    while (CURLMsg* msg = curl_multi_info_read((CURLM*)multi, &msgsLeft)) {
+        if (msg->msg == CURLMSG_DONE) {
+            finish(msg->easy_handle, msg->data.result);
+        }
+    }
+
+    if (pending() > 0) {
+        // Wake up in time for the next paced or retried request
+        int wait = timeoutMs;
+        if (nextWake != Clock::time_point()) {
+            auto untilWake = std::chrono::duration_cast<std::chrono::milliseconds>(nextWake - Clock::now()).count();
+            wait = (int)std::max<long long>(0, std::min<long long>(wait, untilWake + 1));
+        }
+        curl_multi_poll((CURLM*)multi, nullptr, 0, wait, nullptr);
+    }
+    return pending() > 0;
+}
+
+void HttpPipeline::run() {
+    while (runOnce()) {
+    }
+}
+
+void HttpPipeline::wakeup() {
+    curl_multi_wakeup((CURLM*)multi);
+}
+
+size_t HttpPipeline::pending() const {
+    return queuedCount + active.size() + delayed.size();
+}
+
+int HttpPipeline::getMaxInFlight() const {
+    return maxInFlight;
+}
+
+const std::shared_ptr<HttpSession>& HttpPipeline::getSession() const {
+    return session;
+}
@@ -0,0 +1,97 @@
+#ifndef HTTPPIPELINE_H
+#define HTTPPIPELINE_H
+
+#include "RequestScheduler.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct HttpRequest {
+    std::string method = "POST";
+    std::string url;
+    std::string body;
+    std::vector<std::string> headers;
+    // Receives the response body chunk by chunk instead of HttpResponse::body when set
+    std::function<void(const char*, size_t)> onData;
+    // Called before a retry is sent so onData consumers can drop the previous attempt
+    std::function<void()> onRetry;
+    // Requests with the same key share a rate limit (usually the access token)
+    std::string rateKey;
+};
+
+struct HttpResponse {
+    long status = 0;         // HTTP status code, 0 if the transfer failed
+    std::string body;
+    std::string error;       // Transport error message, empty on success
+    bool failedBeforeSending = false; // The transport error left the request unsent (see HttpSession)
+    HttpHeaders headers;
+    int retries = 0;         // Number of times the request was re-sent
+};
+
+class HttpSession;
+
+// Drives many HTTP requests concurrently through a single curl_multi handle.
+// Finished transfers are reported through their callbacks in completion order.
+// With a RequestScheduler, requests are paced per rate key, the number in
+// flight follows the scheduler's adaptive limit and throttled or failed
+// requests are retried before their callback runs. Requests of one rate key
+// start in submission order; keys take turns, and a paused key does not hold
+// up the others.
+class HttpPipeline {
+public:
+    using Callback = std::function<void(const HttpResponse&)>;
+
+    explicit HttpPipeline(int maxInFlight = 8, std::shared_ptr<HttpSession> session = nullptr,
+                          std::shared_ptr<RequestScheduler> scheduler = nullptr);
+    ~HttpPipeline();
+
+    HttpPipeline(const HttpPipeline&) = delete;
+    HttpPipeline& operator=(const HttpPipeline&) = delete;
+
+    // Queues a request; it is started as soon as an in-flight slot is free
+    void submit(HttpRequest request, Callback onDone);
+
+    // Performs pending transfers, waiting at most timeoutMs for activity.
+    // Returns true while requests are still queued or in flight.
+    bool runOnce(int timeoutMs = 100);
+
+    // Runs until every submitted request has completed
+    void run();
+
+    // Makes a runOnce that is waiting for activity return early. The only
+    // method that may be called from another thread.
+    void wakeup();
+
+    // Number of requests queued or in flight
+    size_t pending() const;
+
+    int getMaxInFlight() const;
+
+    const std::shared_ptr<HttpSession>& getSession() const;
+
+private:
+    struct Transfer;
+
+    std::shared_ptr<HttpSession> session;
+    std::shared_ptr<RequestScheduler> scheduler;
+    void* multi;
+    int maxInFlight;
+    using KeyQueue = std::pair<const std::string, std::deque<Transfer*>>;
+    std::unordered_map<std::string, std::deque<Transfer*>> queued; // By rate key, never empty
+    std::deque<KeyQueue*> keyOrder; // Keys of queued, next to start first
+    size_t queuedCount = 0;
+    std::vector<Transfer*> active;
+    std::vector<Transfer*> delayed;      // Waiting for their retry time
+    RequestScheduler::Clock::time_point nextWake; // Earliest time a blocked request may start
+    std::vector<void*> idleHandles; // Easy handles kept for reuse
+
+    void enqueue(Transfer* t, bool front);
+    void startQueued();
+    void start(Transfer* t);
+    void finish(void* easy, int result);
+};
+
+#endif // HTTPPIPELINE_H
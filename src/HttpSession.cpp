@@ -0,0 +1,69 @@
+#include "HttpSession.h"
+#include <curl/curl.h>
+
+HttpSession::HttpSession(bool shareConnections) : share(curl_share_init()) {
+    CURLSH* sh = (CURLSH*)share;
+    curl_share_setopt(sh, CURLSHOPT_LOCKFUNC, (curl_lock_function)&HttpSession::lockCallback);
+    curl_share_setopt(sh, CURLSHOPT_UNLOCKFUNC, (curl_unlock_function)&HttpSession::unlockCallback);
+    curl_share_setopt(sh, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    if (shareConnections) curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+}
+
+HttpSession::~HttpSession() {
+    curl_share_cleanup((CURLSH*)share);
+}
+
+void HttpSession::lockCallback(void*, int data, int, void* userptr) {
+    HttpSession* self = static_cast<HttpSession*>(userptr);
+    self->locks[data % 8].lock();
+}
+
+void HttpSession::unlockCallback(void*, int data, void* userptr) {
+    HttpSession* self = static_cast<HttpSession*>(userptr);
+    self->locks[data % 8].unlock();
+}
+
+void HttpSession::attach(void* easy) {
+    curl_easy_setopt((CURL*)easy, CURLOPT_SHARE, (CURLSH*)share);
+    // Keep idle connections alive so the next request skips the handshake
+    curl_easy_setopt((CURL*)easy, CURLOPT_TCP_KEEPALIVE, 1L);
+}
+
+void HttpSession::recordTransfer(void* easy) {
+    long connects = 0;
+    curl_easy_getinfo((CURL*)easy, CURLINFO_NUM_CONNECTS, &connects);
+    ++requests;
+    if (connects > 0) {
+        newConnections += (size_t)connects;
+    } else {
+        ++reusedConnections;
+    }
+    if (metrics) metrics->recordTransfer(easy);
+}
+
+bool HttpSession::failedBeforeSending(int curlCode) {
+    return curlCode == CURLE_COULDNT_RESOLVE_HOST || curlCode == CURLE_COULDNT_RESOLVE_PROXY ||
+           curlCode == CURLE_COULDNT_CONNECT;
+}
+
+void HttpSession::setMetrics(std::shared_ptr<RequestMetrics> metrics) {
+    this->metrics = std::move(metrics);
+}
+
+const std::shared_ptr<RequestMetrics>& HttpSession::getMetrics() const {
+    return metrics;
+}
+
+size_t HttpSession::getRequestCount() const {
+    return requests;
+}
+
+size_t HttpSession::getNewConnectionCount() const {
+    return newConnections;
+}
+
+size_t HttpSession::getHandshakesAvoided() const {
+    return reusedConnections;
+}
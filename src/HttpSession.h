@@ -0,0 +1,53 @@
+#ifndef HTTPSESSION_H
+#define HTTPSESSION_H
+
+#include "RequestMetrics.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Owns a CURLSH share object so every handle in a run reuses the same DNS
+// cache, connection pool and TLS sessions. libcurl does not support sharing
+// connections between threads that transfer at the same time, so a session
+// may only be used by one thread at a time. One made without shareConnections
+// shares only DNS and TLS sessions and may be used by several threads at once.
+class HttpSession {
+public:
+    explicit HttpSession(bool shareConnections = true);
+    ~HttpSession();
+
+    HttpSession(const HttpSession&) = delete;
+    HttpSession& operator=(const HttpSession&) = delete;
+
+    // Attaches the shared caches to a CURL easy handle
+    void attach(void* easy);
+
+    // Records connection statistics of a finished transfer on the given easy handle
+    void recordTransfer(void* easy);
+
+    // True for a CURLcode that means no part of the request reached the server
+    // (name resolution or connect failed), so sending it again cannot duplicate it
+    static bool failedBeforeSending(int curlCode);
+
+    // Optional per-phase timings of every transfer; set before the session is used
+    void setMetrics(std::shared_ptr<RequestMetrics> metrics);
+    const std::shared_ptr<RequestMetrics>& getMetrics() const;
+
+    size_t getRequestCount() const;
+    size_t getNewConnectionCount() const;
+    // Requests that went out on an already open connection, i.e. without a new TCP/TLS handshake
+    size_t getHandshakesAvoided() const;
+
+private:
+    void* share;
+    std::mutex locks[8]; // One per curl_lock_data kind
+    std::atomic<size_t> requests{0};
+    std::atomic<size_t> newConnections{0};
+    std::atomic<size_t> reusedConnections{0};
+    std::shared_ptr<RequestMetrics> metrics;
+
+    static void lockCallback(void* handle, int data, int access, void* userptr);
+    static void unlockCallback(void* handle, int data, void* userptr);
+};
+
+#endif // HTTPSESSION_H
@@ -0,0 +1,175 @@
+#include "IssueClient.h"
+#include "HttpPipeline.h"
+#include "HttpSession.h"
+#include "IssueCreator.h"
+#include "IssueUpdater.h"
+#include "JsonWriter.h"
+#include "RequestScheduler.h"
+#include <curl/curl.h>
+#include <algorithm>
+
+struct IssueClient::Job {
+    HttpRequest request;
+    std::shared_ptr<IssueResponseParser> parser;
+    std::shared_ptr<std::promise<IssueResult>> promise;
+    Callback onDone;
+    long expectedStatus = 201;
+};
+
+namespace {
+
+// The scheduler's default window of 8 would leave most of maxInFlight unused.
+// Start fully open; the window still halves as soon as the server pushes back.
+std::shared_ptr<RequestScheduler> defaultScheduler(int maxInFlight) {
+    RequestScheduler::Options options;
+    options.maxConcurrency = std::max(1, maxInFlight);
+    options.initialConcurrency = options.maxConcurrency;
+    return std::make_shared<RequestScheduler>(options);
+}
+
+} // namespace
+
+IssueClient::IssueClient(int maxInFlight, std::shared_ptr<HttpSession> session,
+                         std::shared_ptr<RequestScheduler> scheduler)
+    : session(session ? std::move(session) : std::make_shared<HttpSession>()),
+      scheduler(scheduler ? std::move(scheduler) : defaultScheduler(maxInFlight)),
+      stopping(false), outstanding(0) {
+    // Reference counted, so this is harmless if the application already did it
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    pipeline.reset(new HttpPipeline(maxInFlight, this->session, this->scheduler));
+    loopThread = std::thread(&IssueClient::loop, this);
+}
+
+IssueClient::~IssueClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    pipeline->wakeup();
+    loopThread.join();
+    pipeline.reset();
+    curl_global_cleanup();
+}
+
+namespace {
+
+std::future<IssueResult> failNow(const std::string& error, const IssueClient::Callback& onDone) {
+    std::promise<IssueResult> promise;
+    IssueResult result;
+    result.error = error;
+    if (onDone) onDone(result);
+    promise.set_value(std::move(result));
+    return promise.get_future();
+}
+
+} // namespace
+
+std::future<IssueResult> IssueClient::submit(IssueRequest request, Callback onDone) {
+    if (request.owner.empty() || request.repo.empty() || request.token.empty() || request.title.empty()) {
+        return failNow("owner, repo, token and title are required", onDone);
+    }
+
+    Job job;
+    JsonWriter writer;
+    IssueCreator::buildRequestBody(writer, request.token, request.repo, request.title, request.body, request.labels);
+    job.request.url = IssueCreator::issuesUrl(request.owner);
+    job.request.body = writer.take();
+    job.request.headers.push_back("Content-Type: application/json;charset=UTF-8");
+    job.request.rateKey = std::move(request.token);
+    return enqueue(std::move(job), std::move(onDone));
+}
+
+std::future<IssueResult> IssueClient::update(const std::string& number, IssueRequest request, Callback onDone) {
+    if (request.owner.empty() || request.repo.empty() || request.token.empty() || request.title.empty() ||
+        number.empty()) {
+        return failNow("owner, repo, token, title and number are required", onDone);
+    }
+
+    IssueChanges changes;
+    changes.title = std::move(request.title);
+    changes.body = std::move(request.body);
+    if (!request.labels.empty()) changes.labels = std::move(request.labels);
+
+    Job job;
+    JsonWriter writer;
+    IssueUpdater::buildRequestBody(writer, request.token, request.repo, changes);
+    job.request.method = "PATCH";
+    job.request.url = IssueUpdater::issueUrl(request.owner, number);
+    job.request.body = writer.take();
+    job.request.headers.push_back("Content-Type: application/json;charset=UTF-8");
+    job.request.rateKey = std::move(request.token);
+    job.expectedStatus = 200;
+    return enqueue(std::move(job), std::move(onDone));
+}
+
+std::future<IssueResult> IssueClient::enqueue(Job job, Callback onDone) {
+    auto promise = std::make_shared<std::promise<IssueResult>>();
+    std::future<IssueResult> future = promise->get_future();
+
+    // The response is parsed as it arrives; only the fields we need are kept
+    auto parser = std::make_shared<IssueResponseParser>();
+    job.request.onData = [parser](const char* data, size_t len) { parser->feed(data, len); };
+    job.request.onRetry = [parser]() { parser->reset(); };
+    job.parser = std::move(parser);
+    job.promise = std::move(promise);
+    job.onDone = std::move(onDone);
+
+    ++outstanding;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        incoming.push_back(std::move(job));
+    }
+    // One of the two is waiting: the condition when idle, curl_multi_poll when busy
+    wake.notify_one();
+    pipeline->wakeup();
+    return future;
+}
+
+void IssueClient::loop() {
+    std::vector<Job> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return !incoming.empty() || stopping || pipeline->pending() > 0; });
+            if (incoming.empty() && stopping && pipeline->pending() == 0) return;
+            batch.swap(incoming);
+        }
+
+        for (Job& job : batch) {
+            pipeline->submit(std::move(job.request), [this, parser = std::move(job.parser),
+                                                      promise = std::move(job.promise), onDone = std::move(job.onDone),
+                                                      expectedStatus = job.expectedStatus](const HttpResponse& response) {
+                IssueResult result;
+                result.status = response.status;
+                result.retries = response.retries;
+                if (!response.error.empty()) {
+                    result.error = "Curl error: " + response.error;
+                } else if (response.status != expectedStatus) {
+                    result.error = "HTTP " + std::to_string(response.status) + ": " + parser->getSnippet();
+                } else {
+                    result.success = true;
+                    parser->fill(result);
+                }
+                if (onDone) onDone(result);
+                promise->set_value(std::move(result));
+                --outstanding;
+            });
+        }
+        batch.clear();
+
+        pipeline->runOnce();
+    }
+}
+
+size_t IssueClient::pending() const {
+    return outstanding.load();
+}
+
+const std::shared_ptr<HttpSession>& IssueClient::getSession() const {
+    return session;
+}
+
+const std::shared_ptr<RequestScheduler>& IssueClient::getScheduler() const {
+    return scheduler;
+}
@@ -0,0 +1,94 @@
+#ifndef ISSUECLIENT_H
+#define ISSUECLIENT_H
+
+#include "IssueResponseParser.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class HttpPipeline;
+class HttpSession;
+class RequestScheduler;
+
+// One issue to create
+struct IssueRequest {
+    std::string owner;
+    std::string repo;
+    std::string token;
+    std::string title;
+    std::string body;
+    std::string labels; // Comma-separated
+};
+
+// Creates issues asynchronously, for programs that embed the library instead of
+// running the CLI. Any thread may submit; all requests are driven by a single
+// event-loop thread through one HttpPipeline (curl_multi), so thousands of
+// outstanding issues cost memory, not threads. Requests are paced and retried
+// by the RequestScheduler, as in --batch.
+//
+//   IssueClient client;
+//   std::future<IssueResult> done = client.submit({"owner", "repo", token, "Title", "Body", "bug"});
+//   if (done.get().success) ...
+class IssueClient {
+public:
+    // Runs on the event-loop thread when an issue is done, before its future is
+    // made ready. It must not block or throw; it may submit further issues.
+    using Callback = std::function<void(const IssueResult&)>;
+
+    // At most maxInFlight requests are sent at a time; the rest wait in a queue.
+    // A private session and scheduler are created when none are passed. A
+    // session passed in is used by the event-loop thread and must not be used
+    // by other threads while the client runs (see HttpSession).
+    explicit IssueClient(int maxInFlight = 64, std::shared_ptr<HttpSession> session = nullptr,
+                         std::shared_ptr<RequestScheduler> scheduler = nullptr);
+
+    // Waits for every submitted issue to finish, then stops the event loop
+    ~IssueClient();
+
+    IssueClient(const IssueClient&) = delete;
+    IssueClient& operator=(const IssueClient&) = delete;
+
+    // Queues an issue and returns at once. The payload is built on the calling
+    // thread. A request without owner, repo, token or title fails right away,
+    // with onDone run on the calling thread.
+    std::future<IssueResult> submit(IssueRequest request, Callback onDone = nullptr);
+
+    // Queues an edit of an existing issue (e.g. "I4ABCD") in request's repo,
+    // setting its title and body, and its labels unless empty. Fails right away
+    // like submit without owner, repo, token, title or number.
+    std::future<IssueResult> update(const std::string& number, IssueRequest request, Callback onDone = nullptr);
+
+    // Issues submitted and not finished yet
+    size_t pending() const;
+
+    const std::shared_ptr<HttpSession>& getSession() const;
+    const std::shared_ptr<RequestScheduler>& getScheduler() const;
+
+private:
+    struct Job; // A built request waiting for the event loop
+
+    // Adds response parsing to job and hands it to the event loop
+    std::future<IssueResult> enqueue(Job job, Callback onDone);
+
+    std::shared_ptr<HttpSession> session;
+    std::shared_ptr<RequestScheduler> scheduler;
+    std::unique_ptr<HttpPipeline> pipeline; // Only touched by the event-loop thread, except wakeup()
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Job> incoming; // Guarded by mutex
+    bool stopping;             // Guarded by mutex
+    std::atomic<size_t> outstanding;
+
+    std::thread loopThread;
+
+    void loop();
+};
+
+#endif // ISSUECLIENT_H
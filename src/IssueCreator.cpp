@@ -1,83 +1,346 @@
 #include "IssueCreator.h"
+#include "HttpSession.h"
 #include <curl/curl.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <regex>
+#include <thread>
 
-IssueCreator::IssueCreator(const std::string& owner, const std::string& repo, const std::string& token)
-    : owner(owner), repo(repo), token(token), lastIssueId(-1) {}
+namespace {
 
-size_t IssueCreator::WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
-    userp->append((char*)contents, size * nmemb);
+// Raw body bytes escaped per read callback; bounds the pending buffer at six times this
+const size_t EscapeChunk = 64 * 1024;
+
+// Produces {"access_token":...,"body":"<escaped body>","labels":...} on demand.
+// Only the current chunk of the body is ever held in escaped form.
+class BodyStream {
+public:
+    BodyStream(std::string head, const BodyParts& parts, std::string tail)
+        : head(std::move(head)), parts(parts), tail(std::move(tail)) {
+        rewind();
+    }
+
+    size_t contentLength() const {
+        size_t total = head.size() + tail.size();
+        for (std::string_view part : parts) total += JsonWriter::escapedSize(part.data(), part.size());
+        return total;
+    }
+
+    // Starts over from the first byte, for a retry or a resend on a new connection
+    void rewind() {
+        headPos = 0;
+        tailPos = 0;
+        part = 0;
+        offset = 0;
+        pending.clear();
+        pendingPos = 0;
+    }
+
+    size_t read(char* out, size_t max) {
+        size_t written = 0;
+        while (written < max) {
+            if (headPos < head.size()) {
+                written += copy(head, headPos, out + written, max - written);
+            } else if (pendingPos < pending.size()) {
+                written += copy(pending, pendingPos, out + written, max - written);
+            } else if (part < parts.size()) {
+                std::string_view current = parts[part];
+                size_t n = std::min(EscapeChunk, current.size() - offset);
+                pending.clear();
+                pendingPos = 0;
+                JsonWriter::appendEscaped(pending, current.data() + offset, n);
+                offset += n;
+                if (offset == current.size()) {
+                    ++part;
+                    offset = 0;
+                }
+            } else if (tailPos < tail.size()) {
+                written += copy(tail, tailPos, out + written, max - written);
+            } else {
+                break;
+            }
+        }
+        return written;
+    }
+
+private:
+    std::string head;
+    const BodyParts& parts;
+    std::string tail;
+    size_t headPos;
+    size_t tailPos;
+    size_t part;
+    size_t offset;
+    std::string pending; // Escaped form of the chunk being sent
+    size_t pendingPos;
+
+    static size_t copy(const std::string& from, size_t& pos, char* out, size_t max) {
+        size_t n = std::min(max, from.size() - pos);
+        std::memcpy(out, from.data() + pos, n);
+        pos += n;
+        return n;
+    }
+};
+
+} // namespace
+
+IssueCreator::IssueCreator(const std::string& owner, const std::string& repo, const std::string& token,
+                           std::shared_ptr<HttpSession> session)
+    : owner(owner), repo(repo), token(token),
+      session(session ? std::move(session) : std::make_shared<HttpSession>()),
+      scheduler(std::make_shared<RequestScheduler>()), curl(nullptr) {}
+
+IssueCreator::~IssueCreator() {
+    if (curl) {
+        curl_easy_cleanup((CURL*)curl);
+    }
+}
+
+size_t IssueCreator::WriteCallback(void* contents, size_t size, size_t nmemb, IssueResponseParser* userp) {
+    userp->feed((const char*)contents, size * nmemb);
     return size * nmemb;
 }
 
-int IssueCreator::extractIssueIdFromResponse(const std::string& response) {
-    // Simple regex to extract "id": number from JSON response
-    std::regex idPattern("\"id\"\\s*:\\s*(\\d+)");
-    std::smatch match;
-    
-    if (std::regex_search(response, match, idPattern)) {
-        return std::stoi(match[1].str());
-    }
-    
-    return -1;
+size_t IssueCreator::HeaderCallback(char* buffer, size_t size, size_t nitems, HttpHeaders* userp) {
+    RequestScheduler::parseHeaderLine(buffer, size * nitems, *userp);
+    return size * nitems;
 }
 
-bool IssueCreator::createIssue(const std::string& title, const std::string& body, const std::string& labels) {
-    std::string url = "https://gitee.com/api/v5/repos/" + owner + "/issues";
+size_t IssueCreator::ReadCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    return ((BodyStream*)userp)->read(buffer, size * nitems);
+}
+
+int IssueCreator::SeekCallback(void* userp, long long offset, int origin) {
+    // libcurl only rewinds to the start, when it has to send the request again
+    if (offset != 0 || origin != SEEK_SET) return CURL_SEEKFUNC_CANTSEEK;
+    ((BodyStream*)userp)->rewind();
+    return CURL_SEEKFUNC_OK;
+}
+
+static std::string& apiBaseUrl() {
+    static std::string url = [] {
+        const char* env = std::getenv("GITEE_API_URL");
+        std::string base = env && *env ? env : "https://gitee.com/api/v5";
+        while (!base.empty() && base.back() == '/') base.pop_back();
+        return base;
+    }();
+    return url;
+}
+
+const std::string& IssueCreator::getApiBaseUrl() {
+    return apiBaseUrl();
+}
+
+void IssueCreator::setApiBaseUrl(const std::string& url) {
+    std::string& base = apiBaseUrl();
+    base = url;
+    while (!base.empty() && base.back() == '/') base.pop_back();
+}
+
+std::string IssueCreator::issuesUrl(const std::string& owner) {
+    return apiBaseUrl() + "/repos/" + owner + "/issues";
+}
+
+std::string IssueCreator::urlEncode(const std::string& text) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(text.size() * 3);
+    for (unsigned char c : text) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_' ||
+            c == '.' || c == '~') {
+            out += (char)c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
+}
 
-    std::string jsonStr = "{";
-    jsonStr += "\"access_token\":\"" + token + "\",";
-    jsonStr += "\"repo\":\"" + repo + "\",";
-    jsonStr += "\"title\":\"" + title + "\"";
+void IssueCreator::buildRequestBody(JsonWriter& out, const std::string& token, const std::string& repo,
+                                    const std::string& title, std::string_view body,
+                                    const std::string& labels) {
+    out.clear();
+    out.reserve(64 + token.size() + repo.size() + title.size() + body.size() + labels.size());
+    out.beginObject();
+    out.field("access_token", token);
+    out.field("repo", repo);
+    out.field("title", title);
 
     if (!body.empty()) {
-        jsonStr += ",\"body\":\"" + body + "\"";
+        out.field("body", body);
     }
     if (!labels.empty()) {
-        jsonStr += ",\"labels\":\"" + labels + "\"";
+        out.field("labels", labels);
+    }
+    out.endObject();
+}
+
+void IssueCreator::buildRequestBody(JsonWriter& out, const std::string& token, const std::string& repo,
+                                    const std::string& title, const IssueTemplate& body,
+                                    const IssueTemplate::Values& values, const std::string& labels) {
+    size_t bodySize = body.renderedSize(values);
+    out.clear();
+    out.reserve(64 + token.size() + repo.size() + title.size() + bodySize + bodySize / 8 + labels.size());
+    out.beginObject();
+    out.field("access_token", token);
+    out.field("repo", repo);
+    out.field("title", title);
+
+    if (bodySize > 0) {
+        out.key("body");
+        body.render(out, values);
+    }
+    if (!labels.empty()) {
+        out.field("labels", labels);
+    }
+    out.endObject();
+}
+
+bool IssueCreator::createIssue(const std::string& title, const std::string& body, const std::string& labels) {
+    return createIssue(title, BodyParts{body}, labels);
+}
+
+bool IssueCreator::createIssue(const std::string& title, const BodyParts& body, const std::string& labels) {
+    std::string url = issuesUrl(owner);
+    lastResult = IssueResult();
+
+    size_t bodyBytes = bodySize(body);
+    std::unique_ptr<BodyStream> stream;
+    if (bodyBytes < StreamThreshold) {
+        if (body.size() <= 1) {
+            buildRequestBody(requestBody, token, repo, title, body.empty() ? std::string_view() : body[0], labels);
+        } else {
+            std::string joined;
+            joined.reserve(bodyBytes);
+            for (std::string_view part : body) joined.append(part.data(), part.size());
+            buildRequestBody(requestBody, token, repo, title, joined, labels);
+        }
+    } else {
+        // Everything but the body goes through JsonWriter as usual; the body is spliced in while sending
+        buildRequestBody(requestBody, token, repo, title, std::string_view(), "");
+        std::string head(requestBody.data(), requestBody.size() - 1);
+        head += ",\"body\":\"";
+        std::string tail = "\"";
+        if (!labels.empty()) {
+            tail += ",\"labels\":\"";
+            JsonWriter::appendEscaped(tail, labels.data(), labels.size());
+            tail += "\"";
+        }
+        tail += "}";
+        stream.reset(new BodyStream(std::move(head), body, std::move(tail)));
     }
-    jsonStr += "}";
 
-    CURL* curl = curl_easy_init();
     if (!curl) {
-        std::cerr << "❌ Failed to initialize curl!" << std::endl;
-        return false;
+        curl = curl_easy_init();
+        if (!curl) {
+            std::cerr << "❌ Failed to initialize curl!" << std::endl;
+            return false;
+        }
+        session->attach(curl);
     }
 
     struct curl_slist* headers = nullptr;
     headers = curl_slist_append(headers, "Content-Type: application/json;charset=UTF-8");
 
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (stream) {
+        // No 100-continue round trip: an error is seen in the response either way
+        headers = curl_slist_append(headers, "Expect:");
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, nullptr);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)stream->contentLength());
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, ReadCallback);
+        curl_easy_setopt(curl, CURLOPT_READDATA, stream.get());
+        curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, SeekCallback);
+        curl_easy_setopt(curl, CURLOPT_SEEKDATA, stream.get());
+    } else {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requestBody.data());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)requestBody.size());
+    }
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonStr.c_str());
-
-    std::string response_string;
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+
+    CURLcode res;
+    long response_code;
+    IssueResponseParser parser;
+    for (int attempt = 0;; ++attempt) {
+        // Wait for the token's rate limit before sending
+        for (auto readyAt = scheduler->acquire(token); readyAt != RequestScheduler::Clock::time_point();
+             readyAt = scheduler->acquire(token)) {
+            std::this_thread::sleep_until(readyAt);
+        }
 
-    CURLcode res = curl_easy_perform(curl);
-    long response_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+        parser.reset();
+        if (stream) stream->rewind();
+        HttpHeaders responseHeaders;
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &parser);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &responseHeaders);
 
+        res = curl_easy_perform(curl);
+        response_code = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+        session->recordTransfer(curl);
+        scheduler->onResponse(token, response_code, responseHeaders);
+
+        std::chrono::milliseconds delay(0);
+        if (!scheduler->shouldRetry(response_code, HttpSession::failedBeforeSending(res), attempt, responseHeaders, delay)) {
+            lastResult.retries = attempt;
+            break;
+        }
+        std::this_thread::sleep_for(delay);
+    }
+
+    // Drop per-request pointers; the handle and its open connection stay alive
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, nullptr);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, nullptr);
+    if (stream) {
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, nullptr);
+        curl_easy_setopt(curl, CURLOPT_READDATA, nullptr);
+        curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, nullptr);
+        curl_easy_setopt(curl, CURLOPT_SEEKDATA, nullptr);
+    }
     curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
 
+    lastResult.status = response_code;
+    if (const auto& metrics = session->getMetrics()) metrics->recordRequest(response_code, lastResult.retries);
     if (res != CURLE_OK) {
-        std::cerr << "❌ Curl error: " << curl_easy_strerror(res) << std::endl;
+        lastResult.error = std::string("Curl error: ") + curl_easy_strerror(res);
+        std::cerr << "❌ " << lastResult.error << std::endl;
         return false;
     }
     
     if (response_code == 201) {
-        // Extract issue ID from response
-        lastIssueId = extractIssueIdFromResponse(response_string);
+        parser.fill(lastResult);
+        lastResult.success = true;
         return true;
     } else {
-        std::cerr << "❌ Failed: HTTP " << response_code << "\n" << response_string << std::endl;
+        lastResult.error = "HTTP " + std::to_string(response_code) + "\n" + parser.getSnippet();
+        std::cerr << "❌ Failed: " << lastResult.error << std::endl;
         return false;
     }
 }
 
 int IssueCreator::getLastIssueId() const {
-    return lastIssueId;
+    return (int)lastResult.id;
+}
+
+const IssueResult& IssueCreator::getLastResult() const {
+    return lastResult;
+}
+
+const std::shared_ptr<HttpSession>& IssueCreator::getSession() const {
+    return session;
+}
+
+void IssueCreator::setScheduler(std::shared_ptr<RequestScheduler> scheduler) {
+    if (scheduler) this->scheduler = std::move(scheduler);
+}
+
+const std::shared_ptr<RequestScheduler>& IssueCreator::getScheduler() const {
+    return scheduler;
 }
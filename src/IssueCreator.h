@@ -1,28 +1,80 @@
 #ifndef ISSUECREATOR_H
 #define ISSUECREATOR_H
 
+#include "BodyFile.h"
+#include "IssueResponseParser.h"
+#include "IssueTemplate.h"
+#include "JsonWriter.h"
+#include "RequestScheduler.h"
+#include <memory>
 #include <string>
 
+class HttpSession;
+
 class IssueCreator {
 public:
-    IssueCreator(const std::string& owner, const std::string& repo, const std::string& token);
+    // Requests share the given session's DNS, connection and TLS caches.
+    // A private session is created when none is passed.
+    IssueCreator(const std::string& owner, const std::string& repo, const std::string& token,
+                 std::shared_ptr<HttpSession> session = nullptr);
+    ~IssueCreator();
+
+    IssueCreator(const IssueCreator&) = delete;
+    IssueCreator& operator=(const IssueCreator&) = delete;
 
-    // Returns true if successful, false otherwise. Issue ID is stored internally.
+    // Returns true if successful, false otherwise. The outcome is stored internally.
     bool createIssue(const std::string& title, const std::string& body, const std::string& labels = "");
+
+    // Same for a body given as byte ranges, e.g. a mapped --body-file. Bodies of
+    // StreamThreshold bytes or more are escaped while libcurl uploads them, a
+    // chunk at a time, so memory use does not grow with the body.
+    bool createIssue(const std::string& title, const BodyParts& body, const std::string& labels = "");
+    static const size_t StreamThreshold = 64 * 1024;
     
     // Returns the ID of the last created issue, or -1 if no issue was created
     int getLastIssueId() const;
 
+    // Returns the full outcome of the last createIssue call
+    const IssueResult& getLastResult() const;
+
+    const std::shared_ptr<HttpSession>& getSession() const;
+
+    // Paces requests and retries throttled ones. Defaults to a private scheduler.
+    void setScheduler(std::shared_ptr<RequestScheduler> scheduler);
+    const std::shared_ptr<RequestScheduler>& getScheduler() const;
+
+    // Root of the Gitee API, e.g. "https://gitee.com/api/v5". Taken from the
+    // GITEE_API_URL environment variable if set. Set it once at startup, before
+    // any requests are made; it is shared by every request in the process.
+    static const std::string& getApiBaseUrl();
+    static void setApiBaseUrl(const std::string& url);
+
+    // Builds the endpoint URL and JSON payload used to create an issue
+    static std::string issuesUrl(const std::string& owner);
+    // Percent-encodes a query parameter value
+    static std::string urlEncode(const std::string& text);
+    static void buildRequestBody(JsonWriter& out, const std::string& token, const std::string& repo,
+                                 const std::string& title, std::string_view body,
+                                 const std::string& labels);
+    // Same, with the body rendered from a template directly into out
+    static void buildRequestBody(JsonWriter& out, const std::string& token, const std::string& repo,
+                                 const std::string& title, const IssueTemplate& body,
+                                 const IssueTemplate::Values& values, const std::string& labels);
+
 private:
     std::string owner;
     std::string repo;
     std::string token;
-    int lastIssueId; // Store the ID of the last created issue
+    IssueResult lastResult; // Outcome of the last created issue
+    std::shared_ptr<HttpSession> session;
+    std::shared_ptr<RequestScheduler> scheduler;
+    void* curl; // Long-lived easy handle, reused for every request
+    JsonWriter requestBody; // Reused payload buffer
 
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp);
-    
-    // Helper method to extract issue ID from JSON response
-    int extractIssueIdFromResponse(const std::string& response);
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, IssueResponseParser* userp);
+    static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, HttpHeaders* userp);
+    static size_t ReadCallback(char* buffer, size_t size, size_t nitems, void* userp);
+    static int SeekCallback(void* userp, long long offset, int origin);
 };
 
 #endif // ISSUECREATOR_H
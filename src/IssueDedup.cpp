@@ -0,0 +1,257 @@
+#include "IssueDedup.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+// Most of the body the search cache keeps; a huge log is searchable by its beginning
+const size_t CachedBodyLimit = 1 << 20;
+
+char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// MurmurHash64A fed piece by piece: eight bytes per step, well distributed in all 64 bits.
+// The total length is part of the seed, so it has to be known up front.
+class Murmur64 {
+public:
+    explicit Murmur64(size_t len) : h(0x9747b28c5f1d3a2bULL ^ (len * m)), pending(0) {}
+
+    void append(const char* data, size_t len) {
+        while (len > 0) {
+            if (pending == 0 && len >= 8) {
+                const char* end = data + (len & ~(size_t)7);
+                for (; data != end; data += 8) mix(data);
+                len &= 7;
+                continue;
+            }
+            size_t n = std::min(len, 8 - pending);
+            std::memcpy(block + pending, data, n);
+            pending += n;
+            data += n;
+            len -= n;
+            if (pending == 8) {
+                mix(block);
+                pending = 0;
+            }
+        }
+    }
+    void push(char c) { append(&c, 1); }
+
+    uint64_t finish() {
+        if (pending) {
+            uint64_t k = 0;
+            for (size_t i = 0; i < pending; ++i) k |= (uint64_t)(unsigned char)block[i] << (8 * i);
+            h ^= k;
+            h *= m;
+        }
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+        return h;
+    }
+
+private:
+    static const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    static const int r = 47;
+    uint64_t h;
+    char block[8];
+    size_t pending;
+
+    void mix(const char* p) {
+        uint64_t k;
+        std::memcpy(&k, p, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+};
+
+// Counts what would be hashed, for the length Murmur64 needs first
+struct LengthSink {
+    size_t len = 0;
+    void append(const char*, size_t n) { len += n; }
+    void push(char) { ++len; }
+};
+
+template <typename Sink>
+void appendLower(Sink& out, const std::string& text) {
+    for (char c : text) out.push(lowerAscii(c));
+}
+
+// Lower-cased, trimmed, with every whitespace run turned into one space
+template <typename Sink>
+void appendTitle(Sink& out, const std::string& title) {
+    bool pendingSpace = false;
+    bool any = false;
+    for (char c : title) {
+        if (isSpace(c)) {
+            pendingSpace = any;
+            continue;
+        }
+        if (pendingSpace) out.push(' ');
+        out.push(lowerAscii(c));
+        pendingSpace = false;
+        any = true;
+    }
+}
+
+// LF line endings, no trailing whitespace per line, no leading or trailing blank
+// lines. Works through the body once, holding back only the whitespace and line
+// breaks that may still turn out to be trailing.
+template <typename Sink>
+void appendBody(Sink& out, const BodyParts& body) {
+    bool started = false;
+    size_t newlines = 0;  // Line breaks owed before the next text
+    std::string spaces;   // Whitespace since the last text on this line
+
+    for (std::string_view part : body) {
+        size_t i = 0;
+        while (i < part.size()) {
+            char c = part[i];
+            if (c == '\n') {
+                spaces.clear();
+                if (started) ++newlines;
+                ++i;
+            } else if (isSpace(c)) {
+                spaces += c;
+                ++i;
+            } else {
+                for (; newlines > 0; --newlines) out.push('\n');
+                if (!spaces.empty()) out.append(spaces.data(), spaces.size());
+                spaces.clear();
+                started = true;
+
+                size_t end = i + 1;
+                while (end < part.size() && !isSpace(part[end])) ++end;
+                out.append(part.data() + i, end - i);
+                i = end;
+            }
+        }
+    }
+}
+
+// NUL separators keep ("ab", "c") and ("a", "bc") apart
+template <typename Sink>
+void appendNormalized(Sink& out, const std::string& owner, const std::string& repo, const std::string& title,
+                      const BodyParts& body) {
+    appendLower(out, owner);
+    out.push('\0');
+    appendLower(out, repo);
+    out.push('\0');
+    appendTitle(out, title);
+    out.push('\0');
+    appendBody(out, body);
+}
+
+} // namespace
+
+IssueDedup::IssueDedup(ConfigSetup& config, int ttlSeconds)
+    : config(config), ttlSeconds(ttlSeconds), hits(0), pruned(false) {}
+
+uint64_t IssueDedup::contentHash(const std::string& owner, const std::string& repo, const std::string& title,
+                                 const BodyParts& body) {
+    // Two passes instead of a normalized copy, so a mapped multi-gigabyte body costs no memory
+    LengthSink length;
+    appendNormalized(length, owner, repo, title, body);
+    Murmur64 hash(length.len);
+    appendNormalized(hash, owner, repo, title, body);
+    return hash.finish();
+}
+
+uint64_t IssueDedup::contentHash(const std::string& owner, const std::string& repo, const std::string& title,
+                                 const std::string& body) {
+    return contentHash(owner, repo, title, BodyParts{body});
+}
+
+bool IssueDedup::find(const std::string& owner, const std::string& repo, const std::string& title,
+                      const BodyParts& body, IssueResult& result) {
+    if (ttlSeconds <= 0) return false;
+    return find(contentHash(owner, repo, title, body), result);
+}
+
+bool IssueDedup::find(uint64_t hash, IssueResult& result) {
+    if (ttlSeconds <= 0) return false;
+
+    KnownIssue known;
+    if (!config.findKnownIssue((long long)hash, (long long)std::time(nullptr) - ttlSeconds, known)) return false;
+
+    ++hits;
+    result = IssueResult();
+    result.success = true;
+    result.duplicate = true;
+    result.id = known.issueId;
+    result.number = known.issueNumber;
+    result.htmlUrl = known.htmlUrl;
+    return true;
+}
+
+bool IssueDedup::find(const std::string& owner, const std::string& repo, const std::string& title,
+                      const std::string& body, IssueResult& result) {
+    return find(owner, repo, title, BodyParts{body}, result);
+}
+
+void IssueDedup::remember(const std::string& owner, const std::string& repo, const std::string& title,
+                          const BodyParts& body, const std::string& labels, const IssueResult& created) {
+    if (!created.success || created.duplicate || created.id < 0) return;
+
+    long long now = (long long)std::time(nullptr);
+    if (!pruned && ttlSeconds > 0) {
+        config.pruneKnownIssues(now - ttlSeconds);
+        pruned = true;
+    }
+
+    KnownIssue known;
+    known.issueId = created.id;
+    known.issueNumber = created.number;
+    known.htmlUrl = created.htmlUrl;
+    known.createdAt = now;
+    config.saveKnownIssue((long long)contentHash(owner, repo, title, body), owner, repo, known);
+
+    CachedIssue issue;
+    issue.id = created.id;
+    issue.owner = owner;
+    issue.repo = repo;
+    issue.number = created.number;
+    issue.title = title;
+    issue.state = "open";
+    issue.labels = labels;
+    issue.htmlUrl = created.htmlUrl;
+    // A body read from a file stays where it is; SQLite copies it straight from the mapping
+    if (body.size() == 1 && body[0].size() <= CachedBodyLimit) {
+        config.upsertIssue(issue, body[0]);
+        return;
+    }
+    std::string text;
+    for (std::string_view part : body) {
+        text.append(part.data(), std::min(part.size(), CachedBodyLimit - text.size()));
+        if (text.size() == CachedBodyLimit) break;
+    }
+    // Never cut a UTF-8 sequence in half
+    if (text.size() == CachedBodyLimit) {
+        size_t end = text.size();
+        while (end > 0 && ((unsigned char)text[end - 1] & 0xC0) == 0x80) --end;
+        if (end > 0 && (unsigned char)text[end - 1] >= 0xC0) text.resize(end - 1);
+    }
+    config.upsertIssue(issue, text);
+}
+
+void IssueDedup::remember(const std::string& owner, const std::string& repo, const std::string& title,
+                          const std::string& body, const std::string& labels, const IssueResult& created) {
+    remember(owner, repo, title, BodyParts{body}, labels, created);
+}
+
+size_t IssueDedup::getHits() const {
+    return hits;
+}
+
+int IssueDedup::getTtlSeconds() const {
+    return ttlSeconds;
+}
@@ -0,0 +1,58 @@
+#ifndef ISSUEDEDUP_H
+#define ISSUEDEDUP_H
+
+#include "BodyFile.h"
+#include "ConfigSetup.h"
+#include "IssueResponseParser.h"
+#include <cstdint>
+#include <string>
+
+// Skips creating an issue that was already created recently. Every created
+// issue is remembered in the config database under a 64-bit hash of its
+// normalized owner, repo, title and body. An identical issue sent again within
+// ttlSeconds gets the existing issue back instead of a new API call.
+// Normalization ignores what usually differs between reruns of the same report:
+//  - owner, repo and title are compared case-insensitively (ASCII)
+//  - runs of whitespace in the title count as one space; leading and trailing
+//    whitespace is dropped
+//  - in the body, CRLF line endings, trailing spaces on each line and leading or
+//    trailing blank lines are ignored
+// Labels are not part of the hash. Not thread-safe; the caller serializes access
+// to the ConfigSetup it shares.
+class IssueDedup {
+public:
+    // ttlSeconds <= 0 disables lookups; created issues are still remembered
+    IssueDedup(ConfigSetup& config, int ttlSeconds);
+
+    // On a hit within the TTL, fills result as a successful creation of the
+    // existing issue (with duplicate set) and returns true
+    bool find(const std::string& owner, const std::string& repo, const std::string& title,
+              const BodyParts& body, IssueResult& result);
+    bool find(const std::string& owner, const std::string& repo, const std::string& title,
+              const std::string& body, IssueResult& result);
+    // Same, for a hash from contentHash
+    bool find(uint64_t hash, IssueResult& result);
+
+    // Remembers a successfully created issue. It is also added to the local issue
+    // cache, so --search finds it before the next --sync.
+    void remember(const std::string& owner, const std::string& repo, const std::string& title,
+                  const BodyParts& body, const std::string& labels, const IssueResult& created);
+    void remember(const std::string& owner, const std::string& repo, const std::string& title,
+                  const std::string& body, const std::string& labels, const IssueResult& created);
+
+    size_t getHits() const;
+    int getTtlSeconds() const;
+
+    static uint64_t contentHash(const std::string& owner, const std::string& repo, const std::string& title,
+                                const BodyParts& body);
+    static uint64_t contentHash(const std::string& owner, const std::string& repo, const std::string& title,
+                                const std::string& body);
+
+private:
+    ConfigSetup& config;
+    int ttlSeconds;
+    size_t hits;
+    bool pruned; // Expired entries are deleted once per process, on the first remember()
+};
+
+#endif // ISSUEDEDUP_H
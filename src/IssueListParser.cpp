@@ -0,0 +1,117 @@
+#include "IssueListParser.h"
+#include <algorithm>
+#include <cstdlib>
+
+static const size_t kSnippetLimit = 4096;
+
+// With a top-level array, depth() is 2 inside each issue, 3 inside its user
+// object and 4 inside each of its labels
+static const int kIssueDepth = 2;
+
+IssueListParser::IssueListParser(const std::string& owner, const std::string& repo)
+    : tokenizer(*this), owner(owner), repo(repo), pending(None), section(Issue), isArray(false) {}
+
+void IssueListParser::reset() {
+    tokenizer.reset();
+    pending = None;
+    section = Issue;
+    isArray = false;
+    current = CachedIssue();
+    issues.clear();
+    snippet.clear();
+}
+
+void IssueListParser::feed(const char* data, size_t len) {
+    if (snippet.size() < kSnippetLimit) {
+        snippet.append(data, std::min(len, kSnippetLimit - snippet.size()));
+    }
+    tokenizer.feed(data, len);
+}
+
+bool IssueListParser::finish() {
+    return tokenizer.finish() && isArray;
+}
+
+std::vector<CachedIssue>& IssueListParser::getIssues() {
+    return issues;
+}
+
+const std::string& IssueListParser::getSnippet() const {
+    return snippet;
+}
+
+void IssueListParser::onStartArray() {
+    if (tokenizer.depth() == 1) isArray = true;
+}
+
+void IssueListParser::onStartObject() {
+    if (isArray && tokenizer.depth() == kIssueDepth) {
+        current = CachedIssue();
+        current.owner = owner;
+        current.repo = repo;
+        section = Issue;
+    }
+}
+
+void IssueListParser::onEndObject() {
+    if (!isArray || tokenizer.depth() != kIssueDepth - 1) return;
+    if (current.id >= 0) issues.push_back(std::move(current));
+    current = CachedIssue();
+}
+
+bool IssueListParser::onKey(const std::string& key) {
+    pending = None;
+    if (!isArray) return false;
+
+    int depth = tokenizer.depth();
+    if (depth == kIssueDepth) {
+        section = Other;
+        if (key == "id") pending = Id;
+        else if (key == "number") pending = Number;
+        else if (key == "title") pending = Title;
+        else if (key == "body") pending = Body;
+        else if (key == "state") pending = State;
+        else if (key == "html_url") pending = HtmlUrl;
+        else if (key == "created_at") pending = CreatedAt;
+        else if (key == "updated_at") pending = UpdatedAt;
+        else if (key == "user") section = User;
+        else if (key == "labels") section = Labels;
+    } else if (depth == kIssueDepth + 1 && section == User && key == "login") {
+        pending = Login;
+    } else if (depth == kIssueDepth + 2 && section == Labels && key == "name") {
+        pending = LabelName;
+    }
+    return pending != None;
+}
+
+void IssueListParser::onString(const std::string& value) {
+    switch (pending) {
+        case Id: current.id = std::strtoll(value.c_str(), nullptr, 10); break;
+        case Number: current.number = value; break;
+        case Title: current.title = value; break;
+        case Body: current.body = value; break;
+        case State: current.state = value; break;
+        case HtmlUrl: current.htmlUrl = value; break;
+        case CreatedAt: current.createdAt = value; break;
+        case UpdatedAt: current.updatedAt = value; break;
+        case Login: current.author = value; break;
+        case LabelName:
+            if (!current.labels.empty()) current.labels += ',';
+            current.labels += value;
+            break;
+        case None: break;
+    }
+    pending = None;
+}
+
+void IssueListParser::onNumber(const std::string& text) {
+    if (pending == Id) current.id = std::strtoll(text.c_str(), nullptr, 10);
+    else if (pending == Number) current.number = text;
+    pending = None;
+}
+
+void IssueListParser::onLiteral(const std::string& text) {
+    // "body": null and the like leave the field empty
+    (void)text;
+    pending = None;
+}
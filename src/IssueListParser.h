@@ -0,0 +1,56 @@
+#ifndef ISSUELISTPARSER_H
+#define ISSUELISTPARSER_H
+
+#include "ConfigSetup.h"
+#include "JsonTokenizer.h"
+#include <string>
+#include <vector>
+
+// Turns one page of GET /repos/{owner}/{repo}/issues into CachedIssue rows as
+// it streams in. Only the fields the cache keeps are copied: the issue's own
+// scalars, user.login and the names in labels[]. Everything else (repository,
+// milestone, assignees, ...) is scanned and skipped.
+class IssueListParser : private JsonHandler {
+public:
+    IssueListParser(const std::string& owner, const std::string& repo);
+
+    IssueListParser(const IssueListParser&) = delete;
+    IssueListParser& operator=(const IssueListParser&) = delete;
+
+    // Discards everything seen so far, e.g. before a retried request
+    void reset();
+
+    void feed(const char* data, size_t len);
+
+    // True if the input was one complete JSON array without syntax errors
+    bool finish();
+
+    std::vector<CachedIssue>& getIssues();
+
+    // Start of the raw response, kept for error messages
+    const std::string& getSnippet() const;
+
+private:
+    enum Field { None, Id, Number, Title, Body, State, HtmlUrl, CreatedAt, UpdatedAt, Login, LabelName };
+    enum Section { Issue, User, Labels, Other };
+
+    JsonTokenizer tokenizer;
+    std::string owner;
+    std::string repo;
+    Field pending;
+    Section section;  // Which member of the current issue the tokenizer is inside
+    bool isArray;     // The top-level value is an array
+    CachedIssue current;
+    std::vector<CachedIssue> issues;
+    std::string snippet;
+
+    void onStartObject() override;
+    void onEndObject() override;
+    void onStartArray() override;
+    bool onKey(const std::string& key) override;
+    void onString(const std::string& value) override;
+    void onNumber(const std::string& text) override;
+    void onLiteral(const std::string& text) override;
+};
+
+#endif // ISSUELISTPARSER_H
@@ -0,0 +1,85 @@
+#include "IssueResponseParser.h"
+#include <algorithm>
+#include <cstdlib>
+
+static const size_t kSnippetLimit = 4096;
+
+IssueResponseParser::IssueResponseParser()
+    : tokenizer(*this), pending(None), id(-1), found(0) {}
+
+void IssueResponseParser::reset() {
+    tokenizer.reset();
+    pending = None;
+    id = -1;
+    number.clear();
+    htmlUrl.clear();
+    found = 0;
+    snippet.clear();
+}
+
+void IssueResponseParser::feed(const char* data, size_t len) {
+    if (snippet.size() < kSnippetLimit) {
+        snippet.append(data, std::min(len, kSnippetLimit - snippet.size()));
+    }
+    if (!tokenizer.isStopped()) {
+        tokenizer.feed(data, len);
+    }
+}
+
+bool IssueResponseParser::isComplete() const {
+    return found == 3;
+}
+
+bool IssueResponseParser::onKey(const std::string& key) {
+    pending = None;
+    if (tokenizer.depth() != 1) return false;
+    if (key == "id" && id < 0) pending = Id;
+    else if (key == "number" && number.empty()) pending = Number;
+    else if (key == "html_url" && htmlUrl.empty()) pending = HtmlUrl;
+    return pending != None;
+}
+
+void IssueResponseParser::onString(const std::string& value) {
+    if (pending == Number) {
+        number = value;
+        ++found;
+    } else if (pending == HtmlUrl) {
+        htmlUrl = value;
+        ++found;
+    } else if (pending == Id) {
+        id = std::strtoll(value.c_str(), nullptr, 10);
+        ++found;
+    }
+    pending = None;
+    if (isComplete()) tokenizer.stop();
+}
+
+void IssueResponseParser::onNumber(const std::string& text) {
+    if (pending == Id) {
+        id = std::strtoll(text.c_str(), nullptr, 10);
+        ++found;
+    } else if (pending == Number) {
+        number = text;
+        ++found;
+    }
+    pending = None;
+    if (isComplete()) tokenizer.stop();
+}
+
+void IssueResponseParser::fill(IssueResult& result) const {
+    result.id = id;
+    result.number = number;
+    result.htmlUrl = htmlUrl;
+}
+
+const std::string& IssueResponseParser::getSnippet() const {
+    return snippet;
+}
+
+IssueResult IssueResponseParser::parse(const std::string& response) {
+    IssueResponseParser parser;
+    parser.feed(response.data(), response.size());
+    IssueResult result;
+    parser.fill(result);
+    return result;
+}
@@ -0,0 +1,61 @@
+#ifndef ISSUERESPONSEPARSER_H
+#define ISSUERESPONSEPARSER_H
+
+#include "JsonTokenizer.h"
+#include <string>
+
+// Outcome of a single issue creation request
+struct IssueResult {
+    bool success = false;
+    long status = 0;          // HTTP status code, 0 if no response was received
+    long long id = -1;        // Top-level "id" of the created issue
+    std::string number;       // Issue number as shown on Gitee, e.g. "I4ABCD"
+    std::string htmlUrl;
+    std::string error;
+    int retries = 0;          // Times the request was re-sent after throttling or a server error
+    bool duplicate = false;   // An identical issue already existed; nothing was sent (see IssueDedup)
+};
+
+// Pulls the top-level id, number and html_url out of an issue response as it
+// streams in. Nested objects (user, repository, ...) are skipped without being
+// copied, and tokenizing stops as soon as all three fields have been seen.
+class IssueResponseParser : private JsonHandler {
+public:
+    IssueResponseParser();
+
+    IssueResponseParser(const IssueResponseParser&) = delete;
+    IssueResponseParser& operator=(const IssueResponseParser&) = delete;
+
+    // Discards everything seen so far, e.g. before a retried request
+    void reset();
+
+    void feed(const char* data, size_t len);
+
+    // True once id, number and html_url have all been found
+    bool isComplete() const;
+
+    // Copies the extracted fields into result
+    void fill(IssueResult& result) const;
+
+    // Start of the raw response, kept for error messages
+    const std::string& getSnippet() const;
+
+    static IssueResult parse(const std::string& response);
+
+private:
+    enum Field { None, Id, Number, HtmlUrl };
+
+    JsonTokenizer tokenizer;
+    Field pending;
+    long long id;
+    std::string number;
+    std::string htmlUrl;
+    int found;
+    std::string snippet;
+
+    bool onKey(const std::string& key) override;
+    void onString(const std::string& value) override;
+    void onNumber(const std::string& text) override;
+};
+
+#endif // ISSUERESPONSEPARSER_H
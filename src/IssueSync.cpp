@@ -0,0 +1,94 @@
+#include "IssueSync.h"
+#include "HttpPipeline.h"
+#include "IssueCreator.h"
+#include "IssueListParser.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+IssueSync::IssueSync(ConfigSetup& config, std::shared_ptr<RequestScheduler> scheduler,
+                     std::shared_ptr<HttpSession> session)
+    : config(config), scheduler(scheduler ? std::move(scheduler) : std::make_shared<RequestScheduler>()),
+      session(session ? std::move(session) : std::make_shared<HttpSession>()) {}
+
+std::string IssueSync::pageUrl(const std::string& owner, const std::string& repo, const std::string& token,
+                               const std::string& since, int page) {
+    std::string url = IssueCreator::getApiBaseUrl() + "/repos/" + owner + "/" + repo +
+                      "/issues?access_token=" + IssueCreator::urlEncode(token) +
+                      "&state=all&sort=updated&direction=desc&per_page=" + std::to_string(PerPage) +
+                      "&page=" + std::to_string(page);
+    if (!since.empty()) url += "&since=" + IssueCreator::urlEncode(since);
+    return url;
+}
+
+bool IssueSync::run(const std::string& owner, const std::string& repo, const std::string& token, bool full,
+                    Report& report) {
+    report = Report();
+    if (!full) report.since = config.getSyncCursor(owner, repo);
+
+    HttpPipeline pipeline(scheduler->getOptions().maxConcurrency, session, scheduler);
+    std::string newest = report.since;
+    int lastSubmitted = 0;
+
+    std::function<void(int)> fetch = [&](int page) {
+        HttpRequest request;
+        request.method = "GET";
+        request.url = pageUrl(owner, repo, token, report.since, page);
+        request.rateKey = token;
+
+        auto parser = std::make_shared<IssueListParser>(owner, repo);
+        request.onData = [parser](const char* data, size_t len) { parser->feed(data, len); };
+        request.onRetry = [parser]() { parser->reset(); };
+        lastSubmitted = std::max(lastSubmitted, page);
+
+        pipeline.submit(std::move(request), [&, parser, page](const HttpResponse& response) {
+            if (!report.error.empty()) return;
+            if (!response.error.empty()) {
+                report.error = "Curl error: " + response.error;
+                return;
+            }
+            if (response.status != 200) {
+                report.error = "HTTP " + std::to_string(response.status) + ": " + parser->getSnippet();
+                return;
+            }
+            if (!parser->finish()) {
+                report.error = "Unexpected response for page " + std::to_string(page) + ": " + parser->getSnippet();
+                return;
+            }
+
+            std::vector<CachedIssue>& issues = parser->getIssues();
+            if (!config.upsertIssues(issues)) {
+                report.error = "Failed to save issues to the local cache";
+                return;
+            }
+            ++report.pages;
+            report.issues += issues.size();
+            for (const CachedIssue& issue : issues) {
+                if (issue.updatedAt > newest) newest = issue.updatedAt;
+            }
+
+            if (page == 1) {
+                auto total = response.headers.find("total_page");
+                int pages = total != response.headers.end() ? std::atoi(total->second.c_str()) : 0;
+                if (pages > 1) {
+                    for (int next = 2; next <= pages; ++next) fetch(next);
+                    return;
+                }
+            }
+            // Past the last known page (or without a page count) keep going one page at
+            // a time until a short page; issues changed meanwhile may have pushed a few
+            // older ones past the count from page 1
+            if (issues.size() >= (size_t)PerPage && page == lastSubmitted) fetch(page + 1);
+        });
+    };
+
+    fetch(1);
+    pipeline.run();
+
+    if (!report.error.empty()) return false;
+    if (newest != report.since && !config.setSyncCursor(owner, repo, newest)) {
+        report.error = "Failed to save the sync cursor";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef ISSUESYNC_H
+#define ISSUESYNC_H
+
+#include "ConfigSetup.h"
+#include "HttpSession.h"
+#include "RequestScheduler.h"
+#include <memory>
+#include <string>
+
+// Copies a repo's existing issues into the local issues table. The first page
+// of GET /repos/{owner}/{repo}/issues tells how many pages there are
+// (total_page header); the rest are then fetched concurrently through
+// HttpPipeline and each page is written in one transaction as it arrives.
+// A sync remembers the newest updated_at it saw, and the next one only asks
+// for issues updated since then.
+//
+// Pages are ordered by updated_at, newest first: an issue changed while the
+// sync runs moves to page 1, so later pages only shift towards the end and no
+// unchanged issue is skipped. The changed issue itself is newer than the
+// cursor and comes with the next sync.
+class IssueSync {
+public:
+    struct Report {
+        size_t pages = 0;
+        size_t issues = 0;        // Rows inserted or updated
+        std::string since;        // Cursor the sync started from; empty for a full sync
+        std::string error;        // First failure; the cursor is not advanced
+    };
+
+    static const int PerPage = 100; // Largest page the API returns
+
+    IssueSync(ConfigSetup& config, std::shared_ptr<RequestScheduler> scheduler,
+              std::shared_ptr<HttpSession> session = nullptr);
+
+    // Syncs one repo. With full set, the stored cursor is ignored and every issue is fetched.
+    bool run(const std::string& owner, const std::string& repo, const std::string& token, bool full,
+             Report& report);
+
+    static std::string pageUrl(const std::string& owner, const std::string& repo, const std::string& token,
+                               const std::string& since, int page);
+
+private:
+    ConfigSetup& config;
+    std::shared_ptr<RequestScheduler> scheduler;
+    std::shared_ptr<HttpSession> session;
+};
+
+#endif // ISSUESYNC_H
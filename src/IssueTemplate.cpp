@@ -0,0 +1,150 @@
+#include "IssueTemplate.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+bool isNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.' ||
+           c == '-';
+}
+
+// The name inside {{ }}, or empty if it is not one
+std::string_view placeholderName(std::string_view inner) {
+    size_t begin = inner.find_first_not_of(' ');
+    if (begin == std::string_view::npos) return {};
+    size_t end = inner.find_last_not_of(' ') + 1;
+    std::string_view name = inner.substr(begin, end - begin);
+    for (char c : name) {
+        if (!isNameChar(c)) return {};
+    }
+    return name;
+}
+
+} // namespace
+
+IssueTemplate::IssueTemplate() {}
+
+IssueTemplate::IssueTemplate(const std::string& text) {
+    compile(text);
+}
+
+void IssueTemplate::compile(const std::string& text) {
+    literals.clear();
+    escapedLiterals.clear();
+    ops.clear();
+    names.clear();
+
+    std::string_view rest(text);
+    while (!rest.empty()) {
+        size_t open = rest.find("{{");
+        if (open == std::string_view::npos) {
+            addLiteral(rest);
+            break;
+        }
+        size_t close = rest.find("}}", open + 2);
+        if (close == std::string_view::npos) {
+            addLiteral(rest);
+            break;
+        }
+        std::string_view name = placeholderName(rest.substr(open + 2, close - open - 2));
+        if (name.empty()) {
+            // Not a placeholder: keep the braces, and look for one again just after them
+            addLiteral(rest.substr(0, open + 2));
+            rest.remove_prefix(open + 2);
+            continue;
+        }
+        addLiteral(rest.substr(0, open));
+        Op op = {slotFor(name), 0, 0, 0, 0};
+        ops.push_back(op);
+        rest.remove_prefix(close + 2);
+    }
+}
+
+bool IssueTemplate::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "❌ Failed to open template: " << path << std::endl;
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (file.bad()) {
+        std::cerr << "❌ Failed to read template: " << path << std::endl;
+        return false;
+    }
+    compile(text);
+    return true;
+}
+
+void IssueTemplate::addLiteral(std::string_view piece) {
+    if (piece.empty()) return;
+    // Pieces split at a brace that was not a placeholder are joined again
+    if (ops.empty() || ops.back().slot >= 0) {
+        Op op = {-1, (uint32_t)literals.size(), 0, (uint32_t)escapedLiterals.size(), 0};
+        ops.push_back(op);
+    }
+    Op& op = ops.back();
+    literals.append(piece.data(), piece.size());
+    JsonWriter::appendEscaped(escapedLiterals, piece.data(), piece.size());
+    op.textLen = (uint32_t)(literals.size() - op.text);
+    op.jsonLen = (uint32_t)(escapedLiterals.size() - op.json);
+}
+
+int IssueTemplate::slotFor(std::string_view name) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return (int)i;
+    }
+    names.emplace_back(name);
+    return (int)names.size() - 1;
+}
+
+const std::vector<std::string>& IssueTemplate::variables() const {
+    return names;
+}
+
+bool IssueTemplate::isConstant() const {
+    return names.empty();
+}
+
+void IssueTemplate::render(JsonWriter& out, const Values& values) const {
+    out.beginString();
+    for (const Op& op : ops) {
+        if (op.slot < 0) {
+            out.rawStringPart(std::string_view(escapedLiterals.data() + op.json, op.jsonLen));
+        } else {
+            out.stringPart(values[op.slot]);
+        }
+    }
+    out.endString();
+}
+
+void IssueTemplate::render(std::string& out, const Values& values) const {
+    out.reserve(out.size() + renderedSize(values));
+    for (const Op& op : ops) {
+        if (op.slot < 0) {
+            out.append(literals.data() + op.text, op.textLen);
+        } else {
+            out.append(values[op.slot].data(), values[op.slot].size());
+        }
+    }
+}
+
+void IssueTemplate::parts(const Values& values, BodyParts& out) const {
+    out.clear();
+    for (const Op& op : ops) {
+        if (op.slot < 0) {
+            out.emplace_back(literals.data() + op.text, op.textLen);
+        } else if (!values[op.slot].empty()) {
+            out.push_back(values[op.slot]);
+        }
+    }
+}
+
+size_t IssueTemplate::renderedSize(const Values& values) const {
+    size_t size = 0;
+    for (const Op& op : ops) {
+        size += op.slot < 0 ? op.textLen : values[op.slot].size();
+    }
+    return size;
+}
@@ -0,0 +1,70 @@
+#ifndef ISSUETEMPLATE_H
+#define ISSUETEMPLATE_H
+
+#include "BodyFile.h"
+#include "JsonWriter.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Issue text with {{name}} placeholders, e.g.
+//   Test {{test}} failed at {{commit}}:
+//   {{log}}
+// The text is parsed once into a list of literal pieces and variable slots;
+// rendering a record only walks that list, without searching the text again.
+// Names are letters, digits, '_', '.' and '-', with optional spaces inside the
+// braces. Anything else between {{ and }} is kept as literal text. A name used
+// several times shares one slot.
+class IssueTemplate {
+public:
+    // values[i] fills the slot of variables()[i]
+    using Values = std::vector<std::string_view>;
+
+    IssueTemplate();
+    explicit IssueTemplate(const std::string& text);
+
+    void compile(const std::string& text);
+
+    // Reads and compiles a template file. Returns false (with a message on stderr) if it cannot be read.
+    bool load(const std::string& path);
+
+    // Variable names in slot order, each listed once
+    const std::vector<std::string>& variables() const;
+
+    // True if the template has no placeholders
+    bool isConstant() const;
+
+    // Appends the rendered text to out as one JSON string value. Literal pieces
+    // were escaped at compile time and are copied as they are.
+    void render(JsonWriter& out, const Values& values) const;
+
+    // Appends the rendered text as plain text
+    void render(std::string& out, const Values& values) const;
+
+    // The rendered text as ranges of the template and of values, e.g. for
+    // IssueDedup::contentHash. Valid while both are.
+    void parts(const Values& values, BodyParts& out) const;
+
+    // Bytes render(std::string&) appends
+    size_t renderedSize(const Values& values) const;
+
+private:
+    struct Op {
+        int32_t slot;       // Variable slot, or -1 for a literal piece
+        uint32_t text;      // Literal: offset into literals
+        uint32_t textLen;
+        uint32_t json;      // Literal: offset into escapedLiterals
+        uint32_t jsonLen;
+    };
+
+    std::string literals;        // Literal pieces, back to back
+    std::string escapedLiterals; // The same pieces escaped for JSON
+    std::vector<Op> ops;
+    std::vector<std::string> names;
+
+    void addLiteral(std::string_view piece);
+    int slotFor(std::string_view name);
+};
+
+#endif // ISSUETEMPLATE_H
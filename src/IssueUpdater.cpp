@@ -0,0 +1,109 @@
+#include "IssueUpdater.h"
+#include "HttpPipeline.h"
+#include "HttpSession.h"
+#include "IssueCreator.h"
+
+bool IssueChanges::empty() const {
+    return !title && !body && !labels && !state;
+}
+
+namespace {
+
+// Numbers go into the URL path as they are, so anything but letters and digits is refused
+bool validNumber(const std::string& number) {
+    if (number.empty()) return false;
+    for (char c : number) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+IssueUpdater::IssueUpdater(const std::string& owner, const std::string& repo, const std::string& token,
+                           int concurrency, std::shared_ptr<HttpSession> session,
+                           std::shared_ptr<RequestScheduler> scheduler)
+    : owner(owner), repo(repo), token(token), concurrency(concurrency),
+      session(session ? std::move(session) : std::make_shared<HttpSession>()),
+      scheduler(scheduler ? std::move(scheduler) : std::make_shared<RequestScheduler>()) {}
+
+const std::shared_ptr<HttpSession>& IssueUpdater::getSession() const {
+    return session;
+}
+
+const std::shared_ptr<RequestScheduler>& IssueUpdater::getScheduler() const {
+    return scheduler;
+}
+
+std::string IssueUpdater::issueUrl(const std::string& owner, const std::string& number) {
+    return IssueCreator::issuesUrl(owner) + "/" + number;
+}
+
+void IssueUpdater::buildRequestBody(JsonWriter& out, const std::string& token, const std::string& repo,
+                                    const IssueChanges& changes) {
+    out.clear();
+    out.beginObject();
+    out.field("access_token", token);
+    out.field("repo", repo);
+    if (changes.title) out.field("title", *changes.title);
+    if (changes.body) out.field("body", *changes.body);
+    if (changes.labels) out.field("labels", *changes.labels);
+    if (changes.state) out.field("state", *changes.state);
+    out.endObject();
+}
+
+size_t IssueUpdater::run(const std::vector<std::string>& numbers, const IssueChanges& changes,
+                         const ResultCallback& onResult) {
+    HttpPipeline pipeline(concurrency, session, scheduler);
+    size_t failures = 0;
+
+    // Every issue gets the same payload; only the URL differs
+    JsonWriter writer;
+    buildRequestBody(writer, token, repo, changes);
+    const std::string payload = writer.take();
+
+    for (const std::string& given : numbers) {
+        std::string number = given.size() > 1 && given[0] == '#' ? given.substr(1) : given;
+        if (!validNumber(number)) {
+            UpdateResult result;
+            result.target = given;
+            result.error = "Not an issue number";
+            ++failures;
+            onResult(result);
+            continue;
+        }
+
+        HttpRequest request;
+        request.method = "PATCH";
+        request.url = issueUrl(owner, number);
+        request.body = payload;
+        request.headers.push_back("Content-Type: application/json;charset=UTF-8");
+        request.rateKey = token;
+
+        // The response is parsed as it arrives; only the fields we need are kept
+        auto parser = std::make_shared<IssueResponseParser>();
+        request.onData = [parser](const char* data, size_t len) { parser->feed(data, len); };
+        request.onRetry = [parser]() { parser->reset(); };
+
+        pipeline.submit(std::move(request), [number, parser, &failures, &onResult](const HttpResponse& response) {
+            UpdateResult result;
+            result.target = number;
+            result.status = response.status;
+            result.retries = response.retries;
+            if (!response.error.empty()) {
+                result.error = "Curl error: " + response.error;
+            } else if (response.status != 200) {
+                result.error = "HTTP " + std::to_string(response.status) + ": " + parser->getSnippet();
+            } else {
+                result.success = true;
+                parser->fill(result);
+            }
+            if (!result.success) ++failures;
+            onResult(result);
+        });
+    }
+
+    // Every request is queued up front; the pipeline and scheduler pace them
+    pipeline.run();
+    return failures;
+}
@@ -0,0 +1,62 @@
+#ifndef ISSUEUPDATER_H
+#define ISSUEUPDATER_H
+
+#include "IssueResponseParser.h"
+#include "JsonWriter.h"
+#include "RequestScheduler.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Fields to change on every issue; unset ones are left as they are.
+// Set labels replace the issue's labels, and an empty body clears it.
+struct IssueChanges {
+    std::optional<std::string> title;
+    std::optional<std::string> body;
+    std::optional<std::string> labels; // Comma-separated
+    std::optional<std::string> state;  // open, progressing or closed
+
+    bool empty() const;
+};
+
+struct UpdateResult : IssueResult {
+    std::string target; // Issue number as it was given
+};
+
+class HttpSession;
+
+// Edits many issues of one repo concurrently with PATCH requests through
+// HttpPipeline, the engine --batch uses: connections are reused, requests are
+// paced by the RequestScheduler, and throttled or failed ones are retried.
+class IssueUpdater {
+public:
+    using ResultCallback = std::function<void(const UpdateResult&)>;
+
+    IssueUpdater(const std::string& owner, const std::string& repo, const std::string& token,
+                 int concurrency = 8, std::shared_ptr<HttpSession> session = nullptr,
+                 std::shared_ptr<RequestScheduler> scheduler = nullptr);
+
+    // Applies changes to every issue in numbers (e.g. "I4ABCD"; a leading '#' is
+    // ignored) and reports each result as it finishes. Returns the number that failed.
+    size_t run(const std::vector<std::string>& numbers, const IssueChanges& changes, const ResultCallback& onResult);
+
+    const std::shared_ptr<HttpSession>& getSession() const;
+    const std::shared_ptr<RequestScheduler>& getScheduler() const;
+
+    // Builds the endpoint URL and JSON payload used to update an issue
+    static std::string issueUrl(const std::string& owner, const std::string& number);
+    static void buildRequestBody(JsonWriter& out, const std::string& token, const std::string& repo,
+                                 const IssueChanges& changes);
+
+private:
+    std::string owner;
+    std::string repo;
+    std::string token;
+    int concurrency;
+    std::shared_ptr<HttpSession> session;
+    std::shared_ptr<RequestScheduler> scheduler;
+};
+
+#endif // ISSUEUPDATER_H
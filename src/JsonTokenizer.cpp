@@ -0,0 +1,312 @@
+#include "JsonTokenizer.h"
+#include <cstring>
+
+JsonTokenizer::JsonTokenizer(JsonHandler& handler) : handler(handler) {
+    reset();
+}
+
+void JsonTokenizer::reset() {
+    state = State::Value;
+    inKey = false;
+    capture = false;
+    nesting = 0;
+    containers.clear();
+    token.clear();
+    unicode = 0;
+    unicodeDigits = 0;
+    highSurrogate = 0;
+    stopped = false;
+    error.clear();
+}
+
+void JsonTokenizer::stop() {
+    stopped = true;
+}
+
+bool JsonTokenizer::isStopped() const {
+    return stopped;
+}
+
+bool JsonTokenizer::hasError() const {
+    return state == State::Error;
+}
+
+const std::string& JsonTokenizer::getError() const {
+    return error;
+}
+
+int JsonTokenizer::depth() const {
+    return nesting;
+}
+
+void JsonTokenizer::fail(const std::string& message) {
+    state = State::Error;
+    error = message;
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+void JsonTokenizer::beginValue(char c) {
+    token.clear();
+    switch (c) {
+        case '{':
+            containers += '{';
+            ++nesting;
+            capture = false;
+            handler.onStartObject();
+            state = State::KeyOrEnd;
+            return;
+        case '[':
+            containers += '[';
+            ++nesting;
+            capture = false;
+            handler.onStartArray();
+            state = State::ValueOrEnd;
+            return;
+        case '"':
+            inKey = false;
+            state = State::String;
+            return;
+        default:
+            break;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        token += c;
+        state = State::Number;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        token += c;
+        state = State::Literal;
+    } else {
+        fail(std::string("unexpected character '") + c + "'");
+    }
+}
+
+void JsonTokenizer::endScalar() {
+    if (state == State::Number) {
+        if (capture) handler.onNumber(token);
+    } else if (state == State::Literal) {
+        if (token != "true" && token != "false" && token != "null") {
+            fail("invalid literal '" + token + "'");
+            return;
+        }
+        if (capture) handler.onLiteral(token);
+    }
+    capture = false;
+    state = nesting == 0 ? State::Done : State::AfterValue;
+}
+
+void JsonTokenizer::endString() {
+    if (inKey) {
+        inKey = false;
+        capture = handler.onKey(token);
+        state = State::Colon;
+        return;
+    }
+    if (capture) handler.onString(token);
+    capture = false;
+    state = nesting == 0 ? State::Done : State::AfterValue;
+}
+
+void JsonTokenizer::closeContainer(char c) {
+    char open = c == '}' ? '{' : '[';
+    if (containers.empty() || containers.back() != open) {
+        fail(std::string("unbalanced '") + c + "'");
+        return;
+    }
+    containers.pop_back();
+    --nesting;
+    if (c == '}') {
+        handler.onEndObject();
+    } else {
+        handler.onEndArray();
+    }
+    capture = false;
+    state = nesting == 0 ? State::Done : State::AfterValue;
+}
+
+bool JsonTokenizer::finish() {
+    if (state == State::Number || state == State::Literal) {
+        endScalar();
+    }
+    return state == State::Done;
+}
+
+bool JsonTokenizer::feed(const char* data, size_t len) {
+    size_t i = 0;
+    while (i < len && !stopped) {
+        char c = data[i];
+        switch (state) {
+            case State::Error:
+                return false;
+
+            case State::Done:
+                if (!isSpace(c)) {
+                    fail("trailing characters after JSON value");
+                    return false;
+                }
+                ++i;
+                break;
+
+            case State::Value:
+            case State::ValueOrEnd:
+                if (isSpace(c)) {
+                    ++i;
+                } else if (c == ']' && state == State::ValueOrEnd) {
+                    closeContainer(c);
+                    ++i;
+                } else {
+                    beginValue(c);
+                    ++i;
+                }
+                break;
+
+            case State::KeyOrEnd:
+            case State::Key:
+                if (isSpace(c)) {
+                    ++i;
+                } else if (c == '}' && state == State::KeyOrEnd) {
+                    closeContainer(c);
+                    ++i;
+                } else if (c == '"') {
+                    token.clear();
+                    inKey = true;
+                    state = State::String;
+                    ++i;
+                } else {
+                    fail("expected object key");
+                }
+                break;
+
+            case State::Colon:
+                if (isSpace(c)) {
+                    ++i;
+                } else if (c == ':') {
+                    state = State::Value;
+                    ++i;
+                } else {
+                    fail("expected ':'");
+                }
+                break;
+
+            case State::AfterValue:
+                if (isSpace(c)) {
+                    ++i;
+                } else if (c == ',') {
+                    state = containers.back() == '{' ? State::Key : State::Value;
+                    ++i;
+                } else if (c == '}' || c == ']') {
+                    closeContainer(c);
+                    ++i;
+                } else {
+                    fail("expected ',' or closing bracket");
+                }
+                break;
+
+            case State::String: {
+                // Copy or skip the whole run of plain characters at once
+                size_t start = i;
+                while (i < len && data[i] != '"' && data[i] != '\\') ++i;
+                if (inKey || capture) token.append(data + start, i - start);
+                if (i == len) break;
+                if (data[i] == '"') {
+                    ++i;
+                    endString();
+                } else {
+                    ++i;
+                    state = State::StringEscape;
+                }
+                break;
+            }
+
+            case State::StringEscape: {
+                ++i;
+                char out = 0;
+                switch (c) {
+                    case 'n': out = '\n'; break;
+                    case 't': out = '\t'; break;
+                    case 'r': out = '\r'; break;
+                    case 'b': out = '\b'; break;
+                    case 'f': out = '\f'; break;
+                    case '"': case '\\': case '/': out = c; break;
+                    case 'u':
+                        unicode = 0;
+                        unicodeDigits = 0;
+                        state = State::StringUnicode;
+                        continue;
+                    default:
+                        fail(std::string("invalid escape '\\") + c + "'");
+                        continue;
+                }
+                if (inKey || capture) token += out;
+                state = State::String;
+                break;
+            }
+
+            case State::StringUnicode: {
+                unsigned digit;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                else {
+                    fail("invalid \\u escape");
+                    break;
+                }
+                ++i;
+                unicode = (unicode << 4) | digit;
+                if (++unicodeDigits == 4) {
+                    if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+                        highSurrogate = unicode;
+                    } else {
+                        unsigned cp = unicode;
+                        if (highSurrogate && unicode >= 0xDC00 && unicode <= 0xDFFF) {
+                            cp = 0x10000 + ((highSurrogate - 0xD800) << 10) + (unicode - 0xDC00);
+                        }
+                        highSurrogate = 0;
+                        if (inKey || capture) appendUtf8(token, cp);
+                    }
+                    state = State::String;
+                }
+                break;
+            }
+
+            case State::Number:
+                if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                    token += c;
+                    ++i;
+                } else {
+                    endScalar(); // Re-examine c in the new state
+                }
+                break;
+
+            case State::Literal:
+                if (c >= 'a' && c <= 'z') {
+                    token += c;
+                    ++i;
+                } else {
+                    endScalar();
+                }
+                break;
+        }
+    }
+    return state != State::Error;
+}
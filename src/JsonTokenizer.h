@@ -0,0 +1,86 @@
+#ifndef JSONTOKENIZER_H
+#define JSONTOKENIZER_H
+
+#include <string>
+
+// Receives events from JsonTokenizer. All methods are optional.
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual void onStartObject() {}
+    virtual void onEndObject() {}
+    virtual void onStartArray() {}
+    virtual void onEndArray() {}
+
+    // Return true to have the value that follows this key captured and passed to
+    // onString/onNumber. Uncaptured values are scanned but never copied.
+    virtual bool onKey(const std::string& key) { (void)key; return false; }
+
+    virtual void onString(const std::string& value) { (void)value; }
+    virtual void onNumber(const std::string& text) { (void)text; }
+    virtual void onLiteral(const std::string& text) { (void)text; }
+};
+
+// Incremental JSON tokenizer. Input may be split at any byte; state carries over
+// between feed() calls, so it can consume a response directly from a write callback.
+class JsonTokenizer {
+public:
+    explicit JsonTokenizer(JsonHandler& handler);
+
+    // Consumes a chunk of input. Returns false once a syntax error was seen.
+    bool feed(const char* data, size_t len);
+
+    // Signals end of input. Returns true if exactly one complete value was read.
+    bool finish();
+
+    // Stops tokenizing; subsequent feed() calls are ignored
+    void stop();
+    bool isStopped() const;
+
+    bool hasError() const;
+    const std::string& getError() const;
+
+    // Nesting level of the current position (1 inside the top-level object)
+    int depth() const;
+
+    void reset();
+
+private:
+    enum class State {
+        Value,        // Expecting any value
+        KeyOrEnd,     // After '{': expecting a key or '}'
+        Key,          // After ',' in an object: expecting a key
+        Colon,
+        AfterValue,   // Expecting ',' or a closing bracket
+        ValueOrEnd,   // After '[': expecting a value or ']'
+        String,
+        StringEscape,
+        StringUnicode,
+        Number,
+        Literal,
+        Done,
+        Error
+    };
+
+    JsonHandler& handler;
+    State state;
+    bool inKey;            // The string being scanned is an object key
+    bool capture;          // The current scalar value is passed to the handler
+    int nesting;
+    std::string containers; // '{' or '[' for each open container
+    std::string token;      // Current key or captured scalar
+    unsigned unicode;
+    unsigned highSurrogate; // Pending first half of a \uD800-\uDBFF pair
+    int unicodeDigits;
+    bool stopped;
+    std::string error;
+
+    void fail(const std::string& message);
+    void beginValue(char c);
+    void endScalar();
+    void endString();
+    void closeContainer(char c);
+};
+
+#endif // JSONTOKENIZER_H
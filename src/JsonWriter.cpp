@@ -0,0 +1,210 @@
+#include "JsonWriter.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+JsonWriter::JsonWriter(size_t initialCapacity) : afterKey(false) {
+    buffer.reserve(initialCapacity);
+}
+
+void JsonWriter::clear() {
+    buffer.clear();
+    hasItems.clear();
+    afterKey = false;
+}
+
+void JsonWriter::reserve(size_t capacity) {
+    buffer.reserve(capacity);
+}
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!hasItems.empty()) {
+        if (hasItems.back()) buffer += ',';
+        hasItems.back() = true;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    buffer += '{';
+    hasItems.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    buffer += '}';
+    hasItems.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    buffer += '[';
+    hasItems.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    buffer += ']';
+    hasItems.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    buffer += '"';
+    appendEscaped(buffer, name.data(), name.size());
+    buffer += "\":";
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    buffer += '"';
+    appendEscaped(buffer, text.data(), text.size());
+    buffer += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long number) {
+    separate();
+    buffer += std::to_string(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    buffer += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(std::string_view name, std::string_view text) {
+    return key(name).value(text);
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    buffer.append(json.data(), json.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginString() {
+    separate();
+    buffer += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::stringPart(std::string_view text) {
+    appendEscaped(buffer, text.data(), text.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::rawStringPart(std::string_view escaped) {
+    buffer.append(escaped.data(), escaped.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::endString() {
+    buffer += '"';
+    return *this;
+}
+
+const std::string& JsonWriter::str() const {
+    return buffer;
+}
+
+const char* JsonWriter::data() const {
+    return buffer.data();
+}
+
+size_t JsonWriter::size() const {
+    return buffer.size();
+}
+
+std::string JsonWriter::take() {
+    std::string out = std::move(buffer);
+    clear();
+    return out;
+}
+
+// Length of the prefix of data that can be copied without escaping
+static size_t plainPrefix(const char* data, size_t len) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Test 16 bytes at a time for '"', '\\' or a control character (< 0x20).
+    // Bytes >= 0x80 are negative as signed chars, so exclude them from the < test.
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+        __m128i control = _mm_andnot_si128(_mm_cmplt_epi8(chunk, zero), _mm_cmplt_epi8(chunk, space));
+        int mask = _mm_movemask_epi8(_mm_or_si128(special, control));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; i < len; ++i) {
+        unsigned char c = (unsigned char)data[i];
+        if (c < 0x20 || c == '"' || c == '\\') break;
+    }
+    return i;
+}
+
+size_t JsonWriter::escapedSize(const char* data, size_t len) {
+    size_t size = 0;
+    size_t i = 0;
+    while (i < len) {
+        size_t run = plainPrefix(data + i, len - i);
+        size += run;
+        i += run;
+        if (i == len) break;
+
+        char c = data[i++];
+        switch (c) {
+            case '"': case '\\': case '\n': case '\r': case '\t': case '\b': case '\f': size += 2; break;
+            default: size += 6; break;
+        }
+    }
+    return size;
+}
+
+void JsonWriter::appendEscaped(std::string& out, const char* data, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+
+    // Most text needs no escaping, so reserve for the common case up front
+    out.reserve(out.size() + len + 16);
+
+    size_t i = 0;
+    while (i < len) {
+        size_t run = plainPrefix(data + i, len - i);
+        out.append(data + i, run);
+        i += run;
+        if (i == len) break;
+
+        char c = data[i++];
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default: {
+                char esc[6] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF]};
+                out.append(esc, sizeof(esc));
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Builds compact JSON into a buffer that is kept between documents, so a
+// writer reused across requests stops allocating once it has grown to the
+// largest payload. String values are escaped per RFC 8259; UTF-8 is copied
+// through unchanged.
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t initialCapacity = 1024);
+
+    // Empties the document but keeps the allocated capacity
+    void clear();
+    void reserve(size_t capacity);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view name);
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(long long number);
+    JsonWriter& value(bool flag);
+
+    // Shorthand for key(name).value(text)
+    JsonWriter& field(std::string_view name, std::string_view text);
+
+    // Inserts already-encoded JSON as the next value
+    JsonWriter& raw(std::string_view json);
+
+    // A string value written in pieces: beginString(), any number of
+    // stringPart() (escaped here) or rawStringPart() (already escaped), endString()
+    JsonWriter& beginString();
+    JsonWriter& stringPart(std::string_view text);
+    JsonWriter& rawStringPart(std::string_view escaped);
+    JsonWriter& endString();
+
+    const std::string& str() const;
+    const char* data() const;
+    size_t size() const;
+
+    // Moves the document out; the writer starts over with an empty buffer
+    std::string take();
+
+    // Appends text to out as the body of a JSON string (without quotes)
+    static void appendEscaped(std::string& out, const char* data, size_t len);
+
+    // Number of bytes appendEscaped would append for data
+    static size_t escapedSize(const char* data, size_t len);
+
+private:
+    std::string buffer;
+    std::vector<bool> hasItems; // One entry per open container
+    bool afterKey;
+
+    void separate();
+};
+
+#endif // JSONWRITER_H
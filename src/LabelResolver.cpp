@@ -0,0 +1,283 @@
+#include "LabelResolver.h"
+#include "HttpPipeline.h"
+#include "HttpSession.h"
+#include "IssueCreator.h"
+#include "JsonTokenizer.h"
+#include "JsonWriter.h"
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <set>
+
+namespace {
+
+// Collects "name" from each object of a GET .../labels answer
+class LabelListHandler : public JsonHandler {
+public:
+    JsonTokenizer* tokenizer = nullptr;
+    std::vector<std::string> names;
+
+    bool onKey(const std::string& key) override { return tokenizer->depth() == 2 && key == "name"; }
+    void onString(const std::string& value) override { names.push_back(value); }
+};
+
+std::string foldCase(std::string_view label) {
+    std::string out(label);
+    for (char& c : out) {
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+    }
+    return out;
+}
+
+std::string repoKey(const std::string& owner, const std::string& repo) {
+    return owner + "/" + repo;
+}
+
+std::string labelsUrl(const std::string& owner, const std::string& repo) {
+    return IssueCreator::getApiBaseUrl() + "/repos/" + owner + "/" + repo + "/labels";
+}
+
+// Gitee requires a color for a new label; the web UI's neutral grey
+const char* const NewLabelColor = "ededed";
+
+} // namespace
+
+LabelResolver::LabelResolver(ConfigSetup& config, int ttlSeconds, std::shared_ptr<HttpSession> session,
+                             std::shared_ptr<RequestScheduler> scheduler)
+    : config(config), ttlSeconds(ttlSeconds), createMissing(false),
+      session(session ? std::move(session) : std::make_shared<HttpSession>()),
+      scheduler(scheduler ? std::move(scheduler) : std::make_shared<RequestScheduler>()), configMutex(nullptr),
+      aliasesStale(true) {}
+
+void LabelResolver::setCreateMissing(bool create) {
+    createMissing = create;
+}
+
+void LabelResolver::setConfigMutex(std::mutex* mutex) {
+    configMutex = mutex;
+}
+
+void LabelResolver::reloadAliases() {
+    aliasesStale = true;
+}
+
+std::unique_lock<std::mutex> LabelResolver::lockConfig() {
+    return configMutex ? std::unique_lock<std::mutex>(*configMutex) : std::unique_lock<std::mutex>();
+}
+
+std::string LabelResolver::normalize(std::string_view label) {
+    std::string out;
+    bool space = false;
+    for (char c : label) {
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            space = !out.empty();
+            continue;
+        }
+        if (space) out += ' ';
+        space = false;
+        out += c;
+    }
+    return out;
+}
+
+void LabelResolver::match(const LabelSet& known, const std::string& labels, std::vector<std::string>& found,
+                          std::vector<std::string>& missing) const {
+    std::set<std::string> seen;
+    size_t start = 0;
+    while (start <= labels.size()) {
+        size_t end = labels.find(',', start);
+        if (end == std::string::npos) end = labels.size();
+        std::string name = normalize(std::string_view(labels).substr(start, end - start));
+        start = end + 1;
+        if (name.empty()) continue;
+
+        std::string key = foldCase(name);
+        auto alias = aliases.find(key);
+        if (alias != aliases.end()) {
+            name = alias->second;
+            key = foldCase(name);
+        }
+        if (!seen.insert(key).second) continue;
+
+        auto label = known.find(key);
+        if (label != known.end()) {
+            found.push_back(label->second);
+        } else {
+            missing.push_back(name);
+        }
+    }
+}
+
+bool LabelResolver::prepare(const std::vector<LabelTarget>& targets, std::string& error) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (aliasesStale.exchange(false)) {
+        auto configLock = lockConfig();
+        aliases.clear();
+        for (const auto& alias : config.getLabelAliases()) aliases[foldCase(normalize(alias.first))] = normalize(alias.second);
+    }
+
+    // Repos seen for the first time: from the cache if it is fresh, else from Gitee
+    std::vector<const LabelTarget*> stale;
+    std::set<std::string> looked;
+    long long now = (long long)std::time(nullptr);
+    for (const LabelTarget& target : targets) {
+        std::string key = repoKey(target.owner, target.repo);
+        if (target.labels.empty() || !looked.insert(key).second) continue;
+        auto loaded = loadedAt.find(key);
+        // A TTL of 0 skips the database cache but still fetches each repo only once
+        if (loaded != loadedAt.end() && (ttlSeconds <= 0 || now - loaded->second < ttlSeconds)) continue;
+
+        std::vector<std::string> names;
+        long long fetchedAt = 0;
+        bool cached = false;
+        {
+            auto configLock = lockConfig();
+            cached = config.getRepoLabels(target.owner, target.repo, names, fetchedAt);
+        }
+        if (cached && now - fetchedAt < ttlSeconds) {
+            LabelSet& known = repos[key];
+            known.clear();
+            for (const std::string& name : names) known[foldCase(name)] = name;
+            loadedAt[key] = fetchedAt;
+        } else {
+            stale.push_back(&target);
+        }
+    }
+    if (!stale.empty()) {
+        lock.unlock();
+        if (!fetch(stale, error)) return false;
+        lock.lock();
+    }
+
+    // Every label missing anywhere, each once per repo
+    std::vector<std::pair<const LabelTarget*, std::string>> missing;
+    std::set<std::string> listed;
+    for (const LabelTarget& target : targets) {
+        if (target.labels.empty()) continue;
+        std::vector<std::string> found;
+        std::vector<std::string> lacking;
+        match(repos[repoKey(target.owner, target.repo)], target.labels, found, lacking);
+        for (const std::string& name : lacking) {
+            if (listed.insert(repoKey(target.owner, target.repo) + "\n" + foldCase(name)).second) {
+                missing.emplace_back(&target, name);
+            }
+        }
+    }
+    if (missing.empty()) return true;
+
+    if (!createMissing) {
+        std::map<std::string, std::string> byRepo;
+        for (const auto& item : missing) {
+            std::string& names = byRepo[repoKey(item.first->owner, item.first->repo)];
+            names += (names.empty() ? "\"" : ", \"") + item.second + "\"";
+        }
+        error = missing.size() > 1 ? "Unknown labels" : "Unknown label";
+        for (const auto& repo : byRepo) {
+            error += (repo.first == byRepo.begin()->first ? " in " : "; in ") + repo.first + ": " + repo.second;
+        }
+        error += " (add --create-labels to create them, or --label-alias to map them to existing ones)";
+        return false;
+    }
+    lock.unlock();
+    return create(missing, error);
+}
+
+bool LabelResolver::resolve(const std::string& owner, const std::string& repo, const std::string& token,
+                            std::string& labels, std::string& error) {
+    if (labels.empty()) return true;
+    LabelTarget target{owner, repo, token, labels};
+    if (!prepare({target}, error)) return false;
+
+    std::vector<std::string> found;
+    std::vector<std::string> missing;
+    std::lock_guard<std::mutex> lock(mutex);
+    match(repos[repoKey(owner, repo)], labels, found, missing);
+    labels.clear();
+    for (const std::string& name : found) {
+        if (!labels.empty()) labels += ',';
+        labels += name;
+    }
+    return true;
+}
+
+bool LabelResolver::fetch(const std::vector<const LabelTarget*>& targets, std::string& error) {
+    HttpPipeline pipeline(std::max(1, scheduler->getOptions().maxConcurrency), session, scheduler);
+    for (const LabelTarget* target : targets) {
+        HttpRequest request;
+        request.method = "GET";
+        request.url = labelsUrl(target->owner, target->repo) + "?access_token=" + IssueCreator::urlEncode(target->token);
+        request.rateKey = target->token;
+        pipeline.submit(std::move(request), [this, target, &error](const HttpResponse& response) {
+            std::string key = repoKey(target->owner, target->repo);
+            LabelListHandler handler;
+            JsonTokenizer tokenizer(handler);
+            handler.tokenizer = &tokenizer;
+            if (!response.error.empty()) {
+                if (error.empty()) error = "Failed to fetch the labels of " + key + ": " + response.error;
+                return;
+            }
+            if (response.status != 200 || !tokenizer.feed(response.body.data(), response.body.size()) ||
+                !tokenizer.finish()) {
+                if (error.empty()) {
+                    error = "Failed to fetch the labels of " + key + ": HTTP " + std::to_string(response.status) +
+                            ": " + response.body.substr(0, 200);
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            {
+                auto configLock = lockConfig();
+                config.saveRepoLabels(target->owner, target->repo, handler.names);
+            }
+            LabelSet& known = repos[key];
+            known.clear();
+            for (const std::string& name : handler.names) known[foldCase(name)] = name;
+            loadedAt[key] = (long long)std::time(nullptr);
+        });
+    }
+    pipeline.run();
+    return error.empty();
+}
+
+bool LabelResolver::create(const std::vector<std::pair<const LabelTarget*, std::string>>& missing,
+                           std::string& error) {
+    HttpPipeline pipeline(std::max(1, scheduler->getOptions().maxConcurrency), session, scheduler);
+    JsonWriter writer;
+    for (const auto& item : missing) {
+        const LabelTarget* target = item.first;
+        const std::string& name = item.second;
+        writer.clear();
+        writer.beginObject();
+        writer.field("access_token", target->token);
+        writer.field("name", name);
+        writer.field("color", NewLabelColor);
+        writer.endObject();
+
+        HttpRequest request;
+        request.url = labelsUrl(target->owner, target->repo);
+        request.body = writer.take();
+        request.headers.push_back("Content-Type: application/json;charset=UTF-8");
+        request.rateKey = target->token;
+        pipeline.submit(std::move(request), [this, target, name, &error](const HttpResponse& response) {
+            std::string key = repoKey(target->owner, target->repo);
+            if (!response.error.empty() || response.status != 201) {
+                if (error.empty()) {
+                    error = "Failed to create label \"" + name + "\" in " + key + ": " +
+                            (response.error.empty() ? "HTTP " + std::to_string(response.status) + ": " +
+                                                          response.body.substr(0, 200)
+                                                    : response.error);
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            {
+                auto configLock = lockConfig();
+                config.addRepoLabels(target->owner, target->repo, {name});
+            }
+            repos[key][foldCase(name)] = name;
+            std::cerr << "🏷️ Created label \"" << name << "\" in " << key << std::endl;
+        });
+    }
+    pipeline.run();
+    return error.empty();
+}
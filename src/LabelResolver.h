@@ -0,0 +1,92 @@
+#ifndef LABELRESOLVER_H
+#define LABELRESOLVER_H
+
+#include "ConfigSetup.h"
+#include "RequestScheduler.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class HttpSession;
+
+// A repo and the comma-separated labels an issue for it will carry
+struct LabelTarget {
+    std::string owner;
+    std::string repo;
+    std::string token;
+    std::string labels;
+};
+
+// Checks --labels against each repo's label set before anything is sent, so a
+// typo fails at once instead of on every request. Label sets are cached in the
+// config database and fetched again once older than the TTL (0: fetched once
+// per run). Sets held in memory expire too, so a long-running --daemon sees
+// labels added on Gitee. A label matches
+// regardless of case and of extra whitespace, aliases (see ConfigSetup) are
+// applied first, and the repo's own spelling is what gets sent.
+// Safe to call from several threads. No lock is held while labels are fetched
+// or created, so one slow repo does not hold up requests for the others.
+class LabelResolver {
+public:
+    LabelResolver(ConfigSetup& config, int ttlSeconds, std::shared_ptr<HttpSession> session = nullptr,
+                  std::shared_ptr<RequestScheduler> scheduler = nullptr);
+
+    // Create labels a repo does not have instead of failing. Off by default.
+    void setCreateMissing(bool create);
+
+    // A mutex that other threads hold while they use config; taken around every
+    // config access from here. Set before the resolver is used.
+    void setConfigMutex(std::mutex* mutex);
+
+    // Loads the label sets of every target's repo; those not cached, or cached
+    // longer than the TTL, are fetched concurrently. With setCreateMissing, all
+    // labels the targets use that their repo lacks are then created in one
+    // concurrent round. Returns false with error if a fetch or creation fails or
+    // a label is unknown.
+    bool prepare(const std::vector<LabelTarget>& targets, std::string& error);
+
+    // Rewrites labels as owner/repo spells them, loading the repo's label set
+    // first if prepare() did not. Returns false with error like prepare().
+    bool resolve(const std::string& owner, const std::string& repo, const std::string& token, std::string& labels,
+                 std::string& error);
+
+    // Reads the aliases again on next use, after another process changed them.
+    // Takes no lock, so it may be called while holding the config mutex.
+    void reloadAliases();
+
+    // Trims a label and collapses runs of whitespace inside it to one space
+    static std::string normalize(std::string_view label);
+
+private:
+    // Lower-cased label -> the label as the repo spells it
+    using LabelSet = std::map<std::string, std::string>;
+
+    ConfigSetup& config;
+    int ttlSeconds;
+    bool createMissing;
+    std::shared_ptr<HttpSession> session;
+    std::shared_ptr<RequestScheduler> scheduler;
+    std::mutex* configMutex;
+    std::atomic<bool> aliasesStale;
+
+    // Lock order: mutex, then configMutex. Neither is held across a request.
+    std::mutex mutex;                           // Guards the members below
+    std::map<std::string, std::string> aliases; // Lower-cased alias -> label
+    std::map<std::string, LabelSet> repos;      // "owner/repo" -> its labels
+    std::map<std::string, long long> loadedAt;  // "owner/repo" -> when its labels were fetched
+
+    std::unique_lock<std::mutex> lockConfig();
+    bool fetch(const std::vector<const LabelTarget*>& targets, std::string& error);
+    bool create(const std::vector<std::pair<const LabelTarget*, std::string>>& missing, std::string& error);
+
+    // Splits labels into the repo's names for them and the ones it lacks, each
+    // once. Called with mutex held.
+    void match(const LabelSet& known, const std::string& labels, std::vector<std::string>& found,
+               std::vector<std::string>& missing) const;
+};
+
+#endif // LABELRESOLVER_H
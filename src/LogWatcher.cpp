@@ -0,0 +1,402 @@
+#include "LogWatcher.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::atomic<bool> stopRequested(false);
+
+static void onStopSignal(int) {
+    stopRequested = true;
+}
+
+namespace {
+
+const size_t ReadBufferSize = 64 * 1024;
+const size_t MaxTitleBytes = 120;
+// How often an idle input is checked for new data, rotation and closed windows
+const int IdlePollMs = 200;
+
+bool isWordChar(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// The longest run of characters every match of pattern contains, or "" if that
+// cannot be told without fully parsing the regex (alternation anywhere)
+std::string requiredLiteral(const std::string& pattern) {
+    if (pattern.find('|') != std::string::npos) return "";
+    std::string best;
+    std::string run;
+    int depth = 0;
+    auto endRun = [&best, &run]() {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char c = pattern[i];
+        if (c == '\\' && i + 1 < pattern.size()) {
+            c = pattern[++i];
+            // \d, \w, \b, \x41 and the like are classes or assertions, not this character
+            if (isWordChar((unsigned char)c)) {
+                endRun();
+                continue;
+            }
+        } else if (c == '[') {
+            endRun();
+            if (i + 1 < pattern.size() && pattern[i + 1] == '^') ++i;
+            if (i + 1 < pattern.size() && pattern[i + 1] == ']') ++i;
+            while (++i < pattern.size() && pattern[i] != ']') {
+                if (pattern[i] == '\\') ++i;
+            }
+            continue;
+        } else if (c == '{') {
+            // A bounded quantifier: its digits are not text to match, and it may allow zero
+            if (!run.empty()) run.pop_back();
+            endRun();
+            while (++i < pattern.size() && pattern[i] != '}') {
+            }
+            continue;
+        } else if (c == '(' || c == ')') {
+            // Anything inside a group may be optional or repeated as a whole
+            endRun();
+            depth += c == '(' ? 1 : -1;
+            continue;
+        } else if (std::strchr(".^$*+?}", c)) {
+            // A quantifier that allows zero makes the character before it optional
+            if ((c == '*' || c == '?') && !run.empty()) run.pop_back();
+            endRun();
+            continue;
+        }
+        if (depth == 0) run += c;
+    }
+    endRun();
+    return best;
+}
+
+bool hasRegexSyntax(const std::string& pattern) {
+    return pattern.find_first_of("\\.^$*+?()[]{}|") != std::string::npos;
+}
+
+// Cuts text to at most max bytes without splitting a UTF-8 character
+std::string_view cutUtf8(std::string_view text, size_t max) {
+    if (text.size() <= max) return text;
+    size_t end = max;
+    while (end > 0 && ((unsigned char)text[end] & 0xC0) == 0x80) --end;
+    return text.substr(0, end);
+}
+
+std::string formatTime(std::time_t t) {
+    std::tm tm;
+    gmtime_r(&t, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    return buf;
+}
+
+} // namespace
+
+bool SignatureMatcher::addPattern(const std::string& pattern, std::string& error) {
+    if (pattern.empty()) {
+        error = "empty pattern";
+        return false;
+    }
+    Pattern compiled;
+    compiled.plain = !hasRegexSyntax(pattern);
+    compiled.literal = compiled.plain ? pattern : requiredLiteral(pattern);
+    compiled.hasGroup = false;
+    if (!compiled.plain) {
+        try {
+            compiled.regex.assign(pattern, std::regex::ECMAScript | std::regex::optimize);
+        } catch (const std::regex_error& e) {
+            error = e.what();
+            return false;
+        }
+        compiled.hasGroup = compiled.regex.mark_count() > 0;
+    }
+    patterns.push_back(std::move(compiled));
+    return true;
+}
+
+bool SignatureMatcher::empty() const {
+    return patterns.empty();
+}
+
+bool SignatureMatcher::match(std::string_view line, std::string_view& signature) const {
+    for (const Pattern& pattern : patterns) {
+        size_t at = pattern.literal.empty() ? 0 : line.find(pattern.literal);
+        if (at == std::string_view::npos) continue;
+        if (pattern.plain) {
+            // From the start of the word, so "Exception" keeps its "java.lang.NullPointer"
+            while (at > 0 && line[at - 1] != ' ' && line[at - 1] != '\t') --at;
+            signature = line.substr(at);
+            return true;
+        }
+
+        std::cmatch m;
+        if (!std::regex_search(line.data(), line.data() + line.size(), m, pattern.regex)) continue;
+        size_t group = pattern.hasGroup && m[1].matched ? 1 : 0;
+        size_t start = (size_t)m.position(group);
+        signature = group ? line.substr(start, (size_t)m.length(1)) : line.substr(start);
+        return true;
+    }
+    return false;
+}
+
+uint64_t SignatureMatcher::fingerprint(std::string_view signature, std::string& normalized) {
+    normalized.clear();
+    size_t i = 0;
+    while (i < signature.size()) {
+        unsigned char c = (unsigned char)signature[i];
+        if (isWordChar(c)) {
+            size_t start = i;
+            bool digit = false;
+            for (; i < signature.size() && isWordChar((unsigned char)signature[i]); ++i) {
+                digit = digit || (signature[i] >= '0' && signature[i] <= '9');
+            }
+            if (digit) {
+                normalized += '#';
+            } else {
+                normalized.append(signature, start, i - start);
+            }
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            while (i < signature.size() && (signature[i] == ' ' || signature[i] == '\t' || signature[i] == '\r')) ++i;
+            if (!normalized.empty() && i < signature.size()) normalized += ' ';
+        } else {
+            normalized += (char)c;
+            ++i;
+        }
+    }
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : normalized) {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+const std::vector<std::string>& SignatureMatcher::defaultPatterns() {
+    static const std::vector<std::string> patterns = {"FATAL", "ERROR", "CRITICAL", "panic:", "Traceback",
+                                                      "Exception"};
+    return patterns;
+}
+
+LogWatcher::LogWatcher(const Options& options, SignatureMatcher matcher, IssueCallback onIssue)
+    : options(options), matcher(std::move(matcher)), onIssue(std::move(onIssue)) {
+    if (this->options.maxGroups == 0) this->options.maxGroups = 1;
+}
+
+const LogWatcher::Stats& LogWatcher::getStats() const {
+    return stats;
+}
+
+void LogWatcher::feed(const char* data, size_t len) {
+    // One clock read per chunk; lines of one read count as arriving together
+    Clock::time_point now = Clock::now();
+    std::time_t wallTime = std::time(nullptr);
+    stats.bytes += len;
+
+    const char* end = data + len;
+    while (data < end) {
+        const char* newline = (const char*)std::memchr(data, '\n', (size_t)(end - data));
+        size_t size = (size_t)((newline ? newline : end) - data);
+        if (!partial.empty() || !newline) {
+            size_t room = options.maxLineBytes > partial.size() ? options.maxLineBytes - partial.size() : 0;
+            partial.append(data, std::min(room, size));
+            if (newline) {
+                line(partial, now, wallTime);
+                partial.clear();
+            }
+        } else {
+            line(std::string_view(data, std::min(size, options.maxLineBytes)), now, wallTime);
+        }
+        data = newline ? newline + 1 : end;
+    }
+    flushExpired(now);
+}
+
+void LogWatcher::finish() {
+    if (!partial.empty()) {
+        line(partial, Clock::now(), std::time(nullptr));
+        partial.clear();
+    }
+    while (!order.empty()) fileOldest();
+}
+
+void LogWatcher::line(std::string_view text, Clock::time_point now, std::time_t wallTime) {
+    ++stats.lines;
+    if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+
+    std::string_view signature;
+    if (!matcher.match(text, signature)) return;
+    ++stats.matched;
+
+    uint64_t fingerprint = SignatureMatcher::fingerprint(signature, normalized);
+    auto found = groups.find(fingerprint);
+    if (found == groups.end()) {
+        if (groups.size() >= options.maxGroups) fileOldest();
+        found = groups.emplace(fingerprint, Group()).first;
+        Group& group = found->second;
+        group.signature = cutUtf8(signature, options.maxLineBytes);
+        group.normalized = normalized;
+        group.opened = now;
+        group.firstSeen = wallTime;
+        order.push_back(fingerprint);
+    }
+
+    Group& group = found->second;
+    ++group.count;
+    group.lastSeen = wallTime;
+    if (group.samples.size() < options.samples) group.samples.emplace_back(text);
+}
+
+void LogWatcher::flushExpired(Clock::time_point now) {
+    const auto window = std::chrono::seconds(options.windowSeconds);
+    while (!order.empty() && now - groups[order.front()].opened >= window) fileOldest();
+}
+
+void LogWatcher::fileOldest() {
+    uint64_t fingerprint = order.front();
+    order.pop_front();
+    auto found = groups.find(fingerprint);
+    Group& group = found->second;
+
+    auto previous = filed.find(fingerprint);
+    if (previous == filed.end()) {
+        if (filed.size() >= options.maxFiled) {
+            filed.erase(filedOrder.front());
+            filedOrder.pop_front();
+        }
+        previous = filed.emplace(fingerprint, Filed()).first;
+        previous->second.firstSeen = group.firstSeen;
+        filedOrder.push_back(fingerprint);
+    }
+    Filed& history = previous->second;
+    history.occurrences += group.count;
+    ++history.windows;
+
+    WatchedError error;
+    error.fingerprint = fingerprint;
+    error.occurrences = history.occurrences;
+    error.windows = history.windows;
+
+    // Titles are kept short; the full signature is in the body
+    std::string_view title = group.signature;
+    while (!title.empty() && (title.front() == ' ' || title.front() == '\t')) title.remove_prefix(1);
+    while (!title.empty() && (title.back() == ' ' || title.back() == '\t')) title.remove_suffix(1);
+    error.title = cutUtf8(title, MaxTitleBytes);
+    if (error.title.size() < title.size()) error.title += "…";
+    if (error.title.empty()) error.title = group.normalized.empty() ? "Error" : group.normalized;
+
+    std::string& body = error.body;
+    body = "Seen " + std::to_string(history.occurrences) + (history.occurrences == 1 ? " time" : " times");
+    if (!sourceName.empty()) body += " in `" + sourceName + "`";
+    body += history.firstSeen == group.lastSeen ? " at " + formatTime(history.firstSeen)
+                                                : " between " + formatTime(history.firstSeen) + " and " +
+                                                      formatTime(group.lastSeen);
+    body += " UTC";
+    if (history.windows > 1) {
+        body += ", in " + std::to_string(history.windows) + " windows of " + std::to_string(options.windowSeconds) +
+                "s; " + std::to_string(group.count) + " in the last one, from " + formatTime(group.firstSeen);
+    }
+    body += ".\n\nSignature: `" + group.normalized + "`\n\n";
+    if (history.windows > 1) {
+        body += "Lines from the last window:\n\n```\n";
+    } else {
+        body += group.samples.size() < group.count ? "First lines:\n\n```\n" : "Lines:\n\n```\n";
+    }
+    for (const std::string& sample : group.samples) body += sample + "\n";
+    body += "```\n";
+    if (group.samples.size() < group.count) {
+        body += "\n…and " + std::to_string(group.count - group.samples.size()) + " more.\n";
+    }
+
+    groups.erase(found);
+    ++stats.issues;
+    onIssue(std::move(error));
+}
+
+int LogWatcher::run(const std::string& source) {
+    bool follow = source != "-";
+    int fd = STDIN_FILENO;
+    ino_t inode = 0;
+    if (follow) {
+        fd = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            std::cerr << "❌ Failed to open " << source << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) ::close(fd);
+            return 1;
+        }
+        inode = st.st_ino;
+        // Like tail -f: only what is written from now on
+        ::lseek(fd, 0, SEEK_END);
+    }
+    sourceName = follow ? source : "stdin";
+
+    stopRequested = false;
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    std::vector<char> buffer(ReadBufferSize);
+    int rc = 0;
+    while (!stopRequested) {
+        if (!follow) {
+            // A pipe may stay quiet for a long time; windows still have to close
+            pollfd pfd = {fd, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, IdlePollMs);
+            if (ready <= 0) {
+                if (ready < 0 && errno != EINTR) break;
+                flushExpired(Clock::now());
+                continue;
+            }
+        }
+
+        ssize_t n = ::read(fd, buffer.data(), buffer.size());
+        if (n > 0) {
+            feed(buffer.data(), (size_t)n);
+            continue;
+        }
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            std::cerr << "❌ Failed to read " << sourceName << ": " << std::strerror(errno) << std::endl;
+            rc = 1;
+            break;
+        }
+        if (!follow) break;
+
+        // At the end of the file: a new file at the path means it was rotated,
+        // a shorter one that it was truncated. Either way, read the new content.
+        flushExpired(Clock::now());
+        struct stat st;
+        if (::stat(source.c_str(), &st) == 0) {
+            if (st.st_ino != inode) {
+                int reopened = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+                if (reopened >= 0) {
+                    ::close(fd);
+                    fd = reopened;
+                    inode = st.st_ino;
+                    continue;
+                }
+            } else if (st.st_size < ::lseek(fd, 0, SEEK_CUR)) {
+                ::lseek(fd, 0, SEEK_SET);
+                continue;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(IdlePollMs));
+    }
+
+    if (follow) ::close(fd);
+    finish();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    return rc;
+}
@@ -0,0 +1,142 @@
+#ifndef LOGWATCHER_H
+#define LOGWATCHER_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Finds error lines and the part of them that identifies the error.
+// Every pattern has a literal that any match must contain, when one can be
+// told from the pattern; lines without it are skipped with a substring search,
+// so the regex only runs on lines that are likely to match.
+class SignatureMatcher {
+public:
+    // pattern is an ECMAScript regex; one without regex syntax is a plain
+    // substring. The signature is the first capture group if the pattern has
+    // one, else the line from the start of the match (of the matched word, for
+    // a substring). Returns false with error if the regex does not compile.
+    bool addPattern(const std::string& pattern, std::string& error);
+
+    bool empty() const;
+
+    // Tries the patterns in order; on the first match, points signature into line
+    bool match(std::string_view line, std::string_view& signature) const;
+
+    // Hashes signature with every word that contains a digit (ids, addresses,
+    // counts, times) masked as '#' and runs of whitespace collapsed, so repeats
+    // of one error share a fingerprint. normalized receives the masked text.
+    static uint64_t fingerprint(std::string_view signature, std::string& normalized);
+
+    // Used when no --watch-pattern is given
+    static const std::vector<std::string>& defaultPatterns();
+
+private:
+    struct Pattern {
+        std::string literal; // Must occur in a match; "" if unknown
+        bool plain;          // literal is the whole pattern, no regex needed
+        bool hasGroup;
+        std::regex regex;
+    };
+
+    std::vector<Pattern> patterns;
+};
+
+// Errors of one signature coalesced over a window, ready to be filed. An error
+// that keeps occurring is reported again for every window it occurs in, with
+// counts that cover all of them, so its first issue can be updated.
+struct WatchedError {
+    std::string title;
+    std::string body;
+    uint64_t fingerprint = 0;
+    size_t occurrences = 0; // Since the error was first seen
+    size_t windows = 1;     // Above 1, this error was reported before
+};
+
+// Turns a stream of log lines into issues: lines are split from raw reads,
+// matched against the patterns and fingerprinted, and all occurrences of one
+// fingerprint within windowSeconds of its first become one WatchedError with
+// a count and sample lines. Memory is bounded by the options, whatever the
+// input: lines are cut at maxLineBytes and at most maxGroups signatures are
+// open at once (the oldest is filed early to make room); the counts of at most
+// maxFiled filed signatures are kept for later windows. Single-threaded; the
+// callback should hand the issue off rather than send it itself.
+class LogWatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+    using IssueCallback = std::function<void(WatchedError&&)>;
+
+    struct Options {
+        int windowSeconds = 60;
+        size_t samples = 5;         // Lines quoted in each issue body
+        size_t maxGroups = 1024;
+        size_t maxFiled = 16384;
+        size_t maxLineBytes = 4096;
+    };
+
+    struct Stats {
+        uint64_t bytes = 0;
+        uint64_t lines = 0;
+        uint64_t matched = 0;
+        uint64_t issues = 0;
+    };
+
+    LogWatcher(const Options& options, SignatureMatcher matcher, IssueCallback onIssue);
+
+    // Reads source until SIGINT or SIGTERM, then files every open signature.
+    // A file is followed like tail -F: reading starts at its current end, and a
+    // rotated or truncated file is picked up from its start. "-" reads stdin
+    // until it ends. Returns a process exit code.
+    int run(const std::string& source);
+
+    // The stages run() drives, for callers with their own input: raw bytes in,
+    // issues out through the callback as their windows close
+    void feed(const char* data, size_t len);
+    // Ends a last line without a newline and files every open signature
+    void finish();
+
+    const Stats& getStats() const;
+
+private:
+    struct Group {
+        std::string signature; // As first logged
+        std::string normalized;
+        size_t count = 0;
+        Clock::time_point opened;
+        std::time_t firstSeen = 0;
+        std::time_t lastSeen = 0;
+        std::vector<std::string> samples;
+    };
+
+    Options options;
+    SignatureMatcher matcher;
+    IssueCallback onIssue;
+    std::string sourceName;
+    std::unordered_map<uint64_t, Group> groups;
+    // What earlier windows of a filed signature added up to
+    struct Filed {
+        size_t occurrences = 0;
+        size_t windows = 0;
+        std::time_t firstSeen = 0;
+    };
+
+    std::deque<uint64_t> order; // Open fingerprints, oldest first
+    std::unordered_map<uint64_t, Filed> filed;
+    std::deque<uint64_t> filedOrder; // Filed fingerprints, first filed first
+    std::string partial;        // A line split across reads
+    std::string normalized;     // Scratch for fingerprint()
+    Stats stats;
+
+    void line(std::string_view text, Clock::time_point now, std::time_t wallTime);
+    void flushExpired(Clock::time_point now);
+    // Files the oldest open signature
+    void fileOldest();
+};
+
+#endif // LOGWATCHER_H
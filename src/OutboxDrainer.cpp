@@ -0,0 +1,135 @@
+#include "OutboxDrainer.h"
+#include "Hasher.h"
+#include "HttpPipeline.h"
+#include "IssueCreator.h"
+#include "IssueDedup.h"
+#include "IssueResponseParser.h"
+#include "JsonWriter.h"
+#include <ctime>
+#include <iostream>
+
+OutboxDrainer::OutboxDrainer(ConfigSetup& config, std::shared_ptr<RequestScheduler> scheduler,
+                             std::shared_ptr<HttpSession> session, int batchSize)
+    : config(config), scheduler(scheduler ? std::move(scheduler) : std::make_shared<RequestScheduler>()),
+      session(session ? std::move(session) : std::make_shared<HttpSession>()), batchSize(batchSize),
+      hasher(ConfigSetup::getKey()) {}
+
+std::string OutboxDrainer::resolveToken(const OutboxItem& item) {
+    std::string encrypted = item.encrypted_token;
+    if (encrypted.empty()) {
+        // Look up each distinct repo once through the (owner, repo) index
+        std::string key = item.owner + "/" + item.repo;
+        auto it = repoTokens.find(key);
+        if (it == repoTokens.end()) {
+            RepoConfig cfg;
+            if (config.getConfig(item.owner, item.repo, cfg) || config.getDefaultRepoConfig(cfg)) {
+                it = repoTokens.emplace(key, cfg.encrypted_token).first;
+            } else {
+                it = repoTokens.emplace(key, "").first;
+            }
+        }
+        if (it->second.empty()) return "";
+        encrypted = it->second;
+    }
+
+    auto cached = decryptedTokens.find(encrypted);
+    if (cached != decryptedTokens.end()) return cached->second;
+
+    std::string token;
+    try {
+        token = hasher.decrypt(encrypted);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Failed to decrypt token: " << e.what() << std::endl;
+    }
+    decryptedTokens[encrypted] = token;
+    return token;
+}
+
+size_t OutboxDrainer::drain(const ResultCallback& onResult) {
+    HttpPipeline pipeline(scheduler->getOptions().maxConcurrency, session, scheduler);
+    JsonWriter writer;
+    size_t failures = 0;
+
+    for (;;) {
+        std::vector<OutboxItem> items = config.claimOutboxBatch(batchSize);
+        if (items.empty()) break;
+
+        std::vector<OutboxResult> results(items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            const OutboxItem& item = items[i];
+            OutboxResult& result = results[i];
+            result.id = item.id;
+
+            if (item.reclaimed) {
+                KnownIssue known;
+                long long hash = (long long)IssueDedup::contentHash(item.owner, item.repo, item.title, item.body);
+                if (config.findKnownIssue(hash, item.createdAt, known)) {
+                    // Created by the worker that died, or identical to an issue created since it was queued
+                    result.success = true;
+                    result.issueId = known.issueId;
+                    result.issueNumber = known.issueNumber;
+                    result.htmlUrl = known.htmlUrl;
+                    continue;
+                }
+            }
+
+            std::string token = resolveToken(item);
+            if (token.empty()) {
+                result.error = "No access token configured for " + item.owner + "/" + item.repo;
+                continue;
+            }
+
+            HttpRequest request;
+            request.url = IssueCreator::issuesUrl(item.owner);
+            IssueCreator::buildRequestBody(writer, token, item.repo, item.title, item.body, item.labels);
+            request.body = writer.take();
+            request.headers.push_back("Content-Type: application/json;charset=UTF-8");
+            request.rateKey = token;
+
+            auto parser = std::make_shared<IssueResponseParser>();
+            request.onData = [parser](const char* data, size_t len) { parser->feed(data, len); };
+            request.onRetry = [parser]() { parser->reset(); };
+
+            pipeline.submit(std::move(request), [this, parser, &item, &result](const HttpResponse& response) {
+                if (!response.error.empty()) {
+                    // Once the request may have reached Gitee, sending it again could create a second issue
+                    result.retry = response.failedBeforeSending;
+                    result.error = "Curl error: " + response.error;
+                    if (!result.retry) result.error += " (the issue may have been created; not sent again)";
+                } else if (response.status != 201) {
+                    result.error = "HTTP " + std::to_string(response.status) + ": " + parser->getSnippet();
+                    // Throttling and server errors are worth another drain pass; 4xx will not change
+                    result.retry = response.status == 429 || response.status >= 500;
+                } else {
+                    IssueResult issue;
+                    parser->fill(issue);
+                    result.success = true;
+                    result.issueId = issue.id;
+                    result.issueNumber = issue.number;
+                    result.htmlUrl = issue.htmlUrl;
+
+                    // Saved now rather than with the batch, so a crash before then cannot lose it
+                    if (issue.id < 0) return;
+                    KnownIssue known;
+                    known.issueId = issue.id;
+                    known.issueNumber = issue.number;
+                    known.htmlUrl = issue.htmlUrl;
+                    known.createdAt = (long long)std::time(nullptr);
+                    config.saveKnownIssue((long long)IssueDedup::contentHash(item.owner, item.repo, item.title,
+                                                                             item.body),
+                                          item.owner, item.repo, known);
+                }
+            });
+        }
+        pipeline.run();
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (!results[i].success) ++failures;
+            onResult(items[i], results[i]);
+        }
+        if (!config.recordOutboxResults(results)) {
+            std::cerr << "❌ Failed to record outbox results; items will be retried after they go stale." << std::endl;
+        }
+    }
+    return failures;
+}
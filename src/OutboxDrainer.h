@@ -0,0 +1,44 @@
+#ifndef OUTBOXDRAINER_H
+#define OUTBOXDRAINER_H
+
+#include "ConfigSetup.h"
+#include "Hasher.h"
+#include "HttpSession.h"
+#include "RequestScheduler.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+// Sends issues queued in the outbox. Items are claimed in batches, sent
+// concurrently through HttpPipeline, and each batch's outcome is written back
+// in one transaction. Several drainers may run against the same database.
+// Each created issue is saved to the dedup index (see IssueDedup) as soon as
+// its answer arrives. An item reclaimed from a worker that died mid-batch is
+// looked up there first, so an issue created before the crash is not sent
+// again. One whose answer never arrived can still be sent twice.
+class OutboxDrainer {
+public:
+    using ResultCallback = std::function<void(const OutboxItem&, const OutboxResult&)>;
+
+    // Connections in the session stay open between drain() calls. A private session is created when none is passed.
+    OutboxDrainer(ConfigSetup& config, std::shared_ptr<RequestScheduler> scheduler,
+                  std::shared_ptr<HttpSession> session = nullptr, int batchSize = 100);
+
+    // Sends queued items until the outbox is empty. Returns the number of failed sends.
+    size_t drain(const ResultCallback& onResult);
+
+private:
+    ConfigSetup& config;
+    std::shared_ptr<RequestScheduler> scheduler;
+    std::shared_ptr<HttpSession> session;
+    int batchSize;
+    std::map<std::string, std::string> repoTokens;      // "owner/repo" -> encrypted token ("" if none)
+    std::map<std::string, std::string> decryptedTokens; // encrypted -> plain, each decrypted once
+    Hasher hasher;
+
+    // Returns the plain token for an item, or an empty string if none is configured
+    std::string resolveToken(const OutboxItem& item);
+};
+
+#endif // OUTBOXDRAINER_H
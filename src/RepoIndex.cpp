@@ -0,0 +1,118 @@
+#include "RepoIndex.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char Header[] = "gitee-issue repo index 1\n";
+const size_t HeaderLen = sizeof(Header) - 1;
+
+} // namespace
+
+RepoIndex::RepoIndex() : map(nullptr), mapSize(0), dataStart(0) {}
+
+RepoIndex::~RepoIndex() {
+    if (map) munmap(map, mapSize);
+}
+
+bool RepoIndex::write(const std::string& path, const std::vector<std::pair<std::string, std::string>>& repos) {
+    std::vector<std::string> lines;
+    lines.reserve(repos.size() * 2);
+    for (const auto& repo : repos) {
+        lines.push_back("/" + repo.second + "\t" + repo.first);
+        lines.push_back(repo.first + "/" + repo.second);
+    }
+    std::sort(lines.begin(), lines.end());
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file << Header;
+        for (const std::string& line : lines) file << line << '\n';
+        if (!file.flush()) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RepoIndex::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < HeaderLen) {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    if (std::memcmp(data, Header, HeaderLen) != 0) {
+        munmap(data, (size_t)st.st_size);
+        return false;
+    }
+
+    if (map) munmap(map, mapSize);
+    map = data;
+    mapSize = (size_t)st.st_size;
+    dataStart = HeaderLen;
+    return true;
+}
+
+size_t RepoIndex::lowerBound(std::string_view key) const {
+    const char* data = (const char*)map;
+    size_t lo = dataStart;
+    size_t hi = mapSize;
+    // lo and hi always sit at the start of a line
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        while (mid > lo && data[mid - 1] != '\n') --mid;
+        const char* newline = (const char*)std::memchr(data + mid, '\n', mapSize - mid);
+        size_t end = newline ? (size_t)(newline - data) : mapSize;
+        if (std::string_view(data + mid, end - mid) < key) {
+            lo = end + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return std::min(lo, mapSize);
+}
+
+size_t RepoIndex::complete(std::string_view prefix, std::string& out) const {
+    if (!map) return 0;
+    const char* data = (const char*)map;
+    bool byRepo = !prefix.empty() && prefix[0] == '/';
+
+    size_t count = 0;
+    for (size_t pos = lowerBound(prefix); pos < mapSize;) {
+        const char* newline = (const char*)std::memchr(data + pos, '\n', mapSize - pos);
+        size_t end = newline ? (size_t)(newline - data) : mapSize;
+        std::string_view line(data + pos, end - pos);
+        if (line.compare(0, prefix.size(), prefix) != 0) break;
+        pos = end + 1;
+        if (byRepo) {
+            size_t tab = line.find('\t');
+            if (tab == std::string_view::npos) break;
+            out.append(line.substr(tab + 1)).append("/").append(line.substr(1, tab - 1));
+        } else if (line[0] != '/') {
+            // Only an empty prefix reaches the repo-name lines here
+            out.append(line);
+        } else {
+            continue;
+        }
+        out += '\n';
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,47 @@
+#ifndef REPOINDEX_H
+#define REPOINDEX_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Configured repo names for shell completion, in a file that can be searched
+// without opening the config database. It is plain text, one sorted line per
+// entry after a version line:
+//   /repo<TAB>owner    every repo by name ('/' sorts first, so these come first)
+//   owner/repo         every repo by owner
+// A lookup maps the file and binary-searches the lines, so it costs the same
+// with ten repos or ten thousand. ConfigSetup rewrites the file whenever the
+// set of repos changes.
+class RepoIndex {
+public:
+    RepoIndex();
+    ~RepoIndex();
+
+    RepoIndex(const RepoIndex&) = delete;
+    RepoIndex& operator=(const RepoIndex&) = delete;
+
+    // Replaces the index at path with the given (owner, repo) pairs. Written to a
+    // temporary file and renamed, so readers never see a partial index.
+    static bool write(const std::string& path, const std::vector<std::pair<std::string, std::string>>& repos);
+
+    // Returns false if the file is missing or not an index
+    bool open(const std::string& path);
+
+    // Appends "owner/repo\n" for every repo whose "owner/repo" starts with prefix,
+    // in sorted order. A prefix starting with '/' matches repo names instead,
+    // whatever the owner. Returns the number of matches.
+    size_t complete(std::string_view prefix, std::string& out) const;
+
+private:
+    void* map;
+    size_t mapSize;
+    size_t dataStart; // First byte after the version line
+
+    // Offset of the first line that is not less than key
+    size_t lowerBound(std::string_view key) const;
+};
+
+#endif // REPOINDEX_H
@@ -0,0 +1,224 @@
+#include "RequestMetrics.h"
+#include "JsonWriter.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char* const PhaseNames[RequestMetrics::PhaseCount] = {"dns", "connect", "tls", "first_byte", "total"};
+
+// Prometheus bucket bounds; the exact histograms are folded into these on export
+const double SecondsBounds[] = {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30};
+const double BytesBounds[] = {256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304};
+
+std::string formatNumber(double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+uint64_t elapsedUs(curl_off_t from, curl_off_t to) {
+    return to > from ? (uint64_t)(to - from) : 0;
+}
+
+void writeSummary(JsonWriter& out, const Histogram& h) {
+    out.beginObject();
+    out.key("count").value((long long)h.getCount());
+    out.key("min").value((long long)h.getMin());
+    out.key("mean").raw(formatNumber(h.getMean()));
+    out.key("p50").value((long long)h.valueAtQuantile(0.50));
+    out.key("p90").value((long long)h.valueAtQuantile(0.90));
+    out.key("p99").value((long long)h.valueAtQuantile(0.99));
+    out.key("p999").value((long long)h.valueAtQuantile(0.999));
+    out.key("max").value((long long)h.getMax());
+    // Exact buckets as [highest value, count] pairs, for merging or plotting
+    out.key("buckets").beginArray();
+    for (const auto& bucket : h.buckets()) {
+        out.beginArray().value((long long)bucket.first).value((long long)bucket.second).endArray();
+    }
+    out.endArray();
+    out.endObject();
+}
+
+// Appends one series of a Prometheus histogram. scale converts recorded units to the exported unit.
+void appendHistogram(std::string& out, const std::string& name, const std::string& labels, const Histogram& h,
+                     const double* bounds, size_t boundCount, double scale) {
+    std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+    for (size_t i = 0; i < boundCount; ++i) {
+        uint64_t below = h.countAtOrBelow((uint64_t)std::llround(bounds[i] / scale));
+        out += name + "_bucket" + prefix + "le=\"" + formatNumber(bounds[i]) + "\"} " + std::to_string(below) + "\n";
+    }
+    out += name + "_bucket" + prefix + "le=\"+Inf\"} " + std::to_string(h.getCount()) + "\n";
+    std::string suffix = labels.empty() ? "" : "{" + labels + "}";
+    out += name + "_sum" + suffix + " " + formatNumber(h.getSum() * scale) + "\n";
+    out += name + "_count" + suffix + " " + std::to_string(h.getCount()) + "\n";
+}
+
+void appendHeader(std::string& out, const std::string& name, const char* type, const char* help) {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+} // namespace
+
+RequestMetrics::RequestMetrics()
+    : started(std::chrono::system_clock::now()), requests(0), transfers(0), newConnections(0), transportErrors(0) {}
+
+const char* RequestMetrics::phaseName(Phase phase) {
+    return PhaseNames[(int)phase];
+}
+
+void RequestMetrics::recordTransfer(void* easy) {
+    CURL* curl = (CURL*)easy;
+    curl_off_t namelookup = 0, connect = 0, appconnect = 0, pretransfer = 0, starttransfer = 0, total = 0;
+    curl_off_t uploaded = 0, downloaded = 0;
+    long connects = 0;
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &namelookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appconnect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &starttransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++transfers;
+    if (status == 0) ++transportErrors;
+    if (connects > 0) {
+        newConnections += (size_t)connects;
+        phases[(int)Phase::Dns].record((uint64_t)namelookup);
+        phases[(int)Phase::Connect].record(elapsedUs(namelookup, connect));
+        // APPCONNECT stays 0 for plain HTTP
+        if (appconnect > 0) phases[(int)Phase::Tls].record(elapsedUs(connect, appconnect));
+    }
+    // A failed exchange may never have sent the request
+    if (starttransfer > 0) phases[(int)Phase::FirstByte].record(elapsedUs(pretransfer, starttransfer));
+    phases[(int)Phase::Total].record((uint64_t)total);
+    requestBytes.record((uint64_t)uploaded);
+    responseBytes.record((uint64_t)downloaded);
+}
+
+void RequestMetrics::recordRequest(long status, int retryCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++requests;
+    ++statuses[status];
+    retries.record((uint64_t)std::max(0, retryCount));
+}
+
+Histogram RequestMetrics::getPhase(Phase phase) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return phases[(int)phase];
+}
+
+size_t RequestMetrics::getRequestCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests;
+}
+
+size_t RequestMetrics::getTransferCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return transfers;
+}
+
+std::string RequestMetrics::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    JsonWriter out(4096);
+    out.beginObject();
+    double elapsed = std::chrono::duration<double>(std::chrono::system_clock::now() - started).count();
+    out.key("elapsed_seconds").raw(formatNumber(elapsed));
+    out.key("requests").value((long long)requests);
+    out.key("transfers").value((long long)transfers);
+    out.key("retries").value((long long)retries.getSum());
+    out.key("new_connections").value((long long)newConnections);
+    out.key("transport_errors").value((long long)transportErrors);
+
+    out.key("status").beginObject();
+    for (const auto& s : statuses) {
+        out.key(std::to_string(s.first)).value((long long)s.second);
+    }
+    out.endObject();
+
+    out.key("phases_us").beginObject();
+    for (int i = 0; i < PhaseCount; ++i) {
+        out.key(PhaseNames[i]);
+        writeSummary(out, phases[i]);
+    }
+    out.endObject();
+
+    out.key("request_bytes");
+    writeSummary(out, requestBytes);
+    out.key("response_bytes");
+    writeSummary(out, responseBytes);
+    out.key("retries_per_request");
+    writeSummary(out, retries);
+    out.endObject();
+    return out.take();
+}
+
+std::string RequestMetrics::toPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    out.reserve(8192);
+    const size_t secondsCount = sizeof(SecondsBounds) / sizeof(SecondsBounds[0]);
+    const size_t bytesCount = sizeof(BytesBounds) / sizeof(BytesBounds[0]);
+
+    appendHeader(out, "gitee_issue_request_phase_seconds", "histogram",
+                 "Time spent in each phase of HTTP exchanges with the Gitee API.");
+    for (int i = 0; i < PhaseCount; ++i) {
+        appendHistogram(out, "gitee_issue_request_phase_seconds", std::string("phase=\"") + PhaseNames[i] + "\"",
+                        phases[i], SecondsBounds, secondsCount, 1e-6);
+    }
+
+    appendHeader(out, "gitee_issue_request_size_bytes", "histogram", "Bytes uploaded per HTTP exchange.");
+    appendHistogram(out, "gitee_issue_request_size_bytes", "", requestBytes, BytesBounds, bytesCount, 1);
+    appendHeader(out, "gitee_issue_response_size_bytes", "histogram", "Bytes downloaded per HTTP exchange.");
+    appendHistogram(out, "gitee_issue_response_size_bytes", "", responseBytes, BytesBounds, bytesCount, 1);
+
+    appendHeader(out, "gitee_issue_requests_total", "counter",
+                 "Issue requests by HTTP status of their last attempt (0 = transport error).");
+    for (const auto& s : statuses) {
+        out += "gitee_issue_requests_total{status=\"" + std::to_string(s.first) + "\"} " +
+               std::to_string(s.second) + "\n";
+    }
+
+    appendHeader(out, "gitee_issue_retries_total", "counter", "Requests re-sent after a throttled or failed attempt.");
+    out += "gitee_issue_retries_total " + std::to_string(retries.getSum()) + "\n";
+    appendHeader(out, "gitee_issue_http_exchanges_total", "counter", "HTTP exchanges, one per attempt.");
+    out += "gitee_issue_http_exchanges_total " + std::to_string(transfers) + "\n";
+    appendHeader(out, "gitee_issue_connections_opened_total", "counter", "New TCP/TLS connections.");
+    out += "gitee_issue_connections_opened_total " + std::to_string(newConnections) + "\n";
+    appendHeader(out, "gitee_issue_transport_errors_total", "counter", "Exchanges that failed without an HTTP status.");
+    out += "gitee_issue_transport_errors_total " + std::to_string(transportErrors) + "\n";
+
+    appendHeader(out, "gitee_issue_metrics_start_time_seconds", "gauge",
+                 "Unix time the counters above started from.");
+    out += "gitee_issue_metrics_start_time_seconds " +
+           formatNumber(std::chrono::duration<double>(started.time_since_epoch()).count()) + "\n";
+    return out;
+}
+
+bool RequestMetrics::writePrometheusFile(const std::string& path) const {
+    // The collector only reads *.prom, so the temporary name is never picked up
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (!file || !(file << toPrometheus()) || !file.flush()) {
+            std::cerr << "❌ Failed to write metrics file: " << tmpPath << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "❌ Failed to write metrics file: " << path << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef REQUESTMETRICS_H
+#define REQUESTMETRICS_H
+
+#include "Histogram.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Where the time and bytes of Gitee API calls go. Every HTTP exchange (each
+// retry counts as one) is timed phase by phase from libcurl's transfer info:
+//   dns        name lookup
+//   connect    TCP handshake
+//   tls        TLS handshake
+//   first_byte request sent until the first response byte, i.e. server time
+//   total      whole exchange, including the phases above
+// The dns, connect and tls phases are only recorded for exchanges that opened
+// a new connection, so reused connections do not hide the handshake cost.
+// Each logical request adds its final status and retry count once it is done.
+// All methods are thread-safe.
+class RequestMetrics {
+public:
+    enum class Phase { Dns, Connect, Tls, FirstByte, Total };
+    static constexpr int PhaseCount = 5;
+
+    RequestMetrics();
+
+    // Records one finished exchange on a CURL easy handle
+    void recordTransfer(void* easy);
+
+    // Records a request after its last attempt. status is 0 on a transport error.
+    void recordRequest(long status, int retries);
+
+    // Phase durations in microseconds
+    Histogram getPhase(Phase phase) const;
+    size_t getRequestCount() const;
+    size_t getTransferCount() const;
+
+    // Summary with percentiles (microseconds and bytes), for --stats
+    std::string toJson() const;
+
+    // Prometheus text exposition format, metric names prefixed with gitee_issue_
+    std::string toPrometheus() const;
+
+    // Writes toPrometheus() to path atomically (via a temporary file and rename),
+    // so node_exporter's textfile collector never reads a half-written file
+    bool writePrometheusFile(const std::string& path) const;
+
+    static const char* phaseName(Phase phase);
+
+private:
+    mutable std::mutex mutex;
+    std::chrono::system_clock::time_point started;
+    Histogram phases[PhaseCount];
+    Histogram requestBytes;
+    Histogram responseBytes;
+    Histogram retries;             // Per logical request
+    std::map<long, size_t> statuses; // Final status per logical request
+    size_t requests;
+    size_t transfers;
+    size_t newConnections;
+    size_t transportErrors;        // Exchanges that got no HTTP status
+};
+
+#endif // REQUESTMETRICS_H
@@ -0,0 +1,149 @@
+#include "RequestScheduler.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+
+RequestScheduler::RequestScheduler() : RequestScheduler(Options()) {}
+
+RequestScheduler::RequestScheduler(const Options& options)
+    : options(options), window(std::max(1, std::min(options.initialConcurrency, options.maxConcurrency))),
+      rng(std::random_device{}()), retries(0), throttled(0) {}
+
+RequestScheduler::Clock::time_point RequestScheduler::acquire(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+
+    auto it = buckets.find(key);
+    if (it == buckets.end()) {
+        it = buckets.emplace(key, Bucket()).first;
+        it->second.tokens = options.burst;
+        it->second.refilled = now;
+    }
+    Bucket& bucket = it->second;
+
+    if (now < bucket.pausedUntil) {
+        return bucket.pausedUntil;
+    }
+    if (options.ratePerSecond <= 0) {
+        return Clock::time_point();
+    }
+
+    double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+    bucket.tokens = std::min(options.burst, bucket.tokens + elapsed * options.ratePerSecond);
+    bucket.refilled = now;
+
+    if (bucket.tokens >= 1) {
+        bucket.tokens -= 1;
+        return Clock::time_point();
+    }
+    double wait = (1 - bucket.tokens) / options.ratePerSecond;
+    return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait));
+}
+
+long RequestScheduler::parseRetryAfterMs(const HttpHeaders& headers) const {
+    // Whatever the server says, one bad header must not stall the key for longer than this
+    auto clamp = [this](double ms) { return (long)std::min<double>(std::max(0.0, ms), options.maxDelayMs); };
+
+    auto it = headers.find("retry-after");
+    if (it != headers.end()) {
+        char* end = nullptr;
+        double seconds = std::strtod(it->second.c_str(), &end);
+        if (end != it->second.c_str()) {
+            return clamp(seconds * 1000);
+        }
+    }
+
+    // X-RateLimit-Remaining: 0 together with a reset time means "wait until then".
+    // Reset may be given as seconds from now or as a Unix timestamp; anything
+    // that large is a timestamp, and one already past means no wait.
+    auto remaining = headers.find("x-ratelimit-remaining");
+    auto reset = headers.find("x-ratelimit-reset");
+    if (remaining != headers.end() && reset != headers.end() && std::atol(remaining->second.c_str()) <= 0) {
+        const long TimestampThreshold = 1000000000; // September 2001
+        long value = std::atol(reset->second.c_str());
+        long seconds = value > TimestampThreshold ? value - (long)std::time(nullptr) : value;
+        if (seconds > 0) return clamp(seconds * 1000.0);
+    }
+    return -1;
+}
+
+void RequestScheduler::onResponse(const std::string& key, long status, const HttpHeaders& headers) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+
+    long pauseMs = parseRetryAfterMs(headers);
+    if (pauseMs > 0) {
+        Bucket& bucket = buckets[key];
+        bucket.pausedUntil = std::max(bucket.pausedUntil, now + std::chrono::milliseconds(pauseMs));
+    }
+
+    bool pushback = status == 429 || status == 503;
+    if (pushback) {
+        ++throttled;
+        // Halve at most once per round of in-flight requests, not once per rejected request
+        if (now - lastDecrease > std::chrono::milliseconds(500)) {
+            window = std::max(1.0, window / 2);
+            lastDecrease = now;
+        }
+    } else if (status > 0 && status < 500) {
+        window = std::min((double)options.maxConcurrency, window + 1.0 / window);
+    }
+}
+
+bool RequestScheduler::shouldRetry(long status, bool failedBeforeSending, int attempt, const HttpHeaders& headers,
+                                   std::chrono::milliseconds& delay) {
+    bool retryable = failedBeforeSending || status == 429 || status >= 500;
+    if (!retryable || attempt >= options.maxRetries) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++retries;
+
+    // Full jitter: uniform in [0, min(cap, base * 2^attempt)]
+    long ceiling = std::min<long>(options.maxDelayMs, (long)options.baseDelayMs << std::min(attempt, 20));
+    std::uniform_int_distribution<long> jitter(0, std::max(1L, ceiling));
+    long ms = jitter(rng);
+
+    long retryAfter = parseRetryAfterMs(headers);
+    if (retryAfter > ms) ms = retryAfter;
+
+    delay = std::chrono::milliseconds(ms);
+    return true;
+}
+
+int RequestScheduler::concurrencyLimit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::max(1, (int)window);
+}
+
+size_t RequestScheduler::getRetryCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return retries;
+}
+
+size_t RequestScheduler::getThrottledCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return throttled;
+}
+
+const RequestScheduler::Options& RequestScheduler::getOptions() const {
+    return options;
+}
+
+void RequestScheduler::parseHeaderLine(const char* data, size_t len, HttpHeaders& headers) {
+    std::string line(data, len);
+    if (line.compare(0, 5, "HTTP/") == 0) {
+        headers.clear(); // New response (after 100 Continue or a redirect)
+        return;
+    }
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) return;
+
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    size_t start = line.find_first_not_of(" \t", colon + 1);
+    size_t end = line.find_last_not_of(" \t\r\n");
+    headers[name] = (start == std::string::npos || end < start) ? "" : line.substr(start, end - start + 1);
+}
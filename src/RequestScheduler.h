@@ -0,0 +1,84 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+
+// Response headers with lower-cased names
+using HttpHeaders = std::map<std::string, std::string>;
+
+// Paces requests to the Gitee API so bursts do not get throttled.
+//  - A token bucket per access token limits the request rate. Rate-limit and
+//    Retry-After headers pause a token until the server says it may continue.
+//  - An AIMD controller adapts how many requests may be in flight: the window
+//    grows by one per window of successes and halves when the server pushes back.
+//  - 429 and 5xx responses are retried with jittered exponential backoff, as
+//    are requests that never reached the server. Other transport errors are
+//    not: the server may already have created the issue.
+// All methods are thread-safe.
+class RequestScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        int maxConcurrency = 8;
+        int initialConcurrency = 4;
+        double ratePerSecond = 0;    // Per access token; 0 means no fixed limit
+        double burst = 10;           // Bucket capacity when ratePerSecond is set
+        int maxRetries = 5;
+        int baseDelayMs = 250;
+        int maxDelayMs = 30000;
+    };
+
+    RequestScheduler();
+    explicit RequestScheduler(const Options& options);
+
+    // Tries to take a request slot for key. Returns Clock::time_point() if the
+    // request may start now, otherwise the earliest time it should be retried.
+    Clock::time_point acquire(const std::string& key);
+
+    // Feeds back a finished response so the rate and concurrency can adapt
+    void onResponse(const std::string& key, long status, const HttpHeaders& headers);
+
+    // Decides whether a response should be retried. failedBeforeSending marks a
+    // transport error from before any of the request was sent (see
+    // HttpSession::failedBeforeSending). attempt counts retries so far.
+    // On true, delay is how long to wait before sending again.
+    bool shouldRetry(long status, bool failedBeforeSending, int attempt, const HttpHeaders& headers,
+                     std::chrono::milliseconds& delay);
+
+    // Current number of requests allowed in flight
+    int concurrencyLimit() const;
+
+    size_t getRetryCount() const;
+    size_t getThrottledCount() const;
+
+    const Options& getOptions() const;
+
+    // Adds one raw "Name: value" header line to headers. A status line starts a new set.
+    static void parseHeaderLine(const char* line, size_t len, HttpHeaders& headers);
+
+private:
+    struct Bucket {
+        double tokens = 0;
+        Clock::time_point refilled;
+        Clock::time_point pausedUntil;
+    };
+
+    Options options;
+    mutable std::mutex mutex;
+    std::map<std::string, Bucket> buckets;
+    double window;
+    Clock::time_point lastDecrease;
+    std::mt19937 rng;
+    size_t retries;
+    size_t throttled;
+
+    // Server-requested pause, at most options.maxDelayMs; -1 if none
+    long parseRetryAfterMs(const HttpHeaders& headers) const;
+};
+
+#endif // REQUESTSCHEDULER_H
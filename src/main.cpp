@@ -3,9 +3,33 @@
 #include <limits>
 #include <cstdlib>
 #include "cxxopts.hpp"
+#include "BodyFile.h"
 #include "ConfigSetup.h"
 #include "Hasher.h"
 #include "IssueCreator.h"
+#include "BatchCreator.h"
+#include "IssueClient.h"
+#include "HttpSession.h"
+#include "IssueDedup.h"
+#include "IssueSync.h"
+#include "IssueTemplate.h"
+#include "IssueUpdater.h"
+#include "LabelResolver.h"
+#include "LogWatcher.h"
+#include "OutboxDrainer.h"
+#include "RepoIndex.h"
+#include "Daemon.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 
 void createIssueInteractive(const RepoConfig& config, ConfigSetup& configSetup) {
     std::string saltContent = ConfigSetup::getKey();
@@ -25,9 +49,12 @@ void createIssueInteractive(const RepoConfig& config, ConfigSetup& configSetup)
     std::getline(std::cin, labels);
 
     if (issueCreator.createIssue(title, body, labels)) {
-        int issueId = issueCreator.getLastIssueId();
-        if (issueId != -1) {
-            std::cout << "✅ Issue created successfully! Issue ID: #" << issueId << std::endl;
+        const IssueResult& created = issueCreator.getLastResult();
+        if (created.id != -1) {
+            std::cout << "✅ Issue created successfully! Issue ID: #" << created.id << std::endl;
+            if (!created.htmlUrl.empty()) {
+                std::cout << "🔗 " << created.htmlUrl << std::endl;
+            }
         } else {
             std::cout << "✅ Issue created successfully! (Issue ID could not be extracted)" << std::endl;
         }
@@ -102,13 +129,30 @@ void deleteRepo(ConfigSetup& configSetup) {
 }
 
 void createIssueWithArgs(const std::string& owner, const std::string& repo,
-                         const std::string& title, const std::string& body,
-                         const std::string& token, const std::string& labels = "") {
-    IssueCreator creator(owner, repo, token);
+                         const std::string& title, const BodyParts& body,
+                         const std::string& token, const std::string& labels = "",
+                         std::shared_ptr<RequestScheduler> scheduler = nullptr,
+                         std::shared_ptr<HttpSession> session = nullptr,
+                         std::shared_ptr<IssueDedup> dedup = nullptr) {
+    IssueResult existing;
+    if (dedup && dedup->find(owner, repo, title, body, existing)) {
+        std::cout << "♻️ Identical issue already created, not sent again. Issue ID: #" << existing.id << std::endl;
+        if (!existing.htmlUrl.empty()) {
+            std::cout << "🔗 " << existing.htmlUrl << std::endl;
+        }
+        return;
+    }
+
+    IssueCreator creator(owner, repo, token, session);
+    creator.setScheduler(scheduler);
     if (creator.createIssue(title, body, labels)) {
-        int issueId = creator.getLastIssueId();
-        if (issueId != -1) {
-            std::cout << "✅ Issue created successfully! Issue ID: #" << issueId << std::endl;
+        const IssueResult& created = creator.getLastResult();
+        if (dedup) dedup->remember(owner, repo, title, body, labels, created);
+        if (created.id != -1) {
+            std::cout << "✅ Issue created successfully! Issue ID: #" << created.id << std::endl;
+            if (!created.htmlUrl.empty()) {
+                std::cout << "🔗 " << created.htmlUrl << std::endl;
+            }
         } else {
             std::cout << "✅ Issue created successfully! (Issue ID could not be extracted)" << std::endl;
         }
@@ -117,6 +161,689 @@ void createIssueWithArgs(const std::string& owner, const std::string& repo,
     }
 }
 
+// Fills owner/repo/token from the command line, falling back to the default repo config
+bool resolveTarget(const cxxopts::ParseResult& result, ConfigSetup& configSetup,
+                   std::string& owner, std::string& repo, std::string& token) {
+    owner = result.count("owner") ? result["owner"].as<std::string>() : "";
+    repo = result.count("repo") ? result["repo"].as<std::string>() : "";
+    token = result.count("token") ? result["token"].as<std::string>() : "";
+
+    // With an explicit target, only that repo's row is read (via the (owner, repo) index)
+    if (!owner.empty() && !repo.empty() && token.empty()) {
+        RepoConfig repoConfig;
+        if (configSetup.getConfig(owner, repo, repoConfig)) {
+            Hasher hasher(configSetup.getKey());
+            try {
+                token = hasher.decrypt(repoConfig.encrypted_token);
+            } catch (const std::exception& e) {
+                std::cerr << "❌ Failed to decrypt token: " << e.what() << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (owner.empty() || repo.empty() || token.empty()) {
+        RepoConfig defConfig;
+        if (!configSetup.getDefaultRepoConfig(defConfig)) {
+            std::cerr << "❌ No default repository config found, and some required fields are missing." << std::endl;
+            return false;
+        }
+
+        if (owner.empty()) owner = defConfig.owner;
+        if (repo.empty()) repo = defConfig.repo;
+
+        if (token.empty()) {
+            Hasher hasher(configSetup.getKey());
+            try {
+                token = hasher.decrypt(defConfig.encrypted_token);
+            } catch (const std::exception& e) {
+                std::cerr << "❌ Failed to decrypt token: " << e.what() << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Creates the HTTP session for this run, collecting request metrics if --stats or --stats-file is given
+std::shared_ptr<HttpSession> makeSession(const cxxopts::ParseResult& result) {
+    auto session = std::make_shared<HttpSession>();
+    if (result.count("stats") || result.count("stats-file")) {
+        session->setMetrics(std::make_shared<RequestMetrics>());
+    }
+    return session;
+}
+
+// Prints (--stats) and exports (--stats-file) the metrics collected by session
+void reportStats(const cxxopts::ParseResult& result, const HttpSession& session) {
+    const auto& metrics = session.getMetrics();
+    if (!metrics) return;
+    if (result.count("stats")) {
+        std::cerr << metrics->toJson() << std::endl;
+    }
+    if (result.count("stats-file")) {
+        metrics->writePrometheusFile(result["stats-file"].as<std::string>());
+    }
+}
+
+// Dedup index for --dedup-ttl. Issues are remembered even with a TTL of 0, so turning it on later works.
+std::shared_ptr<IssueDedup> makeDedup(const cxxopts::ParseResult& result, ConfigSetup& configSetup) {
+    return std::make_shared<IssueDedup>(configSetup, result["dedup-ttl"].as<int>());
+}
+
+// Label checking for --labels, unless --no-label-check; --create-labels creates missing ones
+std::shared_ptr<LabelResolver> makeLabels(const cxxopts::ParseResult& result, ConfigSetup& configSetup,
+                                          std::shared_ptr<HttpSession> session,
+                                          std::shared_ptr<RequestScheduler> scheduler) {
+    if (result.count("no-label-check")) return nullptr;
+    auto labels = std::make_shared<LabelResolver>(configSetup, result["label-ttl"].as<int>(), session, scheduler);
+    labels->setCreateMissing(result.count("create-labels") > 0);
+    return labels;
+}
+
+// Builds the request scheduler from --concurrency, --rate and --max-retries
+std::shared_ptr<RequestScheduler> makeScheduler(const cxxopts::ParseResult& result) {
+    RequestScheduler::Options options;
+    options.maxConcurrency = std::max(1, result["concurrency"].as<int>());
+    options.initialConcurrency = std::min(options.maxConcurrency, 4);
+    options.ratePerSecond = result["rate"].as<double>();
+    options.maxRetries = std::max(0, result["max-retries"].as<int>());
+    return std::make_shared<RequestScheduler>(options);
+}
+
+// Loads --template, if given. Returns false if it cannot be read.
+bool loadBodyTemplate(const cxxopts::ParseResult& result, std::shared_ptr<IssueTemplate>& out) {
+    if (!result.count("template")) return true;
+    out = std::make_shared<IssueTemplate>();
+    return out->load(result["template"].as<std::string>());
+}
+
+// Renders --title and --template with the --var values, for a single --create
+bool renderFromVars(const cxxopts::ParseResult& result, std::string& title, std::string& body) {
+    std::shared_ptr<IssueTemplate> bodyTemplate;
+    if (!loadBodyTemplate(result, bodyTemplate)) return false;
+
+    std::vector<std::pair<std::string, std::string>> vars;
+    if (result.count("var")) {
+        for (const std::string& var : result["var"].as<std::vector<std::string>>()) {
+            size_t eq = var.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "❗ Expected --var name=value, got: " << var << std::endl;
+                return false;
+            }
+            vars.emplace_back(var.substr(0, eq), var.substr(eq + 1));
+        }
+    }
+
+    IssueTemplate titleTemplate(title);
+    for (const IssueTemplate* tmpl : {&titleTemplate, bodyTemplate.get()}) {
+        IssueTemplate::Values values;
+        for (const std::string& name : tmpl->variables()) {
+            auto var = std::find_if(vars.begin(), vars.end(), [&name](const auto& v) { return v.first == name; });
+            if (var == vars.end()) {
+                std::cerr << "❗ Missing --var " << name << "=... for the template" << std::endl;
+                return false;
+            }
+            values.push_back(var->second);
+        }
+        std::string& out = tmpl == &titleTemplate ? title : body;
+        out.clear();
+        tmpl->render(out, values);
+    }
+    return true;
+}
+
+// --format, or the batch file's extension when it is "auto"
+bool batchFormat(const cxxopts::ParseResult& result, BatchCreator::Format& format) {
+    std::string name = result["format"].as<std::string>();
+    if (name == "auto") {
+        std::string source = result["batch"].as<std::string>();
+        bool csv = source.size() > 4 && source.compare(source.size() - 4, 4, ".csv") == 0;
+        format = csv ? BatchCreator::Format::Csv : BatchCreator::Format::Jsonl;
+    } else if (name == "csv") {
+        format = BatchCreator::Format::Csv;
+    } else if (name == "jsonl") {
+        format = BatchCreator::Format::Jsonl;
+    } else {
+        std::cerr << "❗ Unknown --format: " << name << " (expected csv, jsonl or auto)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int createIssuesFromBatch(const std::string& source, const std::string& owner, const std::string& repo,
+                          const std::string& token, std::shared_ptr<RequestScheduler> scheduler,
+                          std::shared_ptr<HttpSession> session, std::shared_ptr<IssueDedup> dedup,
+                          std::shared_ptr<LabelResolver> labels,
+                          BatchCreator::Format format = BatchCreator::Format::Jsonl,
+                          std::shared_ptr<const IssueTemplate> titleTemplate = nullptr,
+                          std::shared_ptr<const IssueTemplate> bodyTemplate = nullptr) {
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            std::cerr << "❌ Failed to open batch file: " << source << std::endl;
+            return 1;
+        }
+    }
+    std::istream& input = (source == "-") ? std::cin : file;
+
+    size_t created = 0;
+    size_t duplicates = 0;
+    int concurrency = scheduler->getOptions().maxConcurrency;
+    BatchCreator batch(owner, repo, token, concurrency, session, scheduler);
+    batch.setDedup(dedup);
+    batch.setLabelResolver(labels);
+    batch.setFormat(format);
+    batch.setTemplates(titleTemplate, bodyTemplate);
+    size_t failures = batch.run(input, [&created, &duplicates](const BatchResult& r) {
+        if (r.duplicate) {
+            ++duplicates;
+            std::cout << "♻️ [line " << r.line << "] Already created: Issue ID: #" << r.id;
+            if (!r.number.empty()) std::cout << " (" << r.number << ") " << r.htmlUrl;
+            std::cout << std::endl;
+        } else if (r.success) {
+            ++created;
+            std::cout << "✅ [line " << r.line << "] Issue ID: #" << r.id;
+            if (!r.number.empty()) std::cout << " (" << r.number << ") " << r.htmlUrl;
+            std::cout << std::endl;
+        } else {
+            std::cerr << "❌ [line " << r.line << "] " << r.error << std::endl;
+        }
+    });
+
+    std::cout << "Created " << created << " issue(s), ";
+    if (duplicates > 0) std::cout << duplicates << " already existed, ";
+    std::cout << failures << " failed." << std::endl;
+    const auto& batchSession = batch.getSession();
+    std::cout << "Connections: " << batchSession->getNewConnectionCount() << " opened, "
+              << batchSession->getHandshakesAvoided() << " handshake(s) avoided by reuse." << std::endl;
+    if (scheduler->getThrottledCount() > 0 || scheduler->getRetryCount() > 0) {
+        std::cout << "Throttled " << scheduler->getThrottledCount() << " time(s), "
+                  << scheduler->getRetryCount() << " retr" << (scheduler->getRetryCount() == 1 ? "y" : "ies")
+                  << ", final concurrency " << scheduler->concurrencyLimit() << "." << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Creates the same issue in every repo named by --fanout: a list of owner/repo,
+// "all", or a tag set with --set-tags. The targets are read in one query and
+// sent concurrently; requests are paced per token.
+int createIssueFanout(const cxxopts::ParseResult& result, ConfigSetup& configSetup, const std::string& title,
+                      const std::string& body, const std::string& labels) {
+    std::string spec = result["fanout"].as<std::string>();
+    std::vector<RepoConfig> targets;
+    size_t notConfigured = 0;
+    if (spec == "all") {
+        targets = configSetup.getConfigs();
+    } else if (spec.find('/') != std::string::npos) {
+        std::vector<std::pair<std::string, std::string>> repos;
+        std::stringstream list(spec);
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            item.erase(0, item.find_first_not_of(' '));
+            item.erase(item.find_last_not_of(' ') + 1);
+            if (item.empty()) continue;
+            size_t slash = item.find('/');
+            if (slash == std::string::npos || slash == 0 || slash + 1 == item.size()) {
+                std::cerr << "❗ Expected owner/repo in --fanout, got: " << item << std::endl;
+                return 1;
+            }
+            repos.emplace_back(item.substr(0, slash), item.substr(slash + 1));
+        }
+        targets = configSetup.getConfigs(repos);
+        for (const auto& repo : repos) {
+            bool found = std::any_of(targets.begin(), targets.end(), [&repo](const RepoConfig& c) {
+                return c.owner == repo.first && c.repo == repo.second;
+            });
+            if (!found) {
+                std::cerr << "❌ Not configured: " << repo.first << "/" << repo.second << std::endl;
+                ++notConfigured;
+            }
+        }
+    } else {
+        targets = configSetup.getConfigsByTag(spec);
+    }
+    if (targets.empty()) {
+        std::cerr << "❌ No configured repositories match --fanout " << spec << std::endl;
+        return 1;
+    }
+
+    // Repos usually share a handful of tokens; each one is decrypted once
+    std::string tokenOverride = result.count("token") ? result["token"].as<std::string>() : "";
+    std::map<std::string, std::string> tokens;
+    Hasher hasher(ConfigSetup::getKey());
+    std::vector<IssueRecord> records;
+    for (const RepoConfig& target : targets) {
+        IssueRecord record;
+        record.line = records.size() + 1;
+        record.owner = target.owner;
+        record.repo = target.repo;
+        record.title = title;
+        record.body = body;
+        record.labels = labels;
+        record.token = tokenOverride;
+        if (record.token.empty()) {
+            auto known = tokens.find(target.encrypted_token);
+            if (known == tokens.end()) {
+                try {
+                    known = tokens.emplace(target.encrypted_token, hasher.decrypt(target.encrypted_token)).first;
+                } catch (const std::exception& e) {
+                    std::cerr << "❌ Failed to decrypt token for " << target.owner << "/" << target.repo << ": "
+                              << e.what() << std::endl;
+                    return 1;
+                }
+            }
+            record.token = known->second;
+        }
+        records.push_back(std::move(record));
+    }
+
+    auto session = makeSession(result);
+    auto scheduler = makeScheduler(result);
+
+    // Every repo's labels are checked, and missing ones created, before any issue is
+    auto labelResolver = makeLabels(result, configSetup, session, scheduler);
+    if (labelResolver && !labels.empty()) {
+        std::vector<LabelTarget> labelTargets;
+        for (const IssueRecord& record : records) {
+            labelTargets.push_back({record.owner, record.repo, record.token, record.labels});
+        }
+        std::string error;
+        if (!labelResolver->prepare(labelTargets, error)) {
+            std::cerr << "❌ " << error << std::endl;
+            return 1;
+        }
+    }
+
+    BatchCreator batch("", "", "", scheduler->getOptions().maxConcurrency, session, scheduler);
+    batch.setDedup(makeDedup(result, configSetup));
+    batch.setLabelResolver(labelResolver);
+    std::cout << "🚀 Creating the issue in " << records.size() << " repositor" << (records.size() == 1 ? "y" : "ies")
+              << " (" << (tokenOverride.empty() ? tokens.size() : 1) << " token(s))..." << std::endl;
+    std::vector<BatchResult> results(records.size());
+    size_t failures = batch.run(records, [&results](const BatchResult& r) { results[r.line - 1] = r; });
+
+    size_t width = std::strlen("Repository");
+    for (const IssueRecord& record : records) width = std::max(width, record.owner.size() + 1 + record.repo.size());
+    std::cout << std::left << std::setw((int)width + 2) << "Repository" << "Issue" << std::endl;
+    size_t created = 0;
+    size_t duplicates = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const BatchResult& r = results[i];
+        std::cout << std::setw((int)width + 2) << (records[i].owner + "/" + records[i].repo);
+        if (r.success) {
+            ++(r.duplicate ? duplicates : created);
+            std::cout << (r.duplicate ? "♻️ #" : "✅ #") << r.id;
+            if (!r.htmlUrl.empty()) std::cout << "  " << r.htmlUrl;
+            std::cout << std::endl;
+        } else {
+            std::cout << "❌ " << r.error.substr(0, r.error.find('\n')) << std::endl;
+        }
+    }
+    std::cout << std::right << "Created " << created << " issue(s), ";
+    if (duplicates > 0) std::cout << duplicates << " already existed, ";
+    std::cout << failures << " failed." << std::endl;
+    reportStats(result, *session);
+    return failures == 0 && notConfigured == 0 ? 0 : 1;
+}
+
+// Stores the issue in the outbox without touching the network or decrypting any token
+int enqueueIssue(const cxxopts::ParseResult& result, ConfigSetup& configSetup,
+                 const std::string& title, const std::string& body, const std::string& labels) {
+    std::string owner = result.count("owner") ? result["owner"].as<std::string>() : "";
+    std::string repo = result.count("repo") ? result["repo"].as<std::string>() : "";
+
+    if (owner.empty() || repo.empty()) {
+        RepoConfig defConfig;
+        if (!configSetup.getDefaultRepoConfig(defConfig)) {
+            std::cerr << "❌ No default repository config found, and some required fields are missing." << std::endl;
+            return 1;
+        }
+        if (owner.empty()) owner = defConfig.owner;
+        if (repo.empty()) repo = defConfig.repo;
+    }
+
+    std::string encryptedToken;
+    if (result.count("token")) {
+        try {
+            Hasher hasher(ConfigSetup::getKey());
+            encryptedToken = hasher.encrypt(result["token"].as<std::string>());
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Failed to encrypt token: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    long long id = configSetup.enqueueIssue(owner, repo, title, body, labels, encryptedToken);
+    if (id < 0) {
+        std::cerr << "❌ Failed to queue issue." << std::endl;
+        return 1;
+    }
+    std::cout << "📥 Issue queued (outbox #" << id << "). Run 'gitee-issue --drain' to send it." << std::endl;
+    return 0;
+}
+
+int drainOutbox(ConfigSetup& configSetup, std::shared_ptr<RequestScheduler> scheduler, bool follow,
+                std::shared_ptr<HttpSession> session, const std::string& metricsFile) {
+    OutboxDrainer drainer(configSetup, scheduler, session);
+    size_t sent = 0;
+    size_t failures = 0;
+
+    auto report = [&sent](const OutboxItem& item, const OutboxResult& r) {
+        if (r.success) {
+            ++sent;
+            std::cout << "✅ [outbox #" << item.id << "] " << item.owner << "/" << item.repo
+                      << " Issue ID: #" << r.issueId << std::endl;
+        } else {
+            std::cerr << "❌ [outbox #" << item.id << "] " << item.owner << "/" << item.repo << ": " << r.error
+                      << (r.retry ? " (will retry)" : "") << std::endl;
+        }
+    };
+
+    const RequestMetrics* metrics = metricsFile.empty() ? nullptr : session->getMetrics().get();
+    size_t metricsWritten = 0;
+    do {
+        failures += drainer.drain(report);
+        // Keep the textfile current while following; unchanged numbers are not rewritten
+        if (follow && metrics && metrics->getTransferCount() != metricsWritten &&
+            metrics->writePrometheusFile(metricsFile)) {
+            metricsWritten = metrics->getTransferCount();
+        }
+        if (follow) std::this_thread::sleep_for(std::chrono::seconds(1));
+    } while (follow);
+
+    std::cout << "Sent " << sent << " queued issue(s), " << failures << " failed attempt(s), "
+              << configSetup.countPendingOutbox() << " still queued." << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+int syncIssues(ConfigSetup& configSetup, const std::string& owner, const std::string& repo, const std::string& token,
+               bool full, std::shared_ptr<RequestScheduler> scheduler, std::shared_ptr<HttpSession> session) {
+    IssueSync sync(configSetup, scheduler, session);
+    IssueSync::Report report;
+    bool ok = sync.run(owner, repo, token, full, report);
+
+    std::cout << "🔄 " << owner << "/" << repo << ": " << report.issues << " issue(s) fetched in " << report.pages
+              << " page(s)";
+    if (!report.since.empty()) std::cout << " (updated since " << report.since << ")";
+    std::cout << ", " << configSetup.countCachedIssues(owner, repo) << " cached." << std::endl;
+    if (!ok) {
+        std::cerr << "❌ Sync incomplete: " << report.error << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int searchCachedIssues(ConfigSetup& configSetup, const std::string& text, const std::string& owner,
+                       const std::string& repo, int limit) {
+    std::vector<IssueMatch> matches;
+    if (!configSetup.searchIssues(text, owner, repo, limit, matches)) {
+        std::cerr << "❌ Search failed." << std::endl;
+        return 1;
+    }
+    if (matches.empty()) {
+        std::cout << "No cached issues match \"" << text << "\". Run 'gitee-issue --sync' to refresh the cache." << std::endl;
+        return 0;
+    }
+
+    for (const IssueMatch& match : matches) {
+        const CachedIssue& issue = match.issue;
+        std::cout << "#" << issue.number << " [" << issue.state << "] " << issue.title << " (" << issue.owner << "/"
+                  << issue.repo << ")" << std::endl;
+        std::string snippet = match.snippet;
+        std::replace_if(snippet.begin(), snippet.end(), [](char c) { return c == '\n' || c == '\r' || c == '\t'; }, ' ');
+        if (!snippet.empty()) std::cout << "   " << snippet << std::endl;
+        if (!issue.htmlUrl.empty()) std::cout << "   🔗 " << issue.htmlUrl << std::endl;
+    }
+    return 0;
+}
+
+// Issue numbers for --update and --close: "I1,I2,...", "@file" (one per line,
+// "@-" for stdin) or "search:text" (cached issues of owner/repo matching text,
+// see --search). Cached issues already in skipState are left out.
+bool issueNumbers(const std::string& spec, ConfigSetup& configSetup, const std::string& owner,
+                  const std::string& repo, int limit, const std::string& skipState, std::vector<std::string>& out) {
+    if (spec.compare(0, 7, "search:") == 0) {
+        std::vector<IssueMatch> matches;
+        if (!configSetup.searchIssues(spec.substr(7), owner, repo, limit, matches)) {
+            std::cerr << "❌ Search failed." << std::endl;
+            return false;
+        }
+        size_t skipped = 0;
+        for (const IssueMatch& match : matches) {
+            if (!skipState.empty() && match.issue.state == skipState) {
+                ++skipped;
+            } else {
+                out.push_back(match.issue.number);
+            }
+        }
+        if (skipped > 0) std::cout << "Skipping " << skipped << " issue(s) already " << skipState << "." << std::endl;
+        return true;
+    }
+
+    if (!spec.empty() && spec[0] == '@') {
+        std::string source = spec.substr(1);
+        std::ifstream file;
+        if (source != "-") {
+            file.open(source);
+            if (!file) {
+                std::cerr << "❌ Failed to open issue list: " << source << std::endl;
+                return false;
+            }
+        }
+        std::istream& input = (source == "-") ? std::cin : file;
+        // Anything after the first word of a line is ignored, so notes can follow the number
+        std::string line;
+        while (std::getline(input, line)) {
+            std::istringstream words(line);
+            std::string number;
+            if (words >> number) out.push_back(number);
+        }
+        return true;
+    }
+
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t end = std::min(spec.find(',', pos), spec.size());
+        std::string number = spec.substr(pos, end - pos);
+        number.erase(0, number.find_first_not_of(' '));
+        number.erase(number.find_last_not_of(' ') + 1);
+        if (!number.empty()) out.push_back(number);
+        pos = end + 1;
+    }
+    return true;
+}
+
+// --update and --close: one PATCH per issue, sent concurrently like --batch
+int updateIssues(const cxxopts::ParseResult& result, ConfigSetup& configSetup, const std::string& owner,
+                 const std::string& repo, const std::string& token, std::shared_ptr<RequestScheduler> scheduler,
+                 std::shared_ptr<HttpSession> session) {
+    bool close = result.count("close") > 0;
+    IssueChanges changes;
+    if (result.count("title")) changes.title = result["title"].as<std::string>();
+    if (result.count("body")) changes.body = result["body"].as<std::string>();
+    if (result.count("labels")) changes.labels = result["labels"].as<std::string>();
+    if (result.count("state")) changes.state = result["state"].as<std::string>();
+    if (close) changes.state = "closed";
+
+    if (changes.state && *changes.state != "open" && *changes.state != "progressing" && *changes.state != "closed") {
+        std::cerr << "❗ Unknown --state: " << *changes.state << " (expected open, progressing or closed)" << std::endl;
+        return 1;
+    }
+    if (changes.empty()) {
+        std::cerr << "❗ Nothing to update: give --title, --body, --labels or --state" << std::endl;
+        return 1;
+    }
+
+    // An explicit --limit caps a search; otherwise take as many as the search returns
+    int limit = result.count("limit") ? std::max(1, result["limit"].as<int>()) : ConfigSetup::SearchCandidates;
+    std::vector<std::string> numbers;
+    if (!issueNumbers(result[close ? "close" : "update"].as<std::string>(), configSetup, owner, repo, limit,
+                      changes.state ? *changes.state : "", numbers)) {
+        return 1;
+    }
+    if (numbers.empty()) {
+        std::cout << "No issues to update." << std::endl;
+        return 0;
+    }
+
+    auto labels = changes.labels ? makeLabels(result, configSetup, session, scheduler) : nullptr;
+    std::string error;
+    if (labels && !labels->resolve(owner, repo, token, *changes.labels, error)) {
+        std::cerr << "❌ " << error << std::endl;
+        return 1;
+    }
+
+    size_t updated = 0;
+    const char* done = close ? "Closed" : "Updated";
+    IssueUpdater updater(owner, repo, token, scheduler->getOptions().maxConcurrency, session, scheduler);
+    size_t failures = updater.run(numbers, changes, [&updated, done](const UpdateResult& r) {
+        if (r.success) {
+            ++updated;
+            std::cout << "✅ [" << r.target << "] " << done;
+            if (!r.htmlUrl.empty()) std::cout << " " << r.htmlUrl;
+            std::cout << std::endl;
+        } else {
+            std::cerr << "❌ [" << r.target << "] " << r.error << std::endl;
+        }
+    });
+
+    std::cout << done << " " << updated << " issue(s) in " << owner << "/" << repo << ", " << failures << " failed."
+              << std::endl;
+    std::cout << "Connections: " << session->getNewConnectionCount() << " opened, "
+              << session->getHandshakesAvoided() << " handshake(s) avoided by reuse." << std::endl;
+    if (scheduler->getThrottledCount() > 0 || scheduler->getRetryCount() > 0) {
+        std::cout << "Throttled " << scheduler->getThrottledCount() << " time(s), "
+                  << scheduler->getRetryCount() << " retr" << (scheduler->getRetryCount() == 1 ? "y" : "ies")
+                  << ", final concurrency " << scheduler->concurrencyLimit() << "." << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// --watch: files coalesced errors from a growing log. The watcher reads on this
+// thread and hands each issue to an IssueClient, which creates it on its own
+// thread, so a slow or throttled API never holds up reading. An error that
+// comes back in a later window updates its issue instead of filing another.
+int watchLog(const cxxopts::ParseResult& result, ConfigSetup& configSetup, const std::string& owner,
+             const std::string& repo, const std::string& token) {
+    // Issues waiting for the API beyond this are dropped rather than queued without bound
+    const size_t MaxWaitingIssues = 256;
+
+    SignatureMatcher matcher;
+    std::string error;
+    // A std::string option rather than a vector, which cxxopts would split at
+    // every comma; each occurrence on the command line is one whole pattern
+    std::vector<std::string> patterns;
+    for (const cxxopts::KeyValue& arg : result.arguments()) {
+        if (arg.key() == "watch-pattern") patterns.push_back(arg.value());
+    }
+    if (patterns.empty()) patterns = SignatureMatcher::defaultPatterns();
+    for (const std::string& pattern : patterns) {
+        if (!matcher.addPattern(pattern, error)) {
+            std::cerr << "❗ Invalid --watch-pattern " << pattern << ": " << error << std::endl;
+            return 1;
+        }
+    }
+
+    auto session = makeSession(result);
+    auto scheduler = makeScheduler(result);
+    std::string labels = result["labels"].as<std::string>();
+    auto labelResolver = makeLabels(result, configSetup, session, scheduler);
+    if (labelResolver && !labelResolver->resolve(owner, repo, token, labels, error)) {
+        std::cerr << "❌ " << error << std::endl;
+        return 1;
+    }
+
+    LogWatcher::Options options;
+    options.windowSeconds = std::max(0, result["watch-window"].as<int>());
+    options.samples = result["watch-samples"].as<size_t>();
+
+    std::string source = result["watch"].as<std::string>();
+    std::mutex output; // Results are printed from the client's thread
+    struct FiledIssue {
+        std::string number;
+        std::string title;
+    };
+    std::unordered_map<uint64_t, FiledIssue> issues; // Fingerprint -> its issue; guarded by output
+    std::atomic<size_t> filed(0);
+    std::atomic<size_t> updated(0);
+    std::atomic<size_t> failed(0);
+    size_t dropped = 0;
+    LogWatcher::Stats stats;
+    double seconds = 0;
+    int rc;
+    {
+        IssueClient client(scheduler->getOptions().maxConcurrency, session, scheduler);
+        LogWatcher watcher(options, std::move(matcher), [&](WatchedError&& found) {
+            std::lock_guard<std::mutex> lock(output);
+            if (client.pending() >= MaxWaitingIssues) {
+                ++dropped;
+                std::cerr << "❗ Too many issues waiting for the API, dropped: " << found.title << std::endl;
+                return;
+            }
+            std::cout << "🔎 " << found.occurrences << "× " << found.title << std::endl;
+            auto known = issues.find(found.fingerprint);
+            if (found.windows > 1 && known != issues.end()) {
+                // The issue keeps its title and labels; the body gets the counts so far
+                IssueRequest request{owner, repo, token, known->second.title, std::move(found.body), ""};
+                auto onUpdated = [&output, &updated, &failed](const IssueResult& r) {
+                    std::lock_guard<std::mutex> lock(output);
+                    if (r.success) {
+                        ++updated;
+                        std::cout << "🔁 Updated issue ID: #" << r.id;
+                        if (!r.htmlUrl.empty()) std::cout << " " << r.htmlUrl;
+                        std::cout << std::endl;
+                    } else {
+                        ++failed;
+                        std::cerr << "❌ " << r.error << std::endl;
+                    }
+                };
+                client.update(known->second.number, std::move(request), onUpdated);
+                return;
+            }
+            uint64_t fingerprint = found.fingerprint;
+            std::string title = found.title;
+            IssueRequest request{owner, repo, token, std::move(found.title), std::move(found.body), labels};
+            client.submit(std::move(request), [&output, &issues, &filed, &failed, fingerprint,
+                                               title](const IssueResult& r) {
+                std::lock_guard<std::mutex> lock(output);
+                if (r.success) {
+                    ++filed;
+                    if (!r.number.empty()) issues[fingerprint] = FiledIssue{r.number, title};
+                    std::cout << "✅ Issue ID: #" << r.id;
+                    if (!r.htmlUrl.empty()) std::cout << " " << r.htmlUrl;
+                    std::cout << std::endl;
+                } else {
+                    ++failed;
+                    std::cerr << "❌ " << r.error << std::endl;
+                }
+            });
+        });
+
+        std::cout << "👀 Watching " << (source == "-" ? "stdin" : source) << " for errors, filing them in " << owner
+                  << "/" << repo << " every " << options.windowSeconds << "s (Ctrl+C to stop)" << std::endl;
+        auto started = std::chrono::steady_clock::now();
+        rc = watcher.run(source);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        stats = watcher.getStats();
+        if (client.pending() > 0) {
+            std::lock_guard<std::mutex> lock(output);
+            std::cout << "⏳ Waiting for " << client.pending() << " issue(s) to be created..." << std::endl;
+        }
+        // Leaving the scope waits for the client to finish
+    }
+
+    std::cout << "Read " << stats.lines << " line(s) (" << (long long)(stats.lines / std::max(seconds, 1e-3))
+              << "/s), " << stats.matched << " matched, filed " << filed << " issue(s)";
+    if (updated > 0) std::cout << ", updated " << updated;
+    std::cout << ", " << failed << " failed";
+    if (dropped > 0) std::cout << ", " << dropped << " dropped";
+    std::cout << "." << std::endl;
+    reportStats(result, *session);
+    return rc == 0 && failed == 0 && dropped == 0 ? 0 : 1;
+}
+
 void setupDefaultRepo(ConfigSetup& configSetup) {
     auto configs = configSetup.getConfigs();
     if (configs.empty()) {
@@ -139,15 +866,30 @@ void setupDefaultRepo(ConfigSetup& configSetup) {
         return;
     }
 
-    const std::string& selectedRepo = configs[choice - 1].repo;
+    const RepoConfig& selected = configs[choice - 1];
 
-    if (configSetup.setDefaultRepo(selectedRepo)) {
-        std::cout << "✅ Default repository set successfully: " << selectedRepo << std::endl;
+    if (configSetup.setDefaultRepo(selected.owner, selected.repo)) {
+        std::cout << "✅ Default repository set successfully: " << selected.owner << "/" << selected.repo << std::endl;
     } else {
         std::cerr << "❌ Failed to set default repository." << std::endl;
     }
 }
 
+// --complete runs on every Tab press, so it only maps the repo index: no option
+// parsing, database or network setup unless the index does not exist yet.
+int completeRepos(const std::string& configPath, const char* prefix) {
+    std::string indexPath = ConfigSetup::repoIndexPath(configPath);
+    RepoIndex index;
+    if (!index.open(indexPath)) {
+        ConfigSetup configSetup(configPath);
+        if (!configSetup.openDB() || !index.open(indexPath)) return 1;
+    }
+    std::string out;
+    index.complete(prefix, out);
+    fwrite(out.data(), 1, out.size(), stdout);
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Get home directory and create config path
     const char* homeDir = std::getenv("HOME");
@@ -156,12 +898,13 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    std::string configPath = std::string(homeDir) + "/.gitee-issue/config.db";
-    ConfigSetup configSetup(configPath);
-    if (!configSetup.openDB()) {
-        std::cerr << "❌ Failed to open database!" << std::endl;
-        return 1;
+    std::string configDir = std::string(homeDir) + "/.gitee-issue";
+    std::string configPath = configDir + "/config.db";
+    if (argc >= 2 && std::strcmp(argv[1], "--complete") == 0) {
+        return completeRepos(configPath, argc >= 3 ? argv[2] : "");
     }
+    std::string socketPath = Daemon::defaultSocketPath(configDir);
+    ConfigSetup configSetup(configPath);
 
     try {
         cxxopts::Options options("gitee-issue", "Gitee Issue Manager CLI");
@@ -173,10 +916,47 @@ int main(int argc, char* argv[]) {
             ("d,delete", "Delete a repository")
             ("owner", "Repository owner (optional; if omitted, default repo owner will be used)", cxxopts::value<std::string>())
             ("repo", "Repository name (optional; if omitted, default repo will be used)", cxxopts::value<std::string>())
-            ("title", "Issue title (required)", cxxopts::value<std::string>())
+            ("title", "Issue title (required); with --batch, a template for every issue's title", cxxopts::value<std::string>())
             ("body", "Issue body", cxxopts::value<std::string>()->default_value(""))
+            ("body-file", "Read the issue body from this file ('-' for stdin); large files and logs are sent without loading them into memory", cxxopts::value<std::string>())
+            ("truncate-body", "With --body-file: keep at most this many bytes, from the start and the end of the file (0 = keep all)", cxxopts::value<size_t>()->default_value("0"))
             ("labels", "Comma-separated labels", cxxopts::value<std::string>()->default_value(""))
             ("token", "Gitee access token (optional; if omitted, default token will be used if set)", cxxopts::value<std::string>())
+            ("batch", "Create issues from a JSONL file ('-' for stdin), one {\"title\",\"body\",\"labels\",\"owner\",\"repo\"} object per line, or from a CSV file with those columns", cxxopts::value<std::string>())
+            ("format", "With --batch: input format, csv, jsonl or auto (by file extension)", cxxopts::value<std::string>()->default_value("auto"))
+            ("template", "Render the issue body from this template file; {{name}} is replaced by the record's field (--batch) or --var (--create) of that name", cxxopts::value<std::string>())
+            ("var", "With --create --template: a template variable as name=value (repeatable)", cxxopts::value<std::vector<std::string>>())
+            ("concurrency", "Maximum number of requests in flight in batch mode", cxxopts::value<int>()->default_value("8"))
+            ("queue", "With --create: store the issue in the local outbox and return immediately")
+            ("fanout", "With --create: create the issue in several configured repos at once: owner/repo,owner/repo,... or all or a tag", cxxopts::value<std::string>())
+            ("complete", "Print configured owner/repo names starting with this prefix (\"/name\" matches repo names); used by shell completion, must be the first argument", cxxopts::value<std::string>())
+            ("label-ttl", "Seconds the labels of a repo are cached for checking --labels (0 = fetch them on every run)", cxxopts::value<int>()->default_value("3600"))
+            ("no-label-check", "Send --labels as given, without checking them against the repo's labels")
+            ("create-labels", "Create labels the repo does not have yet, all at once before any issue is sent")
+            ("label-alias", "Map a label to another, e.g. bugfix=bug, for every later --labels (\"bugfix=\" removes it)", cxxopts::value<std::string>())
+            ("set-tags", "Set the comma-separated tags of the repo given by --owner and --repo, for --fanout (\"\" clears them)", cxxopts::value<std::string>())
+            ("update", "Update issues of --owner/--repo with --title, --body, --labels and --state: I1,I2,..., @file (one number per line, @- for stdin) or search:text (cached issues matching text, see --search)", cxxopts::value<std::string>())
+            ("close", "Close issues of --owner/--repo, given like --update", cxxopts::value<std::string>())
+            ("state", "With --update: open, progressing or closed", cxxopts::value<std::string>())
+            ("watch", "Follow a log file ('-' for stdin) and file an issue for each error signature, coalesced over --watch-window", cxxopts::value<std::string>())
+            ("watch-pattern", "With --watch: a regex (or plain text) marking error lines; its first group, if any, is the signature (repeatable; default: FATAL, ERROR, CRITICAL, panic:, Traceback, Exception)", cxxopts::value<std::string>())
+            ("watch-window", "With --watch: seconds during which repeats of one error are counted into a single issue", cxxopts::value<int>()->default_value("60"))
+            ("watch-samples", "With --watch: log lines quoted in each issue", cxxopts::value<size_t>()->default_value("5"))
+            ("drain", "Send all issues waiting in the outbox. Items left mid-send by a crashed worker are sent again after 10 minutes unless their issue was recorded; one sent just before the crash may be duplicated")
+            ("sync", "Copy the repository's existing issues into the local cache (only those updated since the last sync)")
+            ("full", "With --sync: fetch every issue again instead of only the updated ones")
+            ("search", "Search cached issues (see --sync) by title and body; narrow with --owner and --repo", cxxopts::value<std::string>())
+            ("limit", "With --search: maximum number of results", cxxopts::value<int>()->default_value("20"))
+            ("follow", "With --drain: keep running and send new outbox items as they arrive")
+            ("daemon", "Run in the foreground as a daemon that serves --create requests from other invocations")
+            ("no-daemon", "With --create: do not forward to a running daemon")
+            ("rate", "Maximum requests per second per access token (0 = adapt to server rate-limit headers only)", cxxopts::value<double>()->default_value("0"))
+            ("max-retries", "Retries for throttled (429) or failed (5xx) requests", cxxopts::value<int>()->default_value("5"))
+            ("busy-timeout", "Milliseconds to wait for other gitee-issue processes holding the config database", cxxopts::value<int>()->default_value("5000"))
+            ("api-url", "Gitee API base URL (default: $GITEE_API_URL or https://gitee.com/api/v5)", cxxopts::value<std::string>())
+            ("dedup-ttl", "Seconds during which an identical issue (same owner, repo, title and body) returns the existing issue instead of being created again, e.g. 86400 for one day (0 = off)", cxxopts::value<int>()->default_value("0"))
+            ("stats", "Print request timings (DNS, connect, TLS, first byte, total), sizes and retries as JSON to stderr")
+            ("stats-file", "Write request metrics to this Prometheus textfile (for node_exporter); kept current by --daemon and --drain --follow", cxxopts::value<std::string>())
             ("h,help", "Print help");
 
         auto result = options.parse(argc, argv);
@@ -186,6 +966,55 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
+        if (result.count("api-url")) {
+            IssueCreator::setApiBaseUrl(result["api-url"].as<std::string>());
+        }
+
+        // A running daemon already has the config, tokens and connections warm,
+        // so hand the request over before paying for any of that here. The daemon
+        // talks to its own API URL, so an explicit --api-url is served locally,
+        // and requests whose timings were asked for are made by this process.
+        // A --body-file is read here rather than copied through the socket. The
+        // daemon paces, retries, deduplicates and checks labels with its own
+        // settings, so a call that sets any of those for itself is made here too.
+        if (result.count("create") && result.count("title") && !result.count("queue") && !result.count("no-daemon") &&
+            !result.count("api-url") && !result.count("stats") && !result.count("stats-file") &&
+            !result.count("body-file") && !result.count("template") && !result.count("fanout") &&
+            !result.count("create-labels") && !result.count("no-label-check") && !result.count("label-ttl") &&
+            !result.count("dedup-ttl") && !result.count("rate") && !result.count("max-retries") &&
+            !result.count("busy-timeout")) {
+            IssueRecord record;
+            record.title = result["title"].as<std::string>();
+            record.body = result["body"].as<std::string>();
+            record.labels = result["labels"].as<std::string>();
+            record.owner = result.count("owner") ? result["owner"].as<std::string>() : "";
+            record.repo = result.count("repo") ? result["repo"].as<std::string>() : "";
+            record.token = result.count("token") ? result["token"].as<std::string>() : "";
+
+            IssueResult created;
+            if (DaemonClient::createIssue(socketPath, record, created)) {
+                if (!created.success) {
+                    std::cerr << "❌ Failed to create issue: " << created.error << std::endl;
+                    return 1;
+                }
+                if (created.duplicate) {
+                    std::cout << "♻️ Identical issue already created, not sent again. Issue ID: #" << created.id << std::endl;
+                } else {
+                    std::cout << "✅ Issue created successfully! Issue ID: #" << created.id << std::endl;
+                }
+                if (!created.htmlUrl.empty()) {
+                    std::cout << "🔗 " << created.htmlUrl << std::endl;
+                }
+                return 0;
+            }
+        }
+
+        configSetup.setBusyTimeout(result["busy-timeout"].as<int>());
+        if (!configSetup.openDB()) {
+            std::cerr << "❌ Failed to open database!" << std::endl;
+            return 1;
+        }
+
         if (result.count("menu")) {
             std::cout << "=== MENU ===\n";
             std::cout << "1) Create an issue\n";
@@ -248,34 +1077,204 @@ int main(int argc, char* argv[]) {
             body = result.count("body") ? result["body"].as<std::string>() : "";
             labels = result.count("labels") ? result["labels"].as<std::string>() : "";
 
-            owner = result.count("owner") ? result["owner"].as<std::string>() : "";
-            repo = result.count("repo") ? result["repo"].as<std::string>() : "";
-            token = result.count("token") ? result["token"].as<std::string>() : "";
+            if (result.count("template")) {
+                if (result.count("body") || result.count("body-file")) {
+                    std::cerr << "❗ Use only one of --body, --body-file and --template" << std::endl;
+                    configSetup.closeDB();
+                    return 1;
+                }
+                if (!renderFromVars(result, title, body)) {
+                    configSetup.closeDB();
+                    return 1;
+                }
+            }
 
-            if (owner.empty() || repo.empty() || token.empty()) {
-                RepoConfig defConfig;
-                if (!configSetup.getDefaultRepoConfig(defConfig)) {
-                    std::cerr << "❌ No default repository config found, and some required fields are missing." << std::endl;
+            BodyFile bodyFile;
+            BodyParts bodyParts{body};
+            if (result.count("body-file")) {
+                if (result.count("body")) {
+                    std::cerr << "❗ Use either --body or --body-file, not both" << std::endl;
                     configSetup.closeDB();
                     return 1;
                 }
+                if (!bodyFile.open(result["body-file"].as<std::string>())) {
+                    configSetup.closeDB();
+                    return 1;
+                }
+                bodyFile.truncate(result["truncate-body"].as<size_t>());
+                if (bodyFile.omitted() > 0) {
+                    std::cerr << "✂️ Body truncated: " << bodyFile.omitted() << " of " << bodyFile.fileSize()
+                              << " bytes omitted" << std::endl;
+                }
+                bodyParts = bodyFile.parts();
+            }
 
-                if (owner.empty()) owner = defConfig.owner;
-                if (repo.empty()) repo = defConfig.repo;
-
-                if (token.empty()) {
-                    Hasher hasher(configSetup.getKey());
-                    try {
-                        token = hasher.decrypt(defConfig.encrypted_token);
-                    } catch (const std::exception& e) {
-                        std::cerr << "❌ Failed to decrypt token: " << e.what() << std::endl;
-                        configSetup.closeDB();
-                        return 1;
-                    }
+            if (result.count("fanout")) {
+                if (result.count("queue")) {
+                    std::cerr << "❗ --fanout cannot be combined with --queue" << std::endl;
+                    configSetup.closeDB();
+                    return 1;
                 }
+                int rc = createIssueFanout(result, configSetup, title,
+                                           result.count("body-file") ? bodyFile.str() : body, labels);
+                configSetup.closeDB();
+                return rc;
+            }
+
+            if (result.count("queue")) {
+                // The outbox stores the body itself, so a queued body file is copied in once
+                int rc = enqueueIssue(result, configSetup, title, result.count("body-file") ? bodyFile.str() : body,
+                                      labels);
+                configSetup.closeDB();
+                return rc;
+            }
+
+            if (!resolveTarget(result, configSetup, owner, repo, token)) {
+                configSetup.closeDB();
+                return 1;
+            }
+
+            auto session = makeSession(result);
+            auto scheduler = makeScheduler(result);
+            auto labelResolver = makeLabels(result, configSetup, session, scheduler);
+            std::string error;
+            if (labelResolver && !labelResolver->resolve(owner, repo, token, labels, error)) {
+                std::cerr << "❌ " << error << std::endl;
+                configSetup.closeDB();
+                return 1;
+            }
+            createIssueWithArgs(owner, repo, title, bodyParts, token, labels, scheduler, session,
+                                makeDedup(result, configSetup));
+            reportStats(result, *session);
+
+        } else if (result.count("daemon")) {
+            auto session = makeSession(result);
+            auto scheduler = makeScheduler(result);
+            Daemon daemon(socketPath, configSetup, scheduler, session);
+            daemon.setDedup(makeDedup(result, configSetup));
+            // Connection threads fetch labels concurrently; only the daemon's event loop may use session
+            auto labelSession = std::make_shared<HttpSession>(false);
+            labelSession->setMetrics(session->getMetrics());
+            daemon.setLabelResolver(makeLabels(result, configSetup, labelSession, scheduler));
+            if (result.count("stats-file")) daemon.setMetricsFile(result["stats-file"].as<std::string>());
+            int rc = daemon.run();
+            if (result.count("stats")) reportStats(result, *session);
+            configSetup.closeDB();
+            return rc;
+
+        } else if (result.count("drain")) {
+            auto session = makeSession(result);
+            std::string metricsFile = result.count("stats-file") ? result["stats-file"].as<std::string>() : "";
+            int rc = drainOutbox(configSetup, makeScheduler(result), result.count("follow") > 0, session, metricsFile);
+            reportStats(result, *session);
+            configSetup.closeDB();
+            return rc;
+
+        } else if (result.count("sync")) {
+            std::string owner, repo, token;
+            if (!resolveTarget(result, configSetup, owner, repo, token)) {
+                configSetup.closeDB();
+                return 1;
+            }
+            auto session = makeSession(result);
+            int rc = syncIssues(configSetup, owner, repo, token, result.count("full") > 0, makeScheduler(result),
+                                session);
+            reportStats(result, *session);
+            configSetup.closeDB();
+            return rc;
+
+        } else if (result.count("update") || result.count("close")) {
+            std::string owner, repo, token;
+            if (!resolveTarget(result, configSetup, owner, repo, token)) {
+                configSetup.closeDB();
+                return 1;
+            }
+            auto session = makeSession(result);
+            int rc = updateIssues(result, configSetup, owner, repo, token, makeScheduler(result), session);
+            reportStats(result, *session);
+            configSetup.closeDB();
+            return rc;
+
+        } else if (result.count("watch")) {
+            std::string owner, repo, token;
+            if (!resolveTarget(result, configSetup, owner, repo, token)) {
+                configSetup.closeDB();
+                return 1;
+            }
+            int rc = watchLog(result, configSetup, owner, repo, token);
+            configSetup.closeDB();
+            return rc;
+
+        } else if (result.count("search")) {
+            int rc = searchCachedIssues(configSetup, result["search"].as<std::string>(),
+                                        result.count("owner") ? result["owner"].as<std::string>() : "",
+                                        result.count("repo") ? result["repo"].as<std::string>() : "",
+                                        std::max(1, result["limit"].as<int>()));
+            configSetup.closeDB();
+            return rc;
+
+        } else if (result.count("set-tags")) {
+            if (!result.count("owner") || !result.count("repo")) {
+                std::cerr << "❗ --set-tags needs --owner and --repo" << std::endl;
+                configSetup.closeDB();
+                return 1;
+            }
+            std::string owner = result["owner"].as<std::string>();
+            std::string repo = result["repo"].as<std::string>();
+            bool ok = configSetup.setRepoTags(owner, repo, result["set-tags"].as<std::string>());
+            if (ok) {
+                std::cout << "✅ Tags set for " << owner << "/" << repo << std::endl;
+            } else {
+                std::cerr << "❌ Repository not configured: " << owner << "/" << repo << std::endl;
+            }
+            configSetup.closeDB();
+            return ok ? 0 : 1;
+
+        } else if (result.count("label-alias")) {
+            std::string spec = result["label-alias"].as<std::string>();
+            size_t eq = spec.find('=');
+            std::string alias = LabelResolver::normalize(spec.substr(0, eq));
+            if (eq == std::string::npos || alias.empty() || alias.find(',') != std::string::npos) {
+                std::cerr << "❗ Expected --label-alias alias=label, got: " << spec << std::endl;
+                configSetup.closeDB();
+                return 1;
+            }
+            std::string label = LabelResolver::normalize(spec.substr(eq + 1));
+            bool ok = configSetup.setLabelAlias(alias, label);
+            if (!ok) {
+                std::cerr << "❌ Failed to save the label alias." << std::endl;
+            } else if (label.empty()) {
+                std::cout << "✅ Label alias removed: " << alias << std::endl;
+            } else {
+                std::cout << "✅ Label alias set: " << alias << " -> " << label << std::endl;
+            }
+            configSetup.closeDB();
+            return ok ? 0 : 1;
+
+        } else if (result.count("batch")) {
+            std::string owner, repo, token;
+            if (!resolveTarget(result, configSetup, owner, repo, token)) {
+                configSetup.closeDB();
+                return 1;
+            }
+            BatchCreator::Format format;
+            std::shared_ptr<IssueTemplate> bodyTemplate;
+            if (!batchFormat(result, format) || !loadBodyTemplate(result, bodyTemplate)) {
+                configSetup.closeDB();
+                return 1;
             }
+            std::shared_ptr<IssueTemplate> titleTemplate;
+            if (result.count("title")) titleTemplate = std::make_shared<IssueTemplate>(result["title"].as<std::string>());
 
-            createIssueWithArgs(owner, repo, title, body, token, labels);
+            auto session = makeSession(result);
+            auto scheduler = makeScheduler(result);
+            int rc = createIssuesFromBatch(result["batch"].as<std::string>(), owner, repo, token, scheduler, session,
+                                           makeDedup(result, configSetup),
+                                           makeLabels(result, configSetup, session, scheduler), format,
+                                           titleTemplate, bodyTemplate);
+            reportStats(result, *session);
+            configSetup.closeDB();
+            return rc;
         } else {
             std::cout << options.help() << std::endl;
         }